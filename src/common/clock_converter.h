@@ -0,0 +1,54 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  ClockConverter
+//  nanoseconds と CPU クロック数の相互変換を割り算なしで行う．
+//  逆数は SetClock で周波数が変わったときだけ求め直す．
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/time_constants.h"
+
+class ClockConverter {
+ public:
+  ClockConverter() = default;
+  explicit ClockConverter(uint64_t hz) { SetClock(hz); }
+
+  void SetClock(uint64_t hz) {
+    hz_ = hz;
+    // hz / 1e9 を 32bit 固定小数点で切り上げておく
+    clocks_per_ns_ = ((hz << 32) + kNanoSecsPerSec - 1) / kNanoSecsPerSec;
+    ns_per_clock_ = kNanoSecsPerSec / hz;
+  }
+  [[nodiscard]] uint64_t hz() const { return hz_; }
+
+  // ns をクロック数に変換する (ns * hz / 1e9 の切り捨てと同じ値)
+  [[nodiscard]] int64_t NSToClocks(int64_t ns) const {
+    if (ns <= 0)
+      return 0;
+    if (ns >= kMaxFastNS) {
+      return int64_t(ns / kNanoSecsPerSec * hz_ +
+                     ns % kNanoSecsPerSec * hz_ / kNanoSecsPerSec);
+    }
+    // 切り上げた逆数による誤差は 1 未満なので，1 回の補正で正確な値になる
+    uint64_t clocks = (uint64_t(ns) * clocks_per_ns_) >> 32;
+    if (clocks * kNanoSecsPerSec > uint64_t(ns) * hz_)
+      --clocks;
+    return int64_t(clocks);
+  }
+
+  // クロック数を ns に変換する (1 クロックの長さは ns 単位に切り捨てる)
+  [[nodiscard]] int64_t ClocksToNS(int64_t clocks) const { return clocks * ns_per_clock_; }
+
+ private:
+  // これ以上長い時間は割り算で変換する (4.29 秒，実行 1 回分よりずっと長い)
+  static constexpr int64_t kMaxFastNS = 1LL << 32;
+
+  uint64_t hz_ = 0;
+  uint64_t clocks_per_ns_ = 0;
+  int64_t ns_per_clock_ = 0;
+};
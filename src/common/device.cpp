@@ -11,6 +11,12 @@
 // #define LOGNAME "membus"
 #include "common/diag.h"
 
+namespace {
+bool Skips(std::span<const IDevice::ID> skip, IDevice::ID id) {
+  return std::find(skip.begin(), skip.end(), id) != skip.end();
+}
+}  // namespace
+
 // ---------------------------------------------------------------------------
 //  DeviceList
 //  状態保存・復帰の対象となるデバイスのリストを管理する．
@@ -65,9 +71,11 @@ std::vector<DeviceList::Node>::iterator DeviceList::FindNode(const ID id) {
 // ---------------------------------------------------------------------------
 //  状態保存に必要なデータサイズを求める
 //
-uint32_t DeviceList::GetStatusSize() {
+uint32_t DeviceList::GetStatusSize(std::span<const ID> skip) {
   uint32_t size = sizeof(Header);
   for (auto n : node_) {
+    if (Skips(skip, n.entry->GetID()))
+      continue;
     int ds = n.entry->GetStatusSize();
     if (ds)
       size += sizeof(Header) + ((ds + 3) & ~3);
@@ -79,8 +87,10 @@ uint32_t DeviceList::GetStatusSize() {
 //  状態保存を行う
 //  data にはあらかじめ GetStatusSize() で取得したサイズのバッファが必要
 //
-bool DeviceList::SaveStatus(uint8_t* data) {
+bool DeviceList::SaveStatus(uint8_t* data, std::span<const ID> skip) {
   for (auto n : node_) {
+    if (Skips(skip, n.entry->GetID()))
+      continue;
     int s = n.entry->GetStatusSize();
     if (s) {
       ((Header*)data)->id = n.entry->GetID();
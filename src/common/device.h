@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <stdint.h>
 
+#include <span>
 #include <vector>
 
 #include "gtest/gtest_prod.h"
@@ -48,9 +49,10 @@ class DeviceList {
   bool Del(ID id);
   IDevice* Find(ID id);
 
+  // skip に含まれるデバイスの状態は保存しない
   bool LoadStatus(const uint8_t*);
-  bool SaveStatus(uint8_t*);
-  uint32_t GetStatusSize();
+  bool SaveStatus(uint8_t*, std::span<const ID> skip = {});
+  uint32_t GetStatusSize(std::span<const ID> skip = {});
 
  private:
   struct Node {
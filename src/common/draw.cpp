@@ -0,0 +1,65 @@
+// ---------------------------------------------------------------------------
+//  M88 - PC-8801 Emulator.
+//  Copyright (C) cisc 1997, 1999.
+// ---------------------------------------------------------------------------
+
+#include "common/draw.h"
+
+#include <limits.h>
+
+namespace {
+using Rect = Draw::Region::Rect;
+
+// 重なっているか，隣り合っている
+bool Touches(const Rect& a, const Rect& b) {
+  return a.left <= b.right && b.left <= a.right && a.top <= b.bottom + 1 && b.top <= a.bottom + 1;
+}
+
+Rect Union(const Rect& a, const Rect& b) {
+  return {std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right),
+          std::max(a.bottom, b.bottom)};
+}
+
+int Area(const Rect& r) {
+  return (r.right - r.left) * (r.bottom - r.top + 1);
+}
+}  // namespace
+
+// ---------------------------------------------------------------------------
+//  更新領域を追加する
+//  重なる矩形とはまとめる．kMaxRects 個を超えるときは，
+//  まとめたときに面積の増え方が最も少ない矩形とまとめる
+//
+void Draw::Region::Update(int l, int t, int r, int b) {
+  if (l >= r || t > b)
+    return;
+  left = std::min(left, l), right = std::max(right, r);
+  top = std::min(top, t), bottom = std::max(bottom, b);
+
+  Rect rc = {l, t, r, b};
+  for (;;) {
+    for (int i = 0; i < count;) {
+      if (Touches(rects[i], rc)) {
+        rc = Union(rects[i], rc);
+        rects[i] = rects[--count];
+        i = 0;
+      } else {
+        ++i;
+      }
+    }
+    if (count < kMaxRects) {
+      rects[count++] = rc;
+      return;
+    }
+
+    int best = 0;
+    int best_growth = INT_MAX;
+    for (int i = 0; i < count; ++i) {
+      int growth = Area(Union(rects[i], rc)) - Area(rects[i]) - Area(rc);
+      if (growth < best_growth)
+        best = i, best_growth = growth;
+    }
+    rc = Union(rects[best], rc);
+    rects[best] = rects[--count];
+  }
+}
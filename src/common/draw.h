@@ -25,20 +25,29 @@ class Draw {
     uint8_t red, green, blue, rsvd;
   };
 
+  // 更新領域
+  // left, top, right, bottom は全体を囲む矩形 (right は含まず，bottom は含む)．
+  // rects には更新された矩形を kMaxRects 個まで持ち，溢れたら近いものをまとめる
   struct Region {
+    static constexpr int kMaxRects = 8;
+    struct Rect {
+      int left, top;
+      int right, bottom;
+    };
+
     void Reset() {
       top = left = 32767;
       bottom = right = -1;
+      count = 0;
     }
     [[nodiscard]] bool Valid() const { return top <= bottom; }
-    void Update(int l, int t, int r, int b) {
-      left = std::min(left, l), right = std::max(right, r);
-      top = std::min(top, t), bottom = std::max(bottom, b);
-    }
+    void Update(int l, int t, int r, int b);
     void Update(int t, int b) { Update(0, t, 640, b); }
 
     int left, top;
     int right, bottom;
+    int count;
+    Rect rects[kMaxRects];
   };
 
   class Status {
@@ -45,25 +45,51 @@ bool EmulationLoop::CleanUp() {
 //
 void EmulationLoop::ThreadInit() {
   SetName(L"M88 Sequencer thread");
-  relatime_lastsync_ns_ = real_time_.GetRealTimeNS();
+  relatime_lastsync_ns_ = time_->GetTimeNS();
   effective_clock_ = 3993600;
 }
 
 bool EmulationLoop::ThreadLoop() {
   if (active_) {
     auto clocks = legacy_clocks_per_tick_;
-    if (clocks <= 0) {
+    bool fast_forward = fast_forward_;
+    if (fast_forward != in_fast_forward_)
+      SwitchFastForward(fast_forward);
+    time_->SetHighResolution(clocks > 0 && !fast_forward && precise_pacing_);
+    if (fast_forward) {
+      // 全速 (0) ではなく burst mode で実行し，仮想時間ごと先に進める
+      ExecuteBurst(1);
+    } else if (clocks <= 0) {
       ExecuteBurst(-clocks);
     } else {
       ExecuteNormal(clocks);
     }
   } else {
-    Sleep(20);
-    relatime_lastsync_ns_ = real_time_.GetRealTimeNS();
+    time_->SetHighResolution(false);
+    time_->SleepMS(20);
+    relatime_lastsync_ns_ = time_->GetTimeNS();
+    last_present_ns_ = 0;
   }
   return true;
 }
 
+// ---------------------------------------------------------------------------
+//  早送りの開始・終了
+//  終了時は実効クロックと実時間の基準を戻して，通常の速度で続ける
+//
+void EmulationLoop::SwitchFastForward(bool enable) {
+  in_fast_forward_ = enable;
+  fast_forward_frames_ = 0;
+  if (!enable) {
+    effective_clock_ = cpu_hz_ * speed_pct_ / 100;
+    relatime_lastsync_ns_ = time_->GetTimeNS();
+    skipped_frames_ = 0;
+    draw_next_frame_ = true;
+    // 早送り中の更新間隔は統計に入れない
+    last_present_ns_ = 0;
+  }
+}
+
 // ---------------------------------------------------------------------------
 //  ＣＰＵメインループ
 //  clock   ＣＰＵのクロック (Hz)
@@ -71,13 +97,15 @@ bool EmulationLoop::ThreadLoop() {
 //  eff     実効クロック
 inline void EmulationLoop::ExecuteNS(int64_t cpu_clock, int64_t length_ns, int64_t ec) {
   std::lock_guard<std::mutex> lock(mtx_);
-  exec_clocks_ += cpu_clock * delegate_->ProceedNS(cpu_clock, length_ns, ec) / kNanoSecsPerSec;
+  int64_t executed_ns = delegate_->ProceedNS(cpu_clock, length_ns, ec);
+  exec_clocks_ += cpu_clock * executed_ns / kNanoSecsPerSec;
+  time_->Advance(executed_ns);
 }
 
 void EmulationLoop::ExecuteBurst(uint32_t clocks) {
   delegate_->TimeSync();
   int64_t ns = 0;
-  relatime_lastsync_ns_ = real_time_.GetRealTimeNS();
+  relatime_lastsync_ns_ = time_->GetTimeNS();
   // Execute up to 16ms (16_666_667ns = 1/60sec for 60fps)
   int64_t orig_exec_clocks = exec_clocks_;
   do {
@@ -90,9 +118,12 @@ void EmulationLoop::ExecuteBurst(uint32_t clocks) {
       int64_t target_duration = kNanoSecsPerMilliSec * effective_clock_ / cpu_hz_;
       ExecuteNS(cpu_hz_, target_duration, effective_clock_);
     }
-    ns = real_time_.GetRealTimeNS() - relatime_lastsync_ns_;
+    ns = time_->GetTimeNS() - relatime_lastsync_ns_;
   } while (ns < (kNanoSecsPerSec / 60));
-  delegate_->UpdateScreen(false);
+  if (!in_fast_forward_ || ++fast_forward_frames_ >= kFastForwardPresentInterval) {
+    Present(false);
+    fast_forward_frames_ = 0;
+  }
   int64_t clock_per_ns = std::max(1LL, (exec_clocks_ - orig_exec_clocks) / ns);
   effective_clock_ = kNanoSecsPerSec / clock_per_ns;
 }
@@ -108,18 +139,23 @@ void EmulationLoop::ExecuteNormal(uint32_t clocks) {
   // Execute CPU
   ExecuteNS(cpu_hz_, texec_ns, effective_clock_);
 
+  if (precise_pacing_) {
+    PaceFrame(twork_ns);
+    return;
+  }
+
   // Time used for CPU execution
-  int64_t tcpu_ns = real_time_.GetRealTimeNS() - relatime_lastsync_ns_;
+  int64_t tcpu_ns = time_->GetTimeNS() - relatime_lastsync_ns_;
 
-  if (tcpu_ns < twork_ns) {
+  if (tcpu_ns <= twork_ns) {
     // Emulation is faster than real time
     if (draw_next_frame_ && ++refresh_count_ >= 1) {
-      delegate_->UpdateScreen(false);
+      Present(true);
       skipped_frames_ = 0;
       refresh_count_ = 0;
     }
 
-    int64_t tdraw_ns = real_time_.GetRealTimeNS() - relatime_lastsync_ns_;
+    int64_t tdraw_ns = time_->GetTimeNS() - relatime_lastsync_ns_;
 
     if (tdraw_ns > twork_ns) {
       draw_next_frame_ = false;
@@ -128,7 +164,7 @@ void EmulationLoop::ExecuteNormal(uint32_t clocks) {
       int64_t it_ns = twork_ns - tdraw_ns;
       int sleep_ms = (int)(it_ns / kNanoSecsPerMilliSec);
       if (sleep_ms > 0)
-        Sleep(sleep_ms);
+        time_->SleepMS(sleep_ms);
       draw_next_frame_ = true;
     }
     relatime_lastsync_ns_ += twork_ns;
@@ -136,11 +172,103 @@ void EmulationLoop::ExecuteNormal(uint32_t clocks) {
     // Emulation is slower than real time
     relatime_lastsync_ns_ += twork_ns;
     if (++skipped_frames_ >= 20) {
-      delegate_->UpdateScreen(false);
+      Present(false);
       skipped_frames_ = 0;
-      relatime_lastsync_ns_ = real_time_.GetRealTimeNS();
+      relatime_lastsync_ns_ = time_->GetTimeNS();
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+//  高精度なフレームペーシング
+//  表示予定時刻 (relatime_lastsync_ns_ + twork_ns) まで待ってから画面を更新する．
+//  遅れが 1 フレーム未満ならそのフレームを落とさずにすぐ表示する．
+//  run-ahead は待つ前に実行しておき，表示予定時刻にはその結果を表示するだけにする
+//
+void EmulationLoop::PaceFrame(int64_t twork_ns) {
+  uint64_t present_ns = relatime_lastsync_ns_ + twork_ns;
+  int64_t late_ns = int64_t(time_->GetTimeNS() - present_ns);
+  bool on_time = late_ns < twork_ns;
+
+  // 投機的に実行した状態は，表示して元に戻すまでロックしたままにする
+  std::unique_lock<std::mutex> lock(mtx_, std::defer_lock);
+  bool ahead = false;
+  if (on_time && run_ahead_frames_ > 0) {
+    lock.lock();
+    ahead = BeginRunAhead(run_ahead_frames_);
+    if (!ahead)
+      lock.unlock();
+  }
+  if (int64_t(time_->GetTimeNS() - present_ns) < 0)
+    time_->WaitUntilNS(present_ns);
+
+  if (on_time || ++skipped_frames_ >= 20) {
+    if (ahead) {
+      RecordPresent();
+      EndRunAhead();
+    } else {
+      Present(false);
     }
+    skipped_frames_ = 0;
+  }
+  relatime_lastsync_ns_ = present_ns;
+  // 大きく遅れたら基準を現在時刻に合わせ直す
+  if (late_ns >= twork_ns && !skipped_frames_)
+    relatime_lastsync_ns_ = time_->GetTimeNS();
+}
+
+// ---------------------------------------------------------------------------
+//  画面を更新し，前回の更新からの時間を記録する
+//  ahead: 遅れていないので run-ahead してよい
+//
+void EmulationLoop::Present(bool ahead) {
+  RecordPresent();
+  int frames = run_ahead_frames_;
+  if (ahead && frames > 0 && RunAhead(frames))
+    return;
+  delegate_->UpdateScreen(false);
+}
+
+void EmulationLoop::RecordPresent() {
+  uint64_t now = time_->GetTimeNS();
+  if (last_present_ns_) {
+    std::lock_guard<std::mutex> lock(stats_mtx_);
+    frame_stats_.Add(int64_t(now - last_present_ns_));
   }
+  last_present_ns_ = now;
+}
+
+// ---------------------------------------------------------------------------
+//  frames フレーム先まで実行した画面を表示してから元の状態に戻す
+//  投機的な実行は exec_clocks_ には数えない
+//
+bool EmulationLoop::RunAhead(int frames) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (!BeginRunAhead(frames))
+    return false;
+  EndRunAhead();
+  return true;
+}
+
+// mtx_ をロックして呼ぶ．true を返したら EndRunAhead まで元の状態に戻さない
+bool EmulationLoop::BeginRunAhead(int frames) {
+  if (!delegate_->BeginSpeculation())
+    return false;
+  for (int i = 0; i < frames; ++i)
+    delegate_->ProceedNS(cpu_hz_, delegate_->GetFramePeriodNS(), effective_clock_);
+  return true;
+}
+
+void EmulationLoop::EndRunAhead() {
+  // 戻したあとの状態とは関係なく，先の状態の画面をすべて描き直す
+  delegate_->UpdateScreen(true);
+  delegate_->EndSpeculation();
+}
+
+void EmulationLoop::GetFrameTimeStats(FrameTimeStats* stats) {
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  *stats = frame_stats_;
+  frame_stats_.Clear();
 }
 
 // ---------------------------------------------------------------------------
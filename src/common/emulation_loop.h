@@ -10,23 +10,16 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 
+#include "common/emulation_loop_delegate.h"
+#include "common/frame_time_stats.h"
 #include "common/real_time_keeper.h"
 #include "common/threadable.h"
 #include "common/time_constants.h"
 
-class EmulationLoopDelegate {
- public:
-  virtual ~EmulationLoopDelegate() = default;
-
-  virtual int64_t ProceedNS(uint64_t cpu_clock, int64_t ns, int64_t effective_clock) = 0;
-  virtual void TimeSync() = 0;
-  virtual void UpdateScreen(bool refresh) = 0;
-  virtual uint64_t GetFramePeriodNS() = 0;
-};
-
 // ---------------------------------------------------------------------------
 //  EmulationLoop
 //
@@ -54,19 +47,46 @@ class EmulationLoop : public Threadable<EmulationLoop> {
     speed_pct_ = std::min(std::max(speed, 10), 10000);
     effective_clock_ = cpu_hz_ * speed_pct_ / 100;
   }
+  // 画面更新を表示予定時刻にそろえる (1ms より細かく待つ)
+  void SetPrecisePacing(bool precise) { precise_pacing_ = precise; }
+  // 実時間の代わりに使う時計 (nullptr なら実時間)．Activate する前に設定する
+  void SetTimeSource(TimeSource* time) { time_ = time ? time : &real_time_; }
+  // 早送り: 全速で実行し，画面は何フレームかに 1 回だけ更新する
+  void SetFastForward(bool enable) { fast_forward_ = enable; }
+  // 表示する画面を frames フレーム先まで投機的に実行して作る (入力遅延の短縮)
+  void SetRunAhead(int frames) {
+    run_ahead_frames_ = std::min(std::max(frames, 0), kMaxRunAhead);
+  }
+
+  // 前回の呼び出し以降のフレーム時間の分布を返し，記録をリセット
+  void GetFrameTimeStats(FrameTimeStats* stats);
 
   // thread loop
   void ThreadInit();
   bool ThreadLoop();
 
  private:
+  void SwitchFastForward(bool enable);
   void ExecuteNS(int64_t cpu_clock, int64_t length_ns, int64_t ec);
   void ExecuteBurst(uint32_t clocks);
   void ExecuteNormal(uint32_t clocks);
+  void PaceFrame(int64_t twork_ns);
+  void Present(bool ahead);
+  // 画面を更新した時刻を記録する (フレーム時間の統計)
+  void RecordPresent();
+  bool RunAhead(int frames);
+  // RunAhead の前半 (投機的な実行) と後半 (表示して元に戻す)
+  bool BeginRunAhead(int frames);
+  void EndRunAhead();
+
+  static constexpr int kMaxRunAhead = 4;
+  // 早送り中に画面を更新する間隔 (ExecuteBurst の回数)
+  static constexpr uint32_t kFastForwardPresentInterval = 6;
 
   EmulationLoopDelegate* delegate_ = nullptr;
 
   RealTimeKeeper real_time_;
+  TimeSource* time_ = &real_time_;
 
   std::mutex mtx_;
 
@@ -83,5 +103,15 @@ class EmulationLoop : public Threadable<EmulationLoop> {
   uint32_t refresh_count_ = 0;
   bool draw_next_frame_ = false;
 
+  std::atomic<bool> precise_pacing_ = false;
+  std::atomic<int> run_ahead_frames_ = 0;
+  std::atomic<bool> fast_forward_ = false;
+  bool in_fast_forward_ = false;
+  uint32_t fast_forward_frames_ = 0;
+  // 直前に画面を更新した時刻 (0 なら未更新)
+  uint64_t last_present_ns_ = 0;
+  std::mutex stats_mtx_;
+  FrameTimeStats frame_stats_;
+
   std::atomic<bool> active_ = false;
 };
@@ -0,0 +1,26 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  EmulationLoopDelegate
+//  EmulationLoop や HeadlessDriver から駆動される VM のインターフェース
+//
+
+#pragma once
+
+#include <stdint.h>
+
+class EmulationLoopDelegate {
+ public:
+  virtual ~EmulationLoopDelegate() = default;
+
+  virtual int64_t ProceedNS(uint64_t cpu_clock, int64_t ns, int64_t effective_clock) = 0;
+  virtual void TimeSync() = 0;
+  virtual void UpdateScreen(bool refresh) = 0;
+  virtual uint64_t GetFramePeriodNS() = 0;
+
+  // run-ahead 用．現在の状態を保存して投機的な実行を始める (できなければ false)
+  // EndSpeculation で保存した状態に戻す．投機中は音を出さない
+  virtual bool BeginSpeculation() { return false; }
+  virtual void EndSpeculation() {}
+};
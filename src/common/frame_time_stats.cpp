@@ -0,0 +1,38 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+
+#include "common/frame_time_stats.h"
+
+#include <algorithm>
+
+void FrameTimeStats::Clear() {
+  *this = FrameTimeStats();
+}
+
+void FrameTimeStats::Add(int64_t ns) {
+  ns = std::max<int64_t>(0, ns);
+  int64_t bucket = std::min<int64_t>(ns / kBucketNS, kBuckets - 1);
+  ++histogram_[bucket];
+  if (!count_ || ns < min_ns_)
+    min_ns_ = ns;
+  max_ns_ = std::max(max_ns_, ns);
+  total_ns_ += ns;
+  ++count_;
+}
+
+int64_t FrameTimeStats::PercentileNS(int pct) const {
+  if (!count_)
+    return 0;
+  // pct% 目のフレームを含むバケットを探す
+  uint64_t rank = (uint64_t(count_) * std::clamp(pct, 0, 100) + 99) / 100;
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t n = 0;
+  for (int i = 0; i < kBuckets - 1; ++i) {
+    n += histogram_[i];
+    if (n >= rank)
+      return std::min((i + 1) * kBucketNS, max_ns_);
+  }
+  return max_ns_;
+}
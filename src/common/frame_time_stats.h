@@ -0,0 +1,38 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  FrameTimeStats
+//  画面を更新した間隔 (フレーム時間) の分布を記録する．
+//  0.25ms 刻みのヒストグラムなので，百分位数はその精度で求まる．
+//
+
+#pragma once
+
+#include <stdint.h>
+
+class FrameTimeStats {
+ public:
+  static constexpr int64_t kBucketNS = 250000;
+  // 最後のバケットは 50ms 以上のフレームをまとめて数える
+  static constexpr int kBuckets = 200;
+
+  FrameTimeStats() = default;
+
+  void Clear();
+  void Add(int64_t ns);
+
+  [[nodiscard]] uint32_t count() const { return count_; }
+  [[nodiscard]] int64_t min_ns() const { return count_ ? min_ns_ : 0; }
+  [[nodiscard]] int64_t max_ns() const { return max_ns_; }
+  [[nodiscard]] int64_t mean_ns() const { return count_ ? total_ns_ / count_ : 0; }
+  // pct パーセントのフレームがこの時間以内に収まる (バケットの上端)
+  [[nodiscard]] int64_t PercentileNS(int pct) const;
+
+ private:
+  uint32_t histogram_[kBuckets]{};
+  uint32_t count_ = 0;
+  int64_t total_ns_ = 0;
+  int64_t min_ns_ = 0;
+  int64_t max_ns_ = 0;
+};
@@ -0,0 +1,39 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  HeadlessDriver
+
+#include "common/headless_driver.h"
+
+#include "common/time_constants.h"
+
+void HeadlessDriver::Init(EmulationLoopDelegate* delegate, TimeSource* time) {
+  delegate_ = delegate;
+  time_ = time ? time : &virtual_time_;
+  frames_ = 0;
+  exec_clocks_ = 0;
+  emulated_ns_ = 0;
+}
+
+// ---------------------------------------------------------------------------
+//  1 フレーム分ずつ実行する
+//  EmulationLoop::ExecuteNormal から時間待ちとフレーム落としを除いたもの
+//
+int64_t HeadlessDriver::RunFrames(int frames) {
+  int64_t total_ns = 0;
+  for (int i = 0; i < frames; ++i) {
+    int64_t period_ns = int64_t(delegate_->GetFramePeriodNS());
+    delegate_->TimeSync();
+    int64_t ns = delegate_->ProceedNS(cpu_hz_, period_ns, cpu_hz_);
+    exec_clocks_ += cpu_hz_ * ns / kNanoSecsPerSec;
+    time_->Advance(ns);
+    total_ns += ns;
+
+    ++frames_;
+    if (present_interval_ > 0 && frames_ % present_interval_ == 0)
+      delegate_->UpdateScreen(false);
+  }
+  emulated_ns_ += total_ns;
+  return total_ns;
+}
@@ -0,0 +1,50 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  HeadlessDriver
+//  EmulationLoop と同じ手順で VM を 1 フレームずつ進める，スレッドを使わない駆動部．
+//  実時間を見ないので，フレームを落としたり実効クロックを見積もったりしない．
+//  VM が決定的なら実行結果も決定的になり，RunFrames にかかった時間を測れば
+//  性能の回帰を比較できる．
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/emulation_loop_delegate.h"
+#include "common/time_source.h"
+
+class HeadlessDriver {
+ public:
+  HeadlessDriver() = default;
+  ~HeadlessDriver() = default;
+
+  // time: エミュレーションの進行を知らせる時計 (nullptr なら内部の仮想時計)
+  void Init(EmulationLoopDelegate* delegate, TimeSource* time = nullptr);
+
+  void SetCPUClock(uint64_t cpu_clock) { cpu_hz_ = cpu_clock; }
+  // interval フレームごとに UpdateScreen を呼ぶ (0 なら呼ばない)
+  void SetPresentInterval(int interval) { present_interval_ = interval; }
+
+  // frames フレーム実行し，進んだ VM 時間 (ns) を返す
+  int64_t RunFrames(int frames);
+
+  [[nodiscard]] uint64_t frames() const { return frames_; }
+  [[nodiscard]] int64_t exec_clocks() const { return exec_clocks_; }
+  [[nodiscard]] int64_t emulated_ns() const { return emulated_ns_; }
+  [[nodiscard]] TimeSource* time() const { return time_; }
+
+ private:
+  EmulationLoopDelegate* delegate_ = nullptr;
+  VirtualTimeSource virtual_time_;
+  TimeSource* time_ = &virtual_time_;
+
+  uint64_t cpu_hz_ = 3993600;
+  int present_interval_ = 1;
+
+  uint64_t frames_ = 0;
+  int64_t exec_clocks_ = 0;
+  int64_t emulated_ns_ = 0;
+};
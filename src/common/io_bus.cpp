@@ -39,7 +39,8 @@ bool IOBus::Connect(IDevice* device, const Connector* connector) {
   for (; connector->rule; connector++) {
     switch (connector->rule & 3) {
       case portin:
-        if (!ConnectIn(connector->bank, device, desc->indef[connector->id]))
+        if (!ConnectIn(connector->bank, device, desc->indef[connector->id],
+                       (connector->rule & pure) != 0))
           return false;
         break;
 
@@ -49,12 +50,14 @@ bool IOBus::Connect(IDevice* device, const Connector* connector) {
         break;
     }
     if (connector->rule & sync)
-      flags_[connector->bank] = 1;
+      flags_[connector->bank] |= 1;
   }
   return true;
 }
 
-bool IOBus::ConnectIn(uint32_t bank, IDevice* device, InFuncPtr func) {
+bool IOBus::ConnectIn(uint32_t bank, IDevice* device, InFuncPtr func, bool pure) {
+  if (!pure)
+    flags_[bank] |= 4;
   InBank& v = ins_[bank];
   if (v[0].func == &DummyIO::dummyin) {
     // 最初の接続
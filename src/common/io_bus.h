@@ -26,10 +26,13 @@ class IOBus : public IIOAccess, public IIOBus {
 
   bool Init(uint32_t nports, DeviceList* devlist = nullptr);
 
-  bool ConnectIn(uint32_t bank, IDevice* device, InFuncPtr func);
+  // pure: 読み出しに副作用がない (IsPurePort)
+  bool ConnectIn(uint32_t bank, IDevice* device, InFuncPtr func, bool pure = false);
   bool ConnectOut(uint32_t bank, IDevice* device, OutFuncPtr func);
 
   [[nodiscard]] bool IsSyncPort(uint32_t port) const;
+  // ポートの読み出しに副作用がないか (接続された入力関数が全て pure)
+  [[nodiscard]] bool IsPurePort(uint32_t port) const;
 
   // Overrides IIOBus
   bool IFCALL Connect(IDevice* device, const Connector* connector) override;
@@ -69,6 +72,7 @@ class IOBus : public IIOAccess, public IIOBus {
 
   std::vector<InBank> ins_;
   std::vector<OutBank> outs_;
+  // b0: sync, b2: pure でない入力関数が接続されている
   std::vector<uint8_t> flags_;
   DeviceList* devlist_ = nullptr;
 
@@ -84,3 +88,7 @@ constexpr Device::ID DEV_ID(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
 inline bool IOBus::IsSyncPort(uint32_t port) const {
   return (flags_[port] & 1) != 0;
 }
+
+inline bool IOBus::IsPurePort(uint32_t port) const {
+  return (flags_[port] & 4) == 0;
+}
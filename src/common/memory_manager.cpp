@@ -43,10 +43,12 @@ bool MemoryManagerBase::Init(uint32_t sas, Page* expages) {
   //  if (!lsp)
   //      return false;
 
-  lsp[0].pages = new DPage[npages * ndevices];
+  lsp[0].pages = new Page[npages * ndevices];
+  lsp[0].handlers = new MemoryHandler[npages * ndevices];
   for (int i = 0; i < ndevices; i++) {
     lsp[i].inst = nullptr;
     lsp[i].pages = lsp[0].pages + (i * npages);
+    lsp[i].handlers = lsp[0].handlers + (i * npages);
   }
 
   // priority list
@@ -71,6 +73,9 @@ void MemoryManagerBase::CleanUp() {
   //  if (lsp)
   {
     delete[] lsp[0].pages;
+    lsp[0].pages = nullptr;
+    delete[] lsp[0].handlers;
+    lsp[0].handlers = nullptr;
     //      delete[] lsp; lsp = 0;
   }
 }
@@ -125,10 +130,9 @@ bool ReadMemManager::Init(uint32_t sas, Page* _pages) {
   if (!MemoryManagerBase::Init(sas, _pages))
     return false;
 
-  for (uint32_t i = 0; i < npages; i++) {
-    pages[i].ptr = intptr_t(UndefinedRead);
-    pages[i].func = true;
-  }
+  static const MemoryHandler undefined{intptr_t(UndefinedRead), nullptr};
+  for (uint32_t i = 0; i < npages; i++)
+    pages[i].ptr = intptr_t(&undefined) | Page::kFuncTag;
   return true;
 }
 
@@ -141,10 +145,10 @@ uint32_t ReadMemManager::Read8P(uint32_t pid, uint32_t addr) {
   int page = addr >> pagebits;
   LocalSpace& ls = lsp[priority[page * ndevices + pid + 1]];
 
-  if (!ls.pages[page].func)
-    return ((uint8_t*)ls.pages[page].ptr)[addr & pagemask];
-  else
-    return (*RdFunc(ls.pages[page].ptr))(ls.inst, addr);
+  const Page& p = ls.pages[page];
+  if (!p.func())
+    return p.mem()[addr & pagemask];
+  return (*RdFunc(p.handler()->func))(ls.inst, addr);
 }
 
 // ---------------------------------------------------------------------------
@@ -162,10 +166,9 @@ bool WriteMemManager::Init(uint32_t sas, Page* _pages) {
   if (!MemoryManagerBase::Init(sas, _pages))
     return false;
 
-  for (uint32_t i = 0; i < npages; i++) {
-    pages[i].ptr = intptr_t(UndefinedWrite);
-    pages[i].func = true;
-  }
+  static const MemoryHandler undefined{intptr_t(UndefinedWrite), nullptr};
+  for (uint32_t i = 0; i < npages; i++)
+    pages[i].ptr = intptr_t(&undefined) | Page::kFuncTag;
   return true;
 }
 
@@ -178,10 +181,11 @@ void WriteMemManager::Write8P(uint32_t pid, uint32_t addr, uint32_t data) {
   int page = addr >> pagebits;
   LocalSpace& ls = lsp[priority[page * ndevices + pid + 1]];
 
-  if (!ls.pages[page].func)
-    ((uint8_t*)ls.pages[page].ptr)[addr & pagemask] = data;
+  const Page& p = ls.pages[page];
+  if (!p.func())
+    p.mem()[addr & pagemask] = data;
   else
-    (*WrFunc(ls.pages[page].ptr))(ls.inst, addr, data);
+    (*WrFunc(p.handler()->func))(ls.inst, addr, data);
 }
 
 // ---------------------------------------------------------------------------
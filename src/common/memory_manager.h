@@ -14,11 +14,30 @@
 // ---------------------------------------------------------------------------
 //  メモリ管理クラス
 //
+//  ページテーブルの 1 エントリはポインタ 1 つ分で，読み込み用と書き込み用で
+//  別のテーブルを持つ．
+//  実メモリならそのページの先頭を，アクセス関数なら MemoryHandler のアドレスに
+//  kFuncTag を立てたものを指す．関数と実メモリの識別にポインタの最下位 bit を
+//  使うため，割り当てるメモリは偶数アドレスから始まっていなければならない
+//
+struct MemoryHandler {
+  intptr_t func = 0;
+  void* inst = nullptr;
+  // 書き込み関数のページで，連続した書き込みをまとめて行う関数 (なければ 0)
+  intptr_t block = 0;
+};
+
 struct MemoryPage {
+  static constexpr intptr_t kFuncTag = 1;
+
   MemoryPage() = default;
+  [[nodiscard]] bool func() const { return (ptr & kFuncTag) != 0; }
+  [[nodiscard]] uint8_t* mem() const { return reinterpret_cast<uint8_t*>(ptr); }
+  [[nodiscard]] const MemoryHandler* handler() const {
+    return reinterpret_cast<const MemoryHandler*>(ptr & ~kFuncTag);
+  }
+
   intptr_t ptr = 0;
-  void* inst = nullptr;
-  bool func = false;
 };
 
 class MemoryManagerBase {
@@ -39,17 +58,19 @@ class MemoryManagerBase {
   bool Release(uint32_t pid, uint32_t page, uint32_t top);
 
  protected:
-  bool Alloc(uint32_t pid, uint32_t page, uint32_t top, intptr_t ptr, int incr, bool func);
+  bool Alloc(uint32_t pid,
+             uint32_t page,
+             uint32_t top,
+             intptr_t ptr,
+             int incr,
+             bool func,
+             intptr_t block = 0);
 
-  struct DPage {
-    DPage() = default;
-    intptr_t ptr = 0;
-    bool func = false;
-  };
   struct LocalSpace {
     LocalSpace() = default;
     void* inst = nullptr;
-    DPage* pages = nullptr;
+    Page* pages = nullptr;
+    MemoryHandler* handlers = nullptr;
   };
 
   Page* pages = nullptr;
@@ -84,12 +105,16 @@ class ReadMemManager : public MemoryManagerBase {
 class WriteMemManager : public MemoryManagerBase {
  public:
   using WrFunc = void (*)(void* inst, uint32_t addr, uint32_t data);
+  // addr から count バイトに data を順に書き込む (ブロック転送用)．
+  // data は書き込み先の実体と重ならないこと
+  using BlockWrFunc = void (*)(void* inst, uint32_t addr, const uint8_t* data, uint32_t count);
 
   // Intentionally not overriding MemoryManagerBase::Init
   bool Init(uint32_t sas, Page* pages);
 
   bool AllocW(uint32_t pid, uint32_t addr, uint32_t length, uint8_t* ptr);
   bool AllocW(uint32_t pid, uint32_t addr, uint32_t length, WrFunc ptr);
+  bool AllocW(uint32_t pid, uint32_t addr, uint32_t length, WrFunc ptr, BlockWrFunc block);
   bool ReleaseW(uint32_t pid, uint32_t addr, uint32_t length);
   void Write8(uint32_t addr, uint32_t data);
   void Write8P(uint32_t pid, uint32_t addr, uint32_t data);
@@ -109,6 +134,7 @@ class MemoryManager : public IMemoryManager,
   static constexpr uint32_t pagemask = ::MemoryManagerBase::pagemask;
   using RdFunc = ReadMemManager::RdFunc;
   using WrFunc = WriteMemManager::WrFunc;
+  using BlockWrFunc = WriteMemManager::BlockWrFunc;
 
   bool Init(uint32_t sas, Page* read = nullptr, Page* write = nullptr);
 
@@ -137,6 +163,9 @@ class MemoryManager : public IMemoryManager,
   bool IFCALL AllocW(uint32_t pid, uint32_t addr, uint32_t length, WrFunc ptr) override {
     return WriteMemManager::AllocW(pid, addr, length, ptr);
   }
+  bool AllocW(uint32_t pid, uint32_t addr, uint32_t length, WrFunc ptr, BlockWrFunc block) {
+    return WriteMemManager::AllocW(pid, addr, length, ptr, block);
+  }
   bool IFCALL ReleaseW(uint32_t pid, uint32_t addr, uint32_t length) override {
     return WriteMemManager::ReleaseW(pid, addr, length);
   }
@@ -181,7 +210,8 @@ inline bool MemoryManagerBase::Alloc(uint32_t pid,
                                      uint32_t top,
                                      intptr_t ptr,
                                      int incr,
-                                     bool func) {
+                                     bool func,
+                                     intptr_t block) {
   LocalSpace& ls = lsp[pid];
   assert(ls.inst);
   assert(page < top);
@@ -193,15 +223,20 @@ inline bool MemoryManagerBase::Alloc(uint32_t pid,
     for (int i = pid; pri[i] > pid && i >= 0; --i) {
       pri[i] = pid;
     }
-    if (pri[0] == pid) {
-      // 自分がページの優先権を持つなら Page の書き換え
-      pages[page].inst = ls.inst;
-      pages[page].ptr = ptr;
-      pages[page].func = func;
-    }
     // ローカルページの属性を更新
-    ls.pages[page].ptr = ptr;
-    ls.pages[page].func = func;
+    if (func) {
+      MemoryHandler& handler = ls.handlers[page];
+      handler.func = ptr;
+      handler.inst = ls.inst;
+      handler.block = block;
+      ls.pages[page].ptr = intptr_t(&handler) | Page::kFuncTag;
+    } else {
+      assert((ptr & Page::kFuncTag) == 0);
+      ls.pages[page].ptr = ptr;
+    }
+    // 自分がページの優先権を持つなら Page の書き換え
+    if (pri[0] == pid)
+      pages[page] = ls.pages[page];
     ptr += incr;
   }
   return true;
@@ -227,8 +262,7 @@ inline bool MemoryManagerBase::Release(uint32_t pid, uint32_t page, uint32_t top
         }
         if (pri[0] == pid) {
           pri[0] = npid;
-          pages[page].inst = lsp[npid].inst;
-          pages[page].ptr = lsp[npid].pages[page].ptr;
+          pages[page] = lsp[npid].pages[page];
         }
       }
       ls.pages[page].ptr = 0;
@@ -280,6 +314,18 @@ inline bool WriteMemManager::AllocW(uint32_t pid, uint32_t addr, uint32_t length
 
 // ---------------------------------------------------------------------------
 
+inline bool WriteMemManager::AllocW(uint32_t pid,
+                                    uint32_t addr,
+                                    uint32_t length,
+                                    WrFunc ptr,
+                                    BlockWrFunc block) {
+  uint32_t page = addr >> pagebits;
+  uint32_t top = (addr + length + pagemask) >> pagebits;
+  return MemoryManagerBase::Alloc(pid, page, top, intptr_t(ptr), 0, true, intptr_t(block));
+}
+
+// ---------------------------------------------------------------------------
+
 inline bool WriteMemManager::ReleaseW(uint32_t pid, uint32_t addr, uint32_t length) {
   uint32_t page = addr >> pagebits;
   uint32_t top = (addr + length + pagemask) >> pagebits;
@@ -290,20 +336,22 @@ inline bool WriteMemManager::ReleaseW(uint32_t pid, uint32_t addr, uint32_t leng
 //  メモリからの読み込み
 //
 inline uint32_t ReadMemManager::Read8(uint32_t addr) {
-  Page& page = pages[addr >> pagebits];
-  if (!page.func)
-    return ((uint8_t*)page.ptr)[addr & pagemask];
-  else
-    return (*RdFunc(page.ptr))(page.inst, addr);
+  const Page page = pages[addr >> pagebits];
+  if (!page.func())
+    return page.mem()[addr & pagemask];
+  const MemoryHandler* handler = page.handler();
+  return (*RdFunc(handler->func))(handler->inst, addr);
 }
 
 // ---------------------------------------------------------------------------
 //  メモリへの書込み
 //
 inline void WriteMemManager::Write8(uint32_t addr, uint32_t data) {
-  Page& page = pages[addr >> pagebits];
-  if (!page.func)
-    ((uint8_t*)page.ptr)[addr & pagemask] = data;
-  else
-    (*WrFunc(page.ptr))(page.inst, addr, data);
+  const Page page = pages[addr >> pagebits];
+  if (!page.func()) {
+    page.mem()[addr & pagemask] = data;
+    return;
+  }
+  const MemoryHandler* handler = page.handler();
+  (*WrFunc(handler->func))(handler->inst, addr, data);
 }
@@ -8,6 +8,8 @@
 
 #include <windows.h>
 
+#include <mmsystem.h>
+
 #include <assert.h>
 
 RealTimeKeeper::RealTimeKeeper() {
@@ -27,7 +29,9 @@ RealTimeKeeper::RealTimeKeeper() {
   time_ns_ = 0;
 }
 
-RealTimeKeeper::~RealTimeKeeper() = default;
+RealTimeKeeper::~RealTimeKeeper() {
+  SetHighResolution(false);
+}
 
 uint32_t RealTimeKeeper::GetRealTime() {
   LARGE_INTEGER li;
@@ -46,3 +50,32 @@ uint64_t RealTimeKeeper::GetRealTimeNS() {
   time_ns_ += dc * ns_per_freq_;
   return time_ns_;
 }
+
+void RealTimeKeeper::WaitUntilNS(uint64_t target_ns) {
+  for (;;) {
+    uint64_t now = GetRealTimeNS();
+    if (now >= target_ns)
+      return;
+    uint64_t rest = target_ns - now;
+    if (rest > kSpinNS + kNanoSecsPerMilliSec)
+      Sleep(DWORD((rest - kSpinNS) / kNanoSecsPerMilliSec));
+    else if (rest > kSpinNS)
+      Sleep(0);
+    else
+      YieldProcessor();
+  }
+}
+
+void RealTimeKeeper::SleepMS(uint32_t ms) {
+  Sleep(ms);
+}
+
+void RealTimeKeeper::SetHighResolution(bool enable) {
+  if (enable == high_resolution_)
+    return;
+  if (enable)
+    timeBeginPeriod(1);
+  else
+    timeEndPeriod(1);
+  high_resolution_ = enable;
+}
@@ -9,6 +9,7 @@
 #include <stdint.h>
 
 #include "common/time_constants.h"
+#include "common/time_source.h"
 
 // ---------------------------------------------------------------------------
 //  RealTimeKeeper
@@ -19,14 +20,23 @@
 //  即ち，GetTime() を呼んでから N (1/unit ミリ秒) 後に GetTime() を呼ぶと，
 //  2度目に返される値は最初に返される値より N 増える．
 //
-class RealTimeKeeper {
+class RealTimeKeeper : public TimeSource {
  public:
   RealTimeKeeper();
-  ~RealTimeKeeper();
+  ~RealTimeKeeper() override;
 
   uint32_t GetRealTime();
   uint64_t GetRealTimeNS();
 
+  // Overrides TimeSource
+  uint64_t GetTimeNS() override { return GetRealTimeNS(); }
+  // GetRealTimeNS() が target_ns になるまで待つ．
+  // 手前までは Sleep で待ち，最後の kSpinNS は時刻を見ながら待つ
+  void WaitUntilNS(uint64_t target_ns) override;
+  void SleepMS(uint32_t ms) override;
+  // Sleep の分解能を 1ms にする (timeBeginPeriod)
+  void SetHighResolution(bool enable) override;
+
  private:
   uint32_t freq_ = 0;  // ソースクロックの周期
   uint32_t base_ = 0;  // 最後の呼び出しの際の元クロックの値
@@ -36,4 +46,8 @@ class RealTimeKeeper {
   uint64_t ns_per_freq_ = 0;
   uint64_t base_ns_ = 0;  // QPC base
   uint64_t time_ns_ = 0;  // last nanosec time
+
+  // Sleep の誤差 (分解能 1ms のとき) を吸収する時間
+  static constexpr uint64_t kSpinNS = 2 * kNanoSecsPerMilliSec;
+  bool high_resolution_ = false;
 };
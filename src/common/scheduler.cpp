@@ -8,14 +8,16 @@
 
 #include <assert.h>
 
-Scheduler::Scheduler() {
-  for (auto& event : events) {
-    event = Event();
-  }
-}
+#include <algorithm>
+
+Scheduler::Scheduler() = default;
 
 bool Scheduler::Init() {
-  evlast_ = -1;
+  for (Event* ev : heap_)
+    Release(ev);
+  heap_.clear();
+  next_ns_ = kNoEvent;
+  next_dirty_ = false;
   time_ns_ = 0;
   return true;
 }
@@ -40,21 +42,24 @@ Scheduler::Event* Scheduler::AddEventNS(int64_t ns,
                                         bool repeat) {
   assert(inst && func);
   assert(ns > 0);
-
-  int i = 0;
-  // 空いてる Event を探す
-  for (; i <= evlast_; i++)
-    if (!events[i].inst)
-      break;
-  // この条件が発生した場合はアボートすべき?
-  if (i >= kMaxEvents)
+  if (hold_)
     return nullptr;
-  if (i > evlast_)
-    evlast_ = i;
 
-  Event& ev = events[i];
-  SetEventNS(&ev, ns, inst, func, arg, repeat);
-  return &ev;
+  // 空いてる Event を探す (SetEvent で再び使われたものは飛ばす)
+  Event* ev = nullptr;
+  while (!free_.empty() && !ev) {
+    Event* e = free_.back();
+    free_.pop_back();
+    e->pooled = false;
+    if (e->index < 0)
+      ev = e;
+  }
+  if (!ev) {
+    pool_.push_back(std::make_unique<Event>());
+    ev = pool_.back().get();
+  }
+  SetEventNS(ev, ns, inst, func, arg, repeat);
+  return ev;
 }
 
 // ---------------------------------------------------------------------------
@@ -77,23 +82,37 @@ void Scheduler::SetEventNS(Event* ev,
                            IDevice::TimeFunc func,
                            int arg,
                            bool repeat) {
+  if (hold_)
+    return;
   int ticks = int(ns / kNanoSecsPerTick);
   if (ticks == 0)
     ticks = 1;
   // SetEvent(ev, ticks, inst, func, arg, repeat);
   assert(inst && func);
 
-  ev->count = GetTime() + ticks;
-  ev->count_ns = GetTimeNS() + ns;
+  int64_t now_ns = GetTimeNS();
+  ev->count = int(now_ns / kNanoSecsPerTick) + ticks;
+  ev->count_ns = now_ns + ns;
   ev->inst = inst;
   ev->func = func;
   ev->arg = arg;
   ev->time = repeat ? ticks : 0;
-  ev->time_ns = repeat ? ev->count_ns : 0;
+  ev->time_ns = repeat ? ns : 0;
+  bool was_next = ev->index == 0;
+  if (ev->index < 0)
+    Push(ev);
+  else
+    Update(ev);
+
+  if (ev->count_ns < next_ns_)
+    next_ns_ = ev->count_ns;
+  else if (was_next)
+    next_dirty_ = true;
 
-  // 最短イベント発生時刻を更新する？
+  // 実行中なら、新しいイベントの発生時刻で Execute を打ち切る
+  // (ShortenNS には現在時刻からの残り時間を渡す)
   if (endtime_ns_ > ev->count_ns) {
-    ShortenNS(endtime_ns_ - ev->count_ns);
+    ShortenNS(ev->count_ns - now_ns);
     endtime_ns_ = ev->count_ns;
   }
 }
@@ -102,26 +121,150 @@ void Scheduler::SetEventNS(Event* ev,
 //  時間イベントを削除
 //
 bool Scheduler::DelEvent(IDevice* inst) {
-  Event* ev = &events[evlast_];
-  for (int i = evlast_; i >= 0; --i, --ev) {
-    if (ev->inst == inst) {
-      ev->inst = nullptr;
-      if (evlast_ == i)
-        --evlast_;
-    }
+  if (hold_)
+    return true;
+  // 該当するイベントを取り除いてからヒープを組み直す
+  int n = 0;
+  for (Event* ev : heap_) {
+    if (ev->inst == inst)
+      Release(ev);
+    else
+      Place(ev, n++);
   }
+  heap_.resize(n);
+  for (int i = n / 2 - 1; i >= 0; --i)
+    SiftDown(i);
+  next_dirty_ = true;
   return true;
 }
 
 bool Scheduler::DelEvent(Event* ev) {
-  if (ev) {
-    ev->inst = nullptr;
-    if (ev - events == evlast_)
-      --evlast_;
+  if (!hold_ && ev && ev->index >= 0) {
+    next_dirty_ |= ev->index == 0;
+    Remove(ev);
+    Release(ev);
   }
   return true;
 }
 
+// ---------------------------------------------------------------------------
+//  ヒープ操作
+//
+void Scheduler::Push(Event* ev) {
+  heap_.push_back(ev);
+  ev->index = int(heap_.size()) - 1;
+  SiftUp(ev->index);
+}
+
+void Scheduler::Remove(Event* ev) {
+  int i = ev->index;
+  Event* last = heap_.back();
+  heap_.pop_back();
+  ev->index = -1;
+  if (last != ev) {
+    Place(last, i);
+    Update(last);
+  }
+}
+
+// 発火時刻が変わったイベントの位置を直す
+void Scheduler::Update(Event* ev) {
+  int i = ev->index;
+  if (i > 0 && heap_[(i - 1) / 2]->count_ns > ev->count_ns)
+    SiftUp(i);
+  else
+    SiftDown(i);
+}
+
+void Scheduler::SiftUp(int i) {
+  Event* ev = heap_[i];
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (heap_[parent]->count_ns <= ev->count_ns)
+      break;
+    Place(heap_[parent], i);
+    i = parent;
+  }
+  Place(ev, i);
+}
+
+void Scheduler::SiftDown(int i) {
+  Event* ev = heap_[i];
+  int n = int(heap_.size());
+  for (;;) {
+    int child = i * 2 + 1;
+    if (child >= n)
+      break;
+    if (child + 1 < n && heap_[child + 1]->count_ns < heap_[child]->count_ns)
+      ++child;
+    if (ev->count_ns <= heap_[child]->count_ns)
+      break;
+    Place(heap_[child], i);
+    i = child;
+  }
+  Place(ev, i);
+}
+
+// 次のイベントの発火時刻
+int64_t Scheduler::NextEventNS() {
+  if (next_dirty_) {
+    next_ns_ = heap_.empty() ? kNoEvent : heap_[0]->count_ns;
+    next_dirty_ = false;
+  }
+  return next_ns_;
+}
+
+// 無効にしたイベントを空きリストに戻す
+void Scheduler::Release(Event* ev) {
+  ev->inst = nullptr;
+  ev->index = -1;
+  if (!ev->pooled) {
+    ev->pooled = true;
+    free_.push_back(ev);
+  }
+}
+
+// ---------------------------------------------------------------------------
+//  実行状態の保存と復元
+//
+void Scheduler::SaveState(State* state) {
+  state->time_ns = time_ns_;
+  state->events.resize(pool_.size());
+  for (size_t i = 0; i < pool_.size(); ++i)
+    state->events[i] = *pool_[i];
+  state->heap.assign(heap_.begin(), heap_.end());
+  state->free.assign(free_.begin(), free_.end());
+  state->handles.resize(handles_.size());
+  for (size_t i = 0; i < handles_.size(); ++i)
+    state->handles[i] = *handles_[i];
+}
+
+void Scheduler::RestoreState(const State& state) {
+  time_ns_ = state.time_ns;
+  endtime_ns_ = time_ns_;
+  // Event の実体は解放しないので，保存後に確保したものは空きにする
+  free_.assign(state.free.begin(), state.free.end());
+  for (size_t i = 0; i < pool_.size(); ++i) {
+    Event* ev = pool_[i].get();
+    if (i < state.events.size()) {
+      *ev = state.events[i];
+    } else {
+      *ev = Event();
+      ev->pooled = true;
+      free_.push_back(ev);
+    }
+  }
+  heap_.assign(state.heap.begin(), state.heap.end());
+  for (size_t i = 0; i < state.handles.size() && i < handles_.size(); ++i)
+    *handles_[i] = state.handles[i];
+  next_dirty_ = true;
+}
+
+void Scheduler::RegisterHandle(Event** handle) {
+  if (std::find(handles_.begin(), handles_.end(), handle) == handles_.end())
+    handles_.push_back(handle);
+}
+
 // For testing purpose only
 int Scheduler::Proceed(int ticks) {
   return int(ProceedNS(ticks * kNanoSecsPerTick) / kNanoSecsPerTick);
@@ -132,40 +275,38 @@ int64_t Scheduler::ProceedNS(int64_t ns) {
   for (; t_ns > 0;) {
     // 最短イベント発生時刻を求める
     int64_t ptime_ns = t_ns;
-    for (int i = 0; i <= evlast_; ++i) {
-      Event& ev = events[i];
-      if (!ev.inst)
-        continue;
-      ptime_ns = std::min(ev.count_ns - time_ns_, ptime_ns);
-    }
+    int64_t next_ns = NextEventNS();
+    if (next_ns != kNoEvent)
+      ptime_ns = std::min(next_ns - time_ns_, ptime_ns);
     // TODO: investigate when ptime_ns is negative (in the past).
-    ptime_ns = std::max(1LL, ptime_ns);
-
+    ptime_ns = std::max<int64_t>(1, ptime_ns);
     endtime_ns_ = time_ns_ + ptime_ns;
+
     // 最短イベント発生時刻まで実行する。ただし、途中で新イベントが発生することにより、ptime
     // 以前に終了して 帰ってくる可能性がある。
     // TODO: skip if ptime_ns is too small to execute anything
     int64_t xtime_ns = ExecuteNS(ptime_ns);
+
     time_ns_ += xtime_ns;
     endtime_ns_ = time_ns_;
     t_ns -= xtime_ns;
 
     // イベントを発火する
-    for (int i = evlast_; i >= 0; --i) {
-      Event& ev = events[i];
-
-      if (ev.inst && (ev.count_ns - time_ns_ <= 0)) {
-        IDevice* inst = ev.inst;
-        if (ev.time_ns)
-          ev.count_ns += ev.time_ns;
-        else {
-          ev.inst = nullptr;
-          if (evlast_ == i)
-            --evlast_;
-        }
-
-        (inst->*ev.func)(ev.arg);
+    while (NextEventNS() - time_ns_ <= 0) {
+      Event* ev = heap_[0];
+      IDevice* inst = ev->inst;
+      IDevice::TimeFunc func = ev->func;
+      int arg = ev->arg;
+      if (ev->time_ns) {
+        ev->count_ns += ev->time_ns;
+        SiftDown(0);
+      } else {
+        Remove(ev);
+        Release(ev);
       }
+      next_dirty_ = true;
+
+      (inst->*func)(arg);
     }
   }
   return ns - t_ns;
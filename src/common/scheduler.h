@@ -6,6 +6,11 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
 #include "common/device.h"
 #include "common/time_constants.h"
 
@@ -26,6 +31,10 @@ struct SchedulerEvent {
   int time = 0;
   // リピートするイベントの場合の間隔 (nanoseconds)
   int64_t time_ns = 0;
+  // ヒープ内の位置 (-1 の場合、スケジュールされていない)
+  int index = -1;
+  // 空きリストに入っている
+  bool pooled = false;
 };
 
 class Scheduler : public IScheduler, public ITime {
@@ -59,6 +68,24 @@ class Scheduler : public IScheduler, public ITime {
   bool IFCALL DelEvent(IDevice* dev) override;
   bool IFCALL DelEvent(Event* ev) override;
 
+  // 実行状態 (時刻とイベント) の保存と復元 (run-ahead 用)
+  // 2 回目以降の保存ではメモリを確保しない
+  struct State {
+    int64_t time_ns = 0;
+    std::vector<Event> events;
+    std::vector<Event*> heap;
+    std::vector<Event*> free;
+    std::vector<Event*> handles;
+  };
+  void SaveState(State* state);
+  void RestoreState(const State& state);
+  // デバイスがイベントのハンドルを保持している変数を登録する．
+  // RestoreState はハンドルの値も保存した時点に戻す
+  void RegisterHandle(Event** handle);
+  // 状態を戻している間 (RestoreState の前の LoadStatus) はイベントの追加・変更・削除を
+  // 無視する．AddEvent は nullptr を返すので，ハンドルは RegisterHandle で戻すこと
+  void HoldEvents(bool hold) { hold_ = hold; }
+
   // Overrides ITime
   // Returns current virtual time.
   // 1 tick = 10μs (≒ 40clocks at 4MHz)
@@ -70,13 +97,35 @@ class Scheduler : public IScheduler, public ITime {
   virtual void ShortenNS(int64_t ns) = 0;
   virtual int64_t GetNS() = 0;
 
+  // ヒープ操作
+  void Push(Event* ev);
+  void Remove(Event* ev);
+  void Update(Event* ev);
+  void SiftUp(int i);
+  void SiftDown(int i);
+  void Place(Event* ev, int i) {
+    heap_[i] = ev;
+    ev->index = i;
+  }
+  void Release(Event* ev);
+  int64_t NextEventNS();
+
  private:
-  // 有効なイベントの番号の最大値
-  int evlast_ = -1;
   // Scheduler 内の現在時刻
   int64_t time_ns_ = 0;
   // Execute の終了予定時刻
   int64_t endtime_ns_ = 0;
-  static constexpr int kMaxEvents = 16;
-  Event events[kMaxEvents];
+  // 発火時刻の早い順に並べた二分ヒープ (heap_[0] が次のイベント)
+  std::vector<Event*> heap_;
+  // Event の実体．ハンドルとして返したポインタが変わらないように個別に確保し、
+  // Scheduler が破棄されるまで解放しない
+  std::vector<std::unique_ptr<Event>> pool_;
+  std::vector<Event*> free_;
+  std::vector<Event**> handles_;
+  // 次のイベントの発火時刻 (イベントがなければ kNoEvent)
+  // 追加時は SetEventNS で更新し、発火・削除の後にだけヒープから求め直す
+  static constexpr int64_t kNoEvent = INT64_MAX;
+  int64_t next_ns_ = kNoEvent;
+  bool next_dirty_ = false;
+  bool hold_ = false;
 };
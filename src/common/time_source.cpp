@@ -0,0 +1,59 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  TimeSource
+
+#include "common/time_source.h"
+
+#include <utility>
+
+// ---------------------------------------------------------------------------
+//  RecordedTimeSource
+//
+void RecordedTimeSource::Record(TimeSource* source) {
+  source_ = source;
+  times_.clear();
+  pos_ = 0;
+}
+
+void RecordedTimeSource::Replay() {
+  source_ = nullptr;
+  pos_ = 0;
+}
+
+void RecordedTimeSource::Replay(std::vector<uint64_t> times) {
+  times_ = std::move(times);
+  Replay();
+}
+
+uint64_t RecordedTimeSource::GetTimeNS() {
+  if (source_) {
+    times_.push_back(source_->GetTimeNS());
+    return times_.back();
+  }
+  if (pos_ < times_.size())
+    return times_[pos_++];
+  return times_.empty() ? 0 : times_.back();
+}
+
+// 待つ時間は記録した時刻に含まれているので，再生中は何もしない
+void RecordedTimeSource::WaitUntilNS(uint64_t target_ns) {
+  if (source_)
+    source_->WaitUntilNS(target_ns);
+}
+
+void RecordedTimeSource::SleepMS(uint32_t ms) {
+  if (source_)
+    source_->SleepMS(ms);
+}
+
+void RecordedTimeSource::Advance(int64_t ns) {
+  if (source_)
+    source_->Advance(ns);
+}
+
+void RecordedTimeSource::SetHighResolution(bool enable) {
+  if (source_)
+    source_->SetHighResolution(enable);
+}
@@ -0,0 +1,88 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  TimeSource
+//  EmulationLoop が実時間との同期に使う時計．
+//
+//  RealTimeKeeper      実時間 (QueryPerformanceCounter)
+//  VirtualTimeSource   エミュレーションが進んだ分だけ進む仮想時間．
+//                      待つとその時刻まですぐに進むので，結果が実行環境に依存しない
+//  RecordedTimeSource  別の時計が返した時刻を記録し，後で同じ順に返す
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "common/time_constants.h"
+
+class TimeSource {
+ public:
+  virtual ~TimeSource() = default;
+
+  // 現在時刻 (ns)．値そのものに意味はなく，差が経過時間を表す
+  virtual uint64_t GetTimeNS() = 0;
+  // GetTimeNS() が target_ns になるまで待つ
+  virtual void WaitUntilNS(uint64_t target_ns) = 0;
+  // ms ミリ秒待つ
+  virtual void SleepMS(uint32_t ms) = 0;
+  // エミュレーションが ns 進んだことを知らせる
+  virtual void Advance(int64_t /*ns*/) {}
+  // 待ち時間の分解能を 1ms にする
+  virtual void SetHighResolution(bool /*enable*/) {}
+};
+
+// ---------------------------------------------------------------------------
+//  VirtualTimeSource
+//
+class VirtualTimeSource : public TimeSource {
+ public:
+  explicit VirtualTimeSource(uint64_t start_ns = 0) : now_ns_(start_ns) {}
+
+  uint64_t GetTimeNS() override { return now_ns_; }
+  void WaitUntilNS(uint64_t target_ns) override {
+    if (now_ns_ < target_ns)
+      now_ns_ = target_ns;
+  }
+  void SleepMS(uint32_t ms) override { now_ns_ += uint64_t(ms) * kNanoSecsPerMilliSec; }
+  void Advance(int64_t ns) override { now_ns_ += ns; }
+
+ private:
+  uint64_t now_ns_;
+};
+
+// ---------------------------------------------------------------------------
+//  RecordedTimeSource
+//  記録中は source の時刻をそのまま返し，返した値を覚えておく．
+//  再生中は覚えた値を順に返し，待たない．記録を使い切ったら最後の値を返し続ける
+//
+class RecordedTimeSource : public TimeSource {
+ public:
+  RecordedTimeSource() = default;
+
+  // source を記録する (source は記録が終わるまで有効であること)
+  void Record(TimeSource* source);
+  // 記録した時刻を最初から再生する
+  void Replay();
+  void Replay(std::vector<uint64_t> times);
+
+  [[nodiscard]] const std::vector<uint64_t>& times() const { return times_; }
+  [[nodiscard]] bool IsReplaying() const { return !source_; }
+  // 再生中に記録を使い切った
+  [[nodiscard]] bool IsExhausted() const { return !source_ && pos_ >= times_.size(); }
+
+  uint64_t GetTimeNS() override;
+  void WaitUntilNS(uint64_t target_ns) override;
+  void SleepMS(uint32_t ms) override;
+  void Advance(int64_t ns) override;
+  void SetHighResolution(bool enable) override;
+
+ private:
+  TimeSource* source_ = nullptr;
+  std::vector<uint64_t> times_;
+  size_t pos_ = 0;
+};
@@ -5,21 +5,30 @@
 
 #include "devices/z80.h"
 
+#include <string.h>
+
+#include <algorithm>
+
+// 関数ページからのフェッチは Read8 でウェイトを加える
+static const uint8_t kNoWait = 0;
+
 // Memory access
 void MemStrategy::SetPC(uint32_t newpc) {
-  MemoryPage& page = rdpages_[(newpc >> pagebits) & PAGESMASK];
+  const MemoryPage page = rdpages_[(newpc >> pagebits) & PAGESMASK];
 
-  if (!page.func) {
+  if (!page.func()) {
     // instruction is on memory
-    instpage_ = reinterpret_cast<uint8_t*>(page.ptr);
-    instbase_ = reinterpret_cast<uint8_t*>(page.ptr) - (newpc & ~pagemask & 0xffff);
-    instlim_ = reinterpret_cast<uint8_t*>(page.ptr) + (1 << pagebits);
-    inst_ = reinterpret_cast<uint8_t*>(page.ptr) + (newpc & pagemask);
+    instpage_ = page.mem();
+    instbase_ = page.mem() - (newpc & ~pagemask & 0xffff);
+    instlim_ = page.mem() + (1 << pagebits);
+    inst_ = page.mem() + (newpc & pagemask);
+    inst_wait_ = &waits_[(newpc >> pagebits) & PAGESMASK];
     return;
   }
 
   instbase_ = instlim_ = nullptr;
   instpage_ = (uint8_t*)~0;
+  inst_wait_ = &kNoWait;
   inst_ = reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(newpc));
 }
 
@@ -36,3 +45,79 @@ uint32_t MemStrategy::Fetch16B() {
   uint32_t r = Fetch8();
   return r | (Fetch8() << 8);
 }
+
+// ---------------------------------------------------------------------------
+// ブロック転送
+//
+uint32_t MemStrategy::CopyBlock(uint32_t dst, uint32_t src, uint32_t count, int dir) {
+  uint32_t done = 0;
+  while (done < count) {
+    uint32_t s = (dir > 0 ? src + done : src - done) & 0xffff;
+    uint32_t d = (dir > 0 ? dst + done : dst - done) & 0xffff;
+    const MemoryPage rpage = rdpages_[s >> pagebits];
+    const MemoryPage wpage = wrpages_[d >> pagebits];
+    if (rpage.func() || (wpage.func() && !wpage.handler()->block))
+      break;
+
+    // どちらのページも越えない範囲を転送する
+    const uint8_t* sp = rpage.mem() + (s & pagemask);
+    uint32_t n;
+    if (dir > 0)
+      n = std::min(
+          {count - done, (1 << pagebits) - (s & pagemask), (1 << pagebits) - (d & pagemask)});
+    else
+      n = std::min({count - done, (s & pagemask) + 1, (d & pagemask) + 1});
+
+    if (wpage.func()) {
+      // 書き込み先の実体は転送元と重ならないので，LDDR も昇順にまとめて書いてよい
+      const MemoryHandler* handler = wpage.handler();
+      if (dir > 0)
+        (*MemoryManager::BlockWrFunc(handler->block))(handler->inst, d, sp, n);
+      else
+        (*MemoryManager::BlockWrFunc(handler->block))(handler->inst, d - n + 1, sp - n + 1, n);
+    } else {
+      uint8_t* dp = wpage.mem() + (d & pagemask);
+      if (dir > 0) {
+        for (uint32_t i = 0; i < n; ++i)
+          dp[i] = sp[i];
+      } else {
+        for (uint32_t i = 0; i < n; ++i)
+          *(dp - i) = *(sp - i);
+      }
+    }
+    wait_clocks_ += int(n) * (waits_[s >> pagebits] + waits_[d >> pagebits]);
+    done += n;
+  }
+  mem_effects_ += done;
+  return done;
+}
+
+// ---------------------------------------------------------------------------
+// ブロックサーチ
+//
+uint32_t MemStrategy::SkipBlock(uint32_t src, uint32_t count, int dir, uint32_t data) {
+  uint32_t done = 0;
+  while (done < count) {
+    uint32_t s = (dir > 0 ? src + done : src - done) & 0xffff;
+    const MemoryPage page = rdpages_[s >> pagebits];
+    if (page.func())
+      break;
+
+    const uint8_t* sp = page.mem() + (s & pagemask);
+    uint32_t n, i;
+    if (dir > 0) {
+      n = std::min(count - done, (1 << pagebits) - (s & pagemask));
+      const void* hit = memchr(sp, data, n);
+      i = hit ? static_cast<uint32_t>(static_cast<const uint8_t*>(hit) - sp) : n;
+    } else {
+      n = std::min(count - done, (s & pagemask) + 1);
+      for (i = 0; i < n && *(sp - i) != data; ++i) {
+      }
+    }
+    wait_clocks_ += int(i) * waits_[s >> pagebits];
+    done += i;
+    if (i < n)
+      break;
+  }
+  return done;
+}
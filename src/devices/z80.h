@@ -10,11 +10,20 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+
 #include "common/io_bus.h"
 #include "common/memory_manager.h"
 
 #define Z80_WORDREG_IN_INT
 
+// CPU の実行方法 (GetExecFunc で実行関数を選ぶ)
+enum class Z80ExecMode {
+  kSingle,  // 1CPU (ExecSingle)
+  kDual,    // 2CPU, main:sub = 1:1 (ExecDual)
+  kDual2,   // 2CPU, main:sub = 2:1 (ExecDual2)
+};
+
 // ---------------------------------------------------------------------------
 //  Z80 のレジスタセット
 // ---------------------------------------------------------------------------
@@ -74,8 +83,12 @@ class IOStrategy {
   void Outp(uint32_t port, uint32_t data);
   [[nodiscard]] bool IsSyncPort(uint32_t port) const { return bus_->IsSyncPort(port); }
 
+  // 副作用のある I/O (OUT, pure でないポートからの IN) の回数
+  [[nodiscard]] uint32_t IOEffects() const { return io_effects_; }
+
  private:
   IOBus* bus_ = nullptr;
+  uint32_t io_effects_ = 0;
 };
 
 class MemStrategy {
@@ -90,11 +103,31 @@ class MemStrategy {
     *wr = wrpages_;
     return true;
   }
+  // ページごとのウェイト (クロック数)．メモリの割り当てを変える側が書き換える
+  uint8_t* GetWaits() { return waits_; }
+  // 副作用のあるメモリアクセス (書き込み, 関数ページからの読み出し) の回数
+  [[nodiscard]] uint32_t MemEffects() const { return mem_effects_; }
 
  protected:
   void ResetMemory() {
     instlim_ = nullptr;
     instbase_ = nullptr;
+    inst_wait_ = &waits_[0];
+  }
+
+  // 前回の呼び出しからのメモリアクセスのウェイトの合計を返す．
+  // ウェイトはアクセスごとに分岐せずに足し込み，CPU がクロックを進めるときにまとめて加える
+  int TakeWaits() {
+    int waits = wait_clocks_;
+    wait_clocks_ = 0;
+    return waits;
+  }
+  // 命令のフェッチ (M1 サイクル) 1 回分のウェイトを加える．
+  // オペランドの読み込みにはウェイトを加えない
+  void FetchWait() { wait_clocks_ += *inst_wait_; }
+  // addr へ count 回アクセスした分のウェイトを加える (ブロック命令の読み直し用)
+  void AddWaits(uint32_t addr, uint32_t count) {
+    wait_clocks_ += int(count) * waits_[(addr & 0xffff) >> pagebits];
   }
 
   // For generic memory access
@@ -103,9 +136,41 @@ class MemStrategy {
   void Write8(uint32_t addr, uint32_t data);
   void Write16(uint32_t a, uint32_t d);
 
+  // ブロック転送 (LDIR/LDDR) をまとめて行う．dir は 1 (増加) または -1 (減少)
+  // 領域が重なっていても 1 バイトずつ転送した場合と同じ結果になる．
+  // 関数ページに当たったところで止め，転送したバイト数を返す．
+  // 書き込み先がまとめ書きの関数 (MemoryHandler::block) を持つページなら，その関数で書き込む．
+  // CopyBlock, SkipBlock はデータの読み書きの分のウェイトを加える
+  uint32_t CopyBlock(uint32_t dst, uint32_t src, uint32_t count, int dir);
+  // src から count バイトのうち，data と一致しないバイトが先頭から何バイト続くか
+  // (CPIR/CPDR)．関数ページに当たったところで止める
+  uint32_t SkipBlock(uint32_t src, uint32_t count, int dir, uint32_t data);
+  // dst から dir 方向に書き込むとき，pc にある 2 バイトの命令を書き換えずに済むバイト数
+  static uint32_t BytesBefore(uint32_t dst, uint32_t pc, int dir) {
+    if (dir > 0)
+      return std::min((pc - dst) & 0xffff, (pc + 1 - dst) & 0xffff);
+    return std::min((dst - pc) & 0xffff, (dst - pc - 1) & 0xffff);
+  }
+  // addr が関数ページ上になければ，その内容を data に返す (副作用なし)
+  bool Peek8(uint32_t addr, uint32_t* data) const {
+    const MemoryPage page = rdpages_[(addr & 0xffff) >> pagebits];
+    if (page.func())
+      return false;
+    *data = page.mem()[addr & pagemask];
+    return true;
+  }
+
   // For memory read (from PC) (fast path)
   uint32_t Fetch8();
   uint32_t Fetch16();
+  // addr を含むページを識別する値 (Z80Profiler 用)
+  [[nodiscard]] intptr_t PageOf(uint32_t addr) const {
+    return rdpages_[(addr & 0xffff) >> pagebits].ptr;
+  }
+  // PC から次に読み込む 2 バイトが b0, b1 か (関数ページ上, ページ末尾では false)
+  [[nodiscard]] bool PeekInst(uint32_t b0, uint32_t b1) const {
+    return inst_ + 1 < instlim_ && inst_[0] == b0 && inst_[1] == b1;
+  }
 
   void SetPC(uint32_t newpc);
 
@@ -126,19 +191,27 @@ class MemStrategy {
 
   MemoryPage rdpages_[0x10000 >> pagebits]{};
   MemoryPage wrpages_[0x10000 >> pagebits]{};
+  uint8_t waits_[0x10000 >> pagebits]{};
+  int wait_clocks_ = 0;
+  const uint8_t* inst_wait_ = &waits_[0];  // inst_ のページのウェイト (関数ページなら 0)
 
   uint8_t* inst_ = nullptr;      // PC の指すメモリのポインタ，または PC そのもの
   uint8_t* instlim_ = nullptr;   // inst の有効上限
   uint8_t* instbase_ = nullptr;  // inst - PC        (PC = inst - instbase)
   uint8_t* instpage_ = nullptr;
+
+  uint32_t mem_effects_ = 0;
 };
 
 // I/O
 inline uint32_t IOStrategy::Inp(uint32_t port) {
+  if (!bus_->IsPurePort(port & 0xff))
+    ++io_effects_;
   return bus_->In(port & 0xff);
 }
 
 inline void IOStrategy::Outp(uint32_t port, uint32_t data) {
+  ++io_effects_;
   bus_->Out(port & 0xff, data);
 }
 
@@ -195,21 +268,25 @@ inline uint32_t MemStrategy::Fetch16() {
 
 inline uint32_t MemStrategy::Read8(uint32_t addr) {
   addr &= 0xffff;
-  MemoryPage& page = rdpages_[addr >> pagebits];
-  if (!page.func) {
-    return ((uint8_t*)page.ptr)[addr & pagemask];
-  } else {
-    return (*MemoryManager::RdFunc(intptr_t(page.ptr)))(page.inst, addr);
-  }
+  wait_clocks_ += waits_[addr >> pagebits];
+  const MemoryPage page = rdpages_[addr >> pagebits];
+  if (!page.func())
+    return page.mem()[addr & pagemask];
+  ++mem_effects_;
+  const MemoryHandler* handler = page.handler();
+  return (*MemoryManager::RdFunc(handler->func))(handler->inst, addr);
 }
 
 inline void MemStrategy::Write8(uint32_t addr, uint32_t data) {
   addr &= 0xffff;
-  MemoryPage& page = wrpages_[addr >> pagebits];
-  if (!page.func) {
-    ((uint8_t*)page.ptr)[addr & pagemask] = data;
+  ++mem_effects_;
+  wait_clocks_ += waits_[addr >> pagebits];
+  const MemoryPage page = wrpages_[addr >> pagebits];
+  if (!page.func()) {
+    page.mem()[addr & pagemask] = data;
   } else {
-    (*MemoryManager::WrFunc(intptr_t(page.ptr)))(page.inst, addr, data);
+    const MemoryHandler* handler = page.handler();
+    (*MemoryManager::WrFunc(handler->func))(handler->inst, addr, data);
   }
 }
 
@@ -0,0 +1,52 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  Z80 アイドルループ検出
+//
+
+#include "devices/z80_idle.h"
+
+// ---------------------------------------------------------------------------
+//  検出状態をクリア
+//
+void Z80IdleDetector::Reset() {
+  pc_ = ~0U;
+  iterations_ = 0;
+  period_ = 0;
+}
+
+// ---------------------------------------------------------------------------
+//  R, PC 以外のレジスタが同じか
+//
+bool Z80IdleDetector::SameState(const Z80Reg& a, const Z80Reg& b) {
+  return a.r.w.af == b.r.w.af && a.r.w.hl == b.r.w.hl && a.r.w.de == b.r.w.de &&
+         a.r.w.bc == b.r.w.bc && a.r.w.ix == b.r.w.ix && a.r.w.iy == b.r.w.iy &&
+         a.r.w.sp == b.r.w.sp && a.r_af == b.r_af && a.r_hl == b.r_hl && a.r_de == b.r_de &&
+         a.r_bc == b.r_bc && a.ireg == b.ireg && a.intmode == b.intmode && a.iff1 == b.iff1 &&
+         a.iff2 == b.iff2;
+}
+
+// ---------------------------------------------------------------------------
+//  ループ先頭での状態を確認
+//
+bool Z80IdleDetector::Check(uint32_t pc, const Z80Reg& reg, uint32_t side_effects,
+                            int64_t clocks) {
+  int64_t period = clocks - clocks_;
+  bool same = pc == pc_ && side_effects == side_effects_ && period > 0 &&
+              period <= kMaxLoopClocks && SameState(reg, reg_);
+
+  if (same && (iterations_ == 0 || period == period_)) {
+    ++iterations_;
+  } else {
+    iterations_ = 0;
+  }
+  period_ = period;
+  rdelta_ = (reg.rreg - reg_.rreg) & 0x7f;
+
+  pc_ = pc;
+  reg_ = reg;
+  side_effects_ = side_effects;
+  clocks_ = clocks;
+  return iterations_ >= kMinIterations;
+}
@@ -0,0 +1,67 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  Z80 アイドルループ検出
+//
+//  VRTC 待ちやキー入力待ちのような「同じ状態を読み続けるだけ」のループを
+//  検出する．CPU コアは後方分岐の飛び先 (ループ先頭) に到達するたびに
+//  Check を呼び出す．
+//
+//  次の条件を満たしたとき，ループはアイドル状態であるとみなす
+//  - 同じループ先頭に kMinIterations 回以上続けて到達した
+//  - その間レジスタ (R, PC を除く) が変化していない
+//  - その間副作用のあるメモリアクセス・I/O が行われていない
+//    (CPU コアが数える副作用カウンタが変化していない)
+//  - 1 周のクロック数が一定で kMaxLoopClocks 以下
+//
+//  アイドル状態のループは次のイベントまで同じ状態で回り続けるので，
+//  CPU コアは残りクロック分の周回をまとめて省略できる．
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include "devices/z80.h"
+
+class Z80IdleDetector {
+ public:
+  // ループとみなす後方分岐の最大距離
+  static constexpr uint32_t kMaxLoopBytes = 32;
+  // ループ 1 周の最大クロック数
+  static constexpr int64_t kMaxLoopClocks = 256;
+  // アイドルとみなすまでに必要な周回数
+  static constexpr int kMinIterations = 2;
+
+  Z80IdleDetector() = default;
+  ~Z80IdleDetector() = default;
+
+  void Reset();
+
+  // from から to への分岐がループ先頭への分岐か
+  static bool IsLoopBranch(uint32_t from, uint32_t to) {
+    return to < from && from - to <= kMaxLoopBytes;
+  }
+
+  // ループ先頭 pc に到達した時点の状態を渡す．
+  // reg の F は展開済みであること．clocks は単調増加するクロックカウンタ
+  // アイドル状態と判定した場合 true
+  bool Check(uint32_t pc, const Z80Reg& reg, uint32_t side_effects, int64_t clocks);
+
+  // 1 周あたりのクロック数と R の増分 (Check が true を返した場合のみ有効)
+  [[nodiscard]] int64_t period() const { return period_; }
+  [[nodiscard]] uint32_t rdelta() const { return rdelta_; }
+
+ private:
+  static bool SameState(const Z80Reg& a, const Z80Reg& b);
+
+  uint32_t pc_ = ~0U;
+  Z80Reg reg_{};
+  uint32_t side_effects_ = 0;
+  int64_t clocks_ = 0;
+
+  int64_t period_ = 0;
+  uint32_t rdelta_ = 0;
+  int iterations_ = 0;
+};
@@ -0,0 +1,120 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  Z80 実行プロファイラ
+//
+
+#include "devices/z80_profiler.h"
+
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+//  有効/無効
+//
+void Z80Profiler::Enable(bool enable) {
+  if (enable) {
+    if (users_++ == 0) {
+      // 無効だった間のクロックを数えないようにする
+      last_bank_ = nullptr;
+      InvalidatePages();
+    }
+  } else if (users_ > 0) {
+    --users_;
+  }
+}
+
+void Z80Profiler::InvalidatePages() {
+  // どのページの値とも一致しない値にしておき，次の Enter で引き直す
+  for (PageBank& p : pages_) {
+    p.page = -1;
+    p.bank = 0;
+  }
+}
+
+// ---------------------------------------------------------------------------
+//  集計結果
+//
+uint32_t Z80Profiler::Count(uint32_t bank, uint32_t pc) const {
+  if (bank >= banks_.size() || !banks_[bank])
+    return 0;
+  return banks_[bank]->count[pc & 0xffff];
+}
+
+uint64_t Z80Profiler::Cycles(uint32_t bank, uint32_t pc) const {
+  if (bank >= banks_.size() || !banks_[bank])
+    return 0;
+  return banks_[bank]->cycles[pc & 0xffff];
+}
+
+void Z80Profiler::Clear() {
+  for (auto& bank : banks_) {
+    if (bank)
+      memset(bank.get(), 0, sizeof(Bank));
+  }
+  last_bank_ = nullptr;
+}
+
+void Z80Profiler::Decay() {
+  for (auto& bank : banks_) {
+    if (!bank)
+      continue;
+    for (uint32_t& count : bank->count)
+      count = (count + 1) / 2;
+  }
+}
+
+// ---------------------------------------------------------------------------
+//  名前付きの範囲
+//
+int Z80Profiler::AddRange(uint32_t bank, uint32_t begin, uint32_t end, const std::string& name) {
+  ranges_.push_back({bank, begin, end, name});
+  return static_cast<int>(ranges_.size()) - 1;
+}
+
+uint64_t Z80Profiler::RangeCycles(int index) const {
+  if (index < 0 || index >= static_cast<int>(ranges_.size()))
+    return 0;
+  const Range& r = ranges_[index];
+  uint64_t cycles = 0;
+  for (uint32_t pc = r.begin; pc < r.end && pc < 0x10000; ++pc)
+    cycles += Cycles(r.bank, pc);
+  return cycles;
+}
+
+const Z80Profiler::Range* Z80Profiler::FindRange(uint32_t bank, uint32_t pc) const {
+  for (const Range& r : ranges_) {
+    if (r.bank == bank && r.begin <= pc && pc < r.end)
+      return &r;
+  }
+  return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+//  folded 形式で出力
+//  root;bank_XX;[範囲名;]PC クロック数
+//
+bool Z80Profiler::WriteFolded(FILE* fp, const char* root) const {
+  for (uint32_t b = 0; b < banks_.size(); ++b) {
+    const Bank* bank = banks_[b].get();
+    if (!bank)
+      continue;
+    for (uint32_t pc = 0; pc < 0x10000; ++pc) {
+      if (!bank->cycles[pc])
+        continue;
+      const Range* range = FindRange(b, pc);
+      if (fprintf(fp, "%s;bank_%02x;%s%s%04x %llu\n", root, b, range ? range->name.c_str() : "",
+                  range ? ";" : "", pc, static_cast<unsigned long long>(bank->cycles[pc])) < 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+bool Z80Profiler::WriteFolded(const char* path, const char* root) const {
+  FILE* fp = fopen(path, "w");
+  if (!fp)
+    return false;
+  bool r = WriteFolded(fp, root);
+  return fclose(fp) == 0 && r;
+}
@@ -0,0 +1,129 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  Z80 実行プロファイラ
+//
+//  (メモリバンク, PC) ごとに命令の実行回数と消費クロック数を数える．
+//  バンクは IGetMemoryBank::GetRdBank で求めるので，同じアドレスにある
+//  N88 ROM・拡張 ROM・ERAM などのコードを区別できる．
+//
+//  CPU コアは有効な間だけ，命令を実行する直前に Enter を呼び出す．
+//  直前の Enter からのクロック数が直前の命令の消費クロック数になる．
+//  無効な間 CPU コアは Enter を呼ばない (通常の実行ループには手を入れない)．
+//
+//  結果は folded 形式 ("root;bank;範囲;PC クロック数" の行) で出力できる．
+//  flamegraph.pl や speedscope などでフレームグラフに変換できる．
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/memory_manager.h"
+#include "if/ifcommon.h"
+
+class Z80Profiler {
+ public:
+  static constexpr uint32_t pagebits = MemoryManagerBase::pagebits;
+
+  Z80Profiler() = default;
+  ~Z80Profiler() = default;
+
+  // 複数のモニタなどから使われるので，Enable(true) と Enable(false) の回数で管理する
+  void Enable(bool enable);
+  [[nodiscard]] bool IsEnabled() const { return users_ > 0; }
+
+  // バンクの取得先 (nullptr ならすべてバンク 0)
+  void SetMemoryBank(IGetMemoryBank* bank) {
+    mem_bank_ = bank;
+    InvalidatePages();
+  }
+
+  // pc の命令を実行する直前に呼ぶ．page は pc を含むページを識別する値
+  // (MemoryPage::ptr)．clock は単調増加するクロックカウンタ
+  // 直前と同じ clock での呼び出しは同じ命令の続き (プレフィックスの後) とみなす
+  void Enter(uint32_t pc, intptr_t page, int64_t clock);
+
+  // 集計結果
+  [[nodiscard]] uint32_t Count(uint32_t bank, uint32_t pc) const;
+  [[nodiscard]] uint64_t Cycles(uint32_t bank, uint32_t pc) const;
+  void Clear();
+  // 実行回数を半分にする (メモリモニタの表示用)
+  void Decay();
+
+  // 名前付きの範囲 [begin, end) を登録する．出力ではこの範囲の PC をまとめる
+  int AddRange(uint32_t bank, uint32_t begin, uint32_t end, const std::string& name);
+  [[nodiscard]] uint64_t RangeCycles(int index) const;
+
+  // folded 形式で出力する．root は各行の先頭に付ける名前 (CPU 名など)
+  bool WriteFolded(FILE* fp, const char* root) const;
+  bool WriteFolded(const char* path, const char* root) const;
+
+ private:
+  struct Bank {
+    uint32_t count[0x10000];
+    uint64_t cycles[0x10000];
+  };
+  struct Range {
+    uint32_t bank;
+    uint32_t begin;
+    uint32_t end;
+    std::string name;
+  };
+  struct PageBank {
+    intptr_t page;
+    uint32_t bank;
+  };
+
+  uint32_t BankOf(uint32_t pc, intptr_t page);
+  void InvalidatePages();
+  const Range* FindRange(uint32_t bank, uint32_t pc) const;
+
+  int users_ = 0;
+  IGetMemoryBank* mem_bank_ = nullptr;
+
+  std::vector<std::unique_ptr<Bank>> banks_;
+  std::vector<Range> ranges_;
+
+  // ページごとのバンクのキャッシュ (ページの割り当てが変わったら引き直す)
+  PageBank pages_[0x10000 >> pagebits]{};
+
+  // 実行中の命令
+  Bank* last_bank_ = nullptr;
+  uint32_t last_pc_ = 0;
+  int64_t last_clock_ = 0;
+};
+
+inline void Z80Profiler::Enter(uint32_t pc, intptr_t page, int64_t clock) {
+  if (last_bank_) {
+    if (clock == last_clock_)
+      return;
+    last_bank_->cycles[last_pc_] += clock - last_clock_;
+  }
+
+  pc &= 0xffff;
+  uint32_t bank = BankOf(pc, page);
+  if (bank >= banks_.size())
+    banks_.resize(bank + 1);
+  if (!banks_[bank])
+    banks_[bank] = std::make_unique<Bank>();
+  last_bank_ = banks_[bank].get();
+  ++last_bank_->count[pc];
+  last_pc_ = pc;
+  last_clock_ = clock;
+}
+
+inline uint32_t Z80Profiler::BankOf(uint32_t pc, intptr_t page) {
+  PageBank& p = pages_[pc >> pagebits];
+  if (p.page != page) {
+    p.page = page;
+    p.bank = mem_bank_ ? mem_bank_->GetRdBank(pc) : 0;
+  }
+  return p.bank;
+}
@@ -109,55 +109,62 @@ void CPUExecutor::Init() {
 //
 // static
 int64_t CPUExecutor::ExecSingle(Z80C* first, Z80C* second, int64_t clocks) {
-  int64_t c = first->GetClocks();
+  return GetExecFunc(Z80ExecMode::kSingle, IsDumping(first, second))(first, second, clocks);
+}
 
-  currentcpu = first;
-  first->start_count_ = first->delay_count_ = c;
-  first->SingleStep();
-  first->TestIntr();
+// static
+int64_t CPUExecutor::ExecDual(Z80C* first, Z80C* second, int64_t count) {
+  return GetExecFunc(Z80ExecMode::kDual, IsDumping(first, second))(first, second, count);
+}
 
-  cbase = c;
-  first->Exec0(first, c + clocks, c);
+// static
+int64_t CPUExecutor::ExecDual2(Z80C* first, Z80C* second, int64_t count) {
+  return GetExecFunc(Z80ExecMode::kDual2, IsDumping(first, second))(first, second, count);
+}
 
-  c = first->GetClocks();
-  second->exec_clocks_ = c;
-  second->clock_count_ = 0;
+// static
+CPUExecutor::ExecFunc CPUExecutor::GetExecFunc(Z80ExecMode mode, bool dump) {
+  static const ExecFunc funcs[2][3] = {
+      {&RunSingle<false>, &RunDual<0, false>, &RunDual<1, false>},
+      {&RunSingle<true>, &RunDual<0, true>, &RunDual<1, true>},
+  };
+  return funcs[dump][static_cast<int>(mode)];
+}
 
-  return c - cbase;
+// static
+bool CPUExecutor::IsDumping(const Z80C* first, const Z80C* second) {
+  return first->dump_log_ || second->dump_log_;
 }
 
 // ---------------------------------------------------------------------------
-// 2CPU 実行
+// 1CPU 実行
 //
 // static
-int64_t CPUExecutor::ExecDual(Z80C* first, Z80C* second, int64_t count) {
-  currentcpu = second;
-  second->start_count_ = second->delay_count_ = first->GetClocks();
-  second->SingleStep();
-  second->TestIntr();
+template <bool kDump>
+int64_t CPUExecutor::RunSingle(Z80C* first, Z80C* second, int64_t clocks) {
+  int64_t c = first->GetClocks();
+
   currentcpu = first;
-  first->start_count_ = first->delay_count_ = second->GetClocks();
+  first->start_count_ = first->delay_count_ = c;
   first->SingleStep();
   first->TestIntr();
 
-  int64_t c1 = first->GetClocks();
-  int64_t c2 = second->GetClocks();
-  int64_t delay = c2 - c1;
-  cbase = delay > 0 ? c1 : c2;
-  int64_t stop = cbase + count;
+  cbase = c;
+  first->Exec<0, kDump>(first, c + clocks, c);
 
-  while ((stop - first->GetClocks() > 0) || (stop - second->GetClocks() > 0)) {
-    stop = first->Exec0(first, stop, second->GetClocks());
-    stop = second->Exec0(second, stop, first->GetClocks());
-  }
-  return stop - cbase;
+  c = first->GetClocks();
+  second->exec_clocks_ = c;
+  second->clock_count_ = 0;
+
+  return c - cbase;
 }
 
 // ---------------------------------------------------------------------------
-// 2CPU 実行
+// 2CPU 実行 (main:sub = 1:1 または 2:1)
 //
 // static
-int64_t CPUExecutor::ExecDual2(Z80C* first, Z80C* second, int64_t count) {
+template <int kShift, bool kDump>
+int64_t CPUExecutor::RunDual(Z80C* first, Z80C* second, int64_t count) {
   currentcpu = second;
   second->start_count_ = second->delay_count_ = first->GetClocks();
   second->SingleStep();
@@ -174,8 +181,8 @@ int64_t CPUExecutor::ExecDual2(Z80C* first, Z80C* second, int64_t count) {
   int64_t stop = cbase + count;
 
   while ((stop - first->GetClocks() > 0) || (stop - second->GetClocks() > 0)) {
-    stop = first->Exec0(first, stop, second->GetClocks());
-    stop = second->Exec1(second, stop, first->GetClocks());
+    stop = first->Exec<0, kDump>(first, stop, second->GetClocks());
+    stop = second->Exec<kShift, kDump>(second, stop, first->GetClocks());
   }
   return stop - cbase;
 }
@@ -183,51 +190,24 @@ int64_t CPUExecutor::ExecDual2(Z80C* first, Z80C* second, int64_t count) {
 // ---------------------------------------------------------------------------
 // 片方実行
 //
-int64_t CPUExecutor::Exec0(Z80C* cpu, int64_t stop, int64_t other) {
+template <int kShift, bool kDump>
+int64_t CPUExecutor::Exec(Z80C* cpu, int64_t stop, int64_t other) {
   int64_t clocks = stop - GetClocks();
   if (clocks > 0) {
-    eshift_ = 0;
+    eshift_ = kShift;
     currentcpu = cpu;
     stop_count_ = stop;
     delay_count_ = other;
-    exec_clocks_ += clock_count_ + clocks;
+    exec_clocks_ += clock_count_ * (1 << kShift) + clocks;
 
-    if (dump_log_) {
-      for (clock_count_ = -clocks; clock_count_ < 0;) {
+    if (kDump && cpu->dump_log_) {
+      for (clock_count_ = -clocks / (1 << kShift); clock_count_ < 0;) {
         cpu->DumpLog();
         cpu->SingleStep();
       }
     } else {
-      for (clock_count_ = -clocks; clock_count_ < 0;)
-        cpu->SingleStep();
-    }
-    currentcpu = nullptr;
-    return stop_count_;
-  } else {
-    return stop;
-  }
-}
-
-// ---------------------------------------------------------------------------
-// 片方実行
-//
-int64_t CPUExecutor::Exec1(Z80C* cpu, int64_t stop, int64_t other) {
-  int64_t clocks = stop - GetClocks();
-  if (clocks > 0) {
-    eshift_ = 1;
-    currentcpu = cpu;
-    stop_count_ = stop;
-    delay_count_ = other;
-    exec_clocks_ += clock_count_ * 2 + clocks;
-    if (dump_log_) {
-      for (clock_count_ = -clocks / 2; clock_count_ < 0;) {
-        cpu->DumpLog();
-        cpu->SingleStep();
-      }
-    } else {
-      for (clock_count_ = -clocks / 2; clock_count_ < 0;) {
-        cpu->SingleStep();
-      }
+      clock_count_ = -clocks / (1 << kShift);
+      cpu->Run();
     }
     currentcpu = nullptr;
     return stop_count_;
@@ -243,12 +223,22 @@ bool CPUExecutor::Sync() {
   // もう片方のCPUよりも遅れているか？
   if (GetClocks() - delay_count_ <= 1)
     return true;
-  // 進んでいた場合 Exec0 を抜ける
+  // 進んでいた場合 Exec を抜ける
   exec_clocks_ += clock_count_ << eshift_;
   clock_count_ = 0;
   return false;
 }
 
+// ---------------------------------------------------------------------------
+// 残りクロックを超えない範囲で period クロックの周回を省略する
+// period は GetClocks の単位．省略した周回数を返す
+//
+int64_t CPUExecutor::SkipClocks(int64_t period) {
+  int64_t n = ((-clock_count_) << eshift_) / period;
+  clock_count_ += (n * period) >> eshift_;
+  return n;
+}
+
 // ---------------------------------------------------------------------------
 // Exec を途中で中断
 //
@@ -273,6 +263,66 @@ inline void Z80C::SingleStep() {
   SingleStep(Fetch8());
 }
 
+// ---------------------------------------------------------------------------
+// 命令を clock_count_ が尽きるまで実行
+//
+inline void Z80C::Run() {
+  if (profiler_.IsEnabled()) {
+    RunProfile();
+    return;
+  }
+  if (idle_skip_) {
+    RunIdleSkip();
+    return;
+  }
+#ifdef Z80C_THREADED_DISPATCH
+  if (clock_count_ < 0)
+    SingleStep(Fetch8(), true);
+#else
+  while (clock_count_ < 0)
+    SingleStep();
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// アイドルループを検出しながら実行
+//
+void Z80C::RunIdleSkip() {
+  while (clock_count_ < 0) {
+    uint32_t pc = GetPC();
+    SingleStep();
+    uint32_t npc = GetPC();
+    if (Z80IdleDetector::IsLoopBranch(pc, npc))
+      CheckIdle(npc);
+  }
+}
+
+void Z80C::CheckIdle(uint32_t pc) {
+  GetAF();
+  uint32_t effects = IOEffects() + MemEffects();
+  if (!idle_.Check(pc, reg_, effects, GetClocks()))
+    return;
+  int64_t n = SkipClocks(idle_.period());
+  reg_.rreg += uint8_t(n * idle_.rdelta());
+  idle_.Reset();
+}
+
+void Z80C::EnableIdleSkip(bool enable) {
+  idle_skip_ = enable;
+  idle_.Reset();
+}
+
+// ---------------------------------------------------------------------------
+// プロファイラに記録しながら実行
+//
+void Z80C::RunProfile() {
+  while (clock_count_ < 0) {
+    uint32_t pc = GetPC();
+    profiler_.Enter(pc, PageOf(pc), GetClocks());
+    SingleStep();
+  }
+}
+
 // ---------------------------------------------------------------------------
 // リセット
 //
@@ -295,6 +345,7 @@ void Z80C::Reset(uint32_t, uint32_t) {
   SetRegSP(0);
   wait_state_ = 0;
   intr_ = false;  // 割り込みクリア
+  idle_.Reset();
 
   CPUExecutor::Reset();
 }
@@ -608,53 +659,135 @@ uint8_t Z80C::SRL(uint8_t d) {
   return d;
 }
 
+// ---------------------------------------------------------------------------
+// 命令ディスパッチ
+//
+// Z80C_THREADED_DISPATCH を定義すると，Run() から呼ばれた SingleStep は
+// 1 命令ごとに関数を抜けず，命令の末尾 (NEXT_OP) から次の命令へ直接分岐する．
+// GCC/Clang では computed goto によるラベルテーブル (主命令と ED 系) を使い，
+// それ以外のコンパイラでは switch の先頭に戻る．
+//
+#if defined(Z80C_THREADED_DISPATCH) && defined(__GNUC__)
+#define Z80C_COMPUTED_GOTO
+#endif
+
+#ifdef Z80C_COMPUTED_GOTO
+#define OPCODE(n) \
+  case n:         \
+  op_##n
+#define OPCODE_ED(n) \
+  case n:            \
+  ed_##n
+#define OPCODE_ED_DEFAULT \
+  default:                \
+  ed_default
+#define DISPATCH(table, n) goto* table[n]
+#define NEXT_OP                      \
+  do {                               \
+    if (!chain || clock_count_ >= 0) \
+      return;                        \
+    m = Fetch8();                    \
+    reg_.rreg++;                     \
+    FetchWait();                     \
+    goto* main_ops[m];               \
+  } while (0)
+
+#define OPS16(p, h)                                                                           \
+  &&p##h##0, &&p##h##1, &&p##h##2, &&p##h##3, &&p##h##4, &&p##h##5, &&p##h##6, &&p##h##7, \
+      &&p##h##8, &&p##h##9, &&p##h##a, &&p##h##b, &&p##h##c, &&p##h##d, &&p##h##e, &&p##h##f
+#define ED_UNDEF4 &&ed_default, &&ed_default, &&ed_default, &&ed_default
+#define ED_UNDEF16 ED_UNDEF4, ED_UNDEF4, ED_UNDEF4, ED_UNDEF4
+#else
+#define OPCODE(n) case n
+#define OPCODE_ED(n) case n
+#define OPCODE_ED_DEFAULT default
+#define DISPATCH(table, n)
+#ifdef Z80C_THREADED_DISPATCH
+#define NEXT_OP                      \
+  do {                               \
+    if (!chain || clock_count_ >= 0) \
+      return;                        \
+    m = Fetch8();                    \
+    goto dispatch;                   \
+  } while (0)
+#else
+#define NEXT_OP break
+#endif
+#endif
+
 // ---------------------------------------------------------------------------
 // １命令実行
+//  chain が true の場合，clock_count_ が尽きるまで続けて実行する
+//  (Z80C_THREADED_DISPATCH 時のみ)
 //
-void Z80C::SingleStep(uint32_t m) {
+void Z80C::SingleStep(uint32_t m, [[maybe_unused]] bool chain) {
+#ifdef Z80C_COMPUTED_GOTO
+  static void* const main_ops[256] = {
+      OPS16(op_, 0x0), OPS16(op_, 0x1), OPS16(op_, 0x2), OPS16(op_, 0x3),
+      OPS16(op_, 0x4), OPS16(op_, 0x5), OPS16(op_, 0x6), OPS16(op_, 0x7),
+      OPS16(op_, 0x8), OPS16(op_, 0x9), OPS16(op_, 0xa), OPS16(op_, 0xb),
+      OPS16(op_, 0xc), OPS16(op_, 0xd), OPS16(op_, 0xe), OPS16(op_, 0xf),
+  };
+  static void* const ed_ops[256] = {
+      ED_UNDEF16, ED_UNDEF16, ED_UNDEF16, ED_UNDEF16,
+      OPS16(ed_, 0x4), OPS16(ed_, 0x5), OPS16(ed_, 0x6),
+      &&ed_0x70, &&ed_0x71, &&ed_0x72, &&ed_0x73, &&ed_0x74, &&ed_0x75, &&ed_0x76, &&ed_default,
+      &&ed_0x78, &&ed_0x79, &&ed_0x7a, &&ed_0x7b, &&ed_0x7c, &&ed_0x7d, &&ed_0x7e, &&ed_default,
+      ED_UNDEF16, ED_UNDEF16,
+      &&ed_0xa0, &&ed_0xa1, &&ed_0xa2, &&ed_0xa3, ED_UNDEF4,
+      &&ed_0xa8, &&ed_0xa9, &&ed_0xaa, &&ed_0xab, ED_UNDEF4,
+      &&ed_0xb0, &&ed_0xb1, &&ed_0xb2, &&ed_0xb3, ED_UNDEF4,
+      &&ed_0xb8, &&ed_0xb9, &&ed_0xba, &&ed_0xbb, ED_UNDEF4,
+      ED_UNDEF16, ED_UNDEF16, ED_UNDEF16, ED_UNDEF16,
+  };
+#elif defined(Z80C_THREADED_DISPATCH)
+dispatch:
+#endif
   reg_.rreg++;
+  FetchWait();
 
+  DISPATCH(main_ops, m);
   switch (m) {
     uint8_t b;
     uint32_t w;
 
       // ローテートシフト系
 
-    case 0x07:  // RLCA
+    OPCODE(0x07):  // RLCA
       b = (0 != (RegA() & 0x80));
       SetRegA(RegA() * 2 + b);
       SetFlags(NF | HF | CF, b);  // Cn = 1
       CLK(4);
       SetXF(RegA());
-      break;
+      NEXT_OP;
 
-    case 0x0f:  // RRCA
+    OPCODE(0x0f):  // RRCA
       b = RegA() & 1;
       SetRegA((RegA() >> 1) + (b ? 0x80 : 0));
       SetFlags(NF | HF | CF, b);
       CLK(4);
       SetXF(RegA());
-      break;
+      NEXT_OP;
 
-    case 0x17:  // RLA
+    OPCODE(0x17):  // RLA
       b = RegA();
       SetRegA((b << 1) + GetCF());
       SetFlags(NF | HF | CF, (b & 0x80) ? CF : 0);
       CLK(4);
       SetXF(RegA());
-      break;
+      NEXT_OP;
 
-    case 0x1f:  // RRA
+    OPCODE(0x1f):  // RRA
       b = RegA();
       SetRegA((GetCF() ? 0x80 : 0) + (b >> 1));
       SetFlags(NF | HF | CF, b & 1);
       CLK(4);
       SetXF(RegA());
-      break;
+      NEXT_OP;
 
       // arthimatic operation
 
-    case 0x27:  // DAA
+    OPCODE(0x27):  // DAA
       b = 0;
       if (!GetNF()) {
         if ((RegA() & 0x0f) > 9 || GetHF()) {
@@ -680,227 +813,227 @@ void Z80C::SingleStep(uint32_t m) {
       SetZSP(RegA());
       SetFlags(HF | CF, b);
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0x2f:  // CPL
+    OPCODE(0x2f):  // CPL
       SetRegA(~RegA());
       SetFlags(NF | HF, NF | HF);
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0x37:  // SCF
+    OPCODE(0x37):  // SCF
       SetFlags(CF | NF | HF, CF);
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0x3f:  // CCF
+    OPCODE(0x3f):  // CCF
       b = GetCF();
       SetFlags(CF | NF, b ^ CF);
       CLK(4);
-      break;
+      NEXT_OP;
 
       // I/O access
 
-    case 0xdb:  // IN A,(n)
+    OPCODE(0xdb):  // IN A,(n)
       w = /*(uint32_t(RegA()) << 8) + */ Fetch8();
       if (IsSyncPort(w) && !Sync()) {
         PCDec(2);
-        break;
+        NEXT_OP;
       }
       SetRegA(Inp(w));
       CLK(11);
-      break;
+      NEXT_OP;
 
-    case 0xd3:  // OUT (n),A
+    OPCODE(0xd3):  // OUT (n),A
       w = /*(uint32_t(RegA()) << 8) + */ Fetch8();
       if (IsSyncPort(w) && !Sync()) {
         PCDec(2);
-        break;
+        NEXT_OP;
       }
       Outp(w, RegA());
       SetPC(GetPC());
       CLK(11);
       OutTestIntr();
-      break;
+      NEXT_OP;
 
       // branch op.
 
-    case 0xc3:  // JP
+    OPCODE(0xc3):  // JP
       Jump(Fetch16());
       CLK(10);
-      break;
+      NEXT_OP;
 
-    case 0xc2:  // NZ
+    OPCODE(0xc2):  // NZ
       if (!GetZF())
         Jump(Fetch16());
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xca:  // Z
+      NEXT_OP;
+    OPCODE(0xca):  // Z
       if (GetZF())
         Jump(Fetch16());
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xd2:  // NC
+      NEXT_OP;
+    OPCODE(0xd2):  // NC
       if (!GetCF())
         Jump(Fetch16());
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xda:  // C
+      NEXT_OP;
+    OPCODE(0xda):  // C
       if (GetCF())
         Jump(Fetch16());
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xe2:  // PO
+      NEXT_OP;
+    OPCODE(0xe2):  // PO
       if (!GetPF())
         Jump(Fetch16());
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xea:  // PE
+      NEXT_OP;
+    OPCODE(0xea):  // PE
       if (GetPF())
         Jump(Fetch16());
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xf2:  // P
+      NEXT_OP;
+    OPCODE(0xf2):  // P
       if (!GetSF())
         Jump(Fetch16());
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xfa:  // M
+      NEXT_OP;
+    OPCODE(0xfa):  // M
       if (GetSF())
         Jump(Fetch16());
       else
         PCInc(2);
       CLK(10);
-      break;
+      NEXT_OP;
 
-    case 0xcd:  // CALL
+    OPCODE(0xcd):  // CALL
       Call();
       CLK(10);
-      break;
+      NEXT_OP;
 
-    case 0xc4:  // NZ
+    OPCODE(0xc4):  // NZ
       if (!GetZF())
         Call();
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xcc:  // Z
+      NEXT_OP;
+    OPCODE(0xcc):  // Z
       if (GetZF())
         Call();
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xd4:  // NC
+      NEXT_OP;
+    OPCODE(0xd4):  // NC
       if (!GetCF())
         Call();
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xdc:  // C
+      NEXT_OP;
+    OPCODE(0xdc):  // C
       if (GetCF())
         Call();
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xe4:  // PO
+      NEXT_OP;
+    OPCODE(0xe4):  // PO
       if (!GetPF())
         Call();
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xec:  // PE
+      NEXT_OP;
+    OPCODE(0xec):  // PE
       if (GetPF())
         Call();
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xf4:  // P
+      NEXT_OP;
+    OPCODE(0xf4):  // P
       if (!GetSF())
         Call();
       else
         PCInc(2);
       CLK(10);
-      break;
-    case 0xfc:  // M
+      NEXT_OP;
+    OPCODE(0xfc):  // M
       if (GetSF())
         Call();
       else
         PCInc(2);
       CLK(10);
-      break;
+      NEXT_OP;
 
-    case 0xc9:  // RET
+    OPCODE(0xc9):  // RET
       Ret();
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0xc0:  // NZ
+    OPCODE(0xc0):  // NZ
       if (!GetZF())
         Ret();
       CLK(4);
-      break;
-    case 0xc8:  // Z
+      NEXT_OP;
+    OPCODE(0xc8):  // Z
       if (GetZF())
         Ret();
       CLK(4);
-      break;
-    case 0xd0:  // NC
+      NEXT_OP;
+    OPCODE(0xd0):  // NC
       if (!GetCF())
         Ret();
       CLK(4);
-      break;
-    case 0xd8:  // C
+      NEXT_OP;
+    OPCODE(0xd8):  // C
       if (GetCF())
         Ret();
       CLK(4);
-      break;
-    case 0xe0:  // PO
+      NEXT_OP;
+    OPCODE(0xe0):  // PO
       if (!GetPF())
         Ret();
       CLK(4);
-      break;
-    case 0xe8:  // PE
+      NEXT_OP;
+    OPCODE(0xe8):  // PE
       if (GetPF())
         Ret();
       CLK(4);
-      break;
-    case 0xf0:  // P
+      NEXT_OP;
+    OPCODE(0xf0):  // P
       if (!GetSF())
         Ret();
       CLK(4);
-      break;
-    case 0xf8:  // M
+      NEXT_OP;
+    OPCODE(0xf8):  // M
       if (GetSF())
         Ret();
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0x18:  // JR
+    OPCODE(0x18):  // JR
       JumpR(Fetch8());
       CLK(12);
-      break;
+      NEXT_OP;
 
-    case 0x20:  // NZ
+    OPCODE(0x20):  // NZ
       if (!GetZF()) {
         JumpR(Fetch8());
         CLK(5);
@@ -908,8 +1041,8 @@ void Z80C::SingleStep(uint32_t m) {
         PCInc(1);
       }
       CLK(7);
-      break;
-    case 0x28:  // Z
+      NEXT_OP;
+    OPCODE(0x28):  // Z
       if (GetZF()) {
         JumpR(Fetch8());
         CLK(5);
@@ -917,8 +1050,8 @@ void Z80C::SingleStep(uint32_t m) {
         PCInc(1);
       }
       CLK(7);
-      break;
-    case 0x30:  // NC
+      NEXT_OP;
+    OPCODE(0x30):  // NC
       if (!GetCF()) {
         JumpR(Fetch8());
         CLK(5);
@@ -926,8 +1059,8 @@ void Z80C::SingleStep(uint32_t m) {
         PCInc(1);
       }
       CLK(7);
-      break;
-    case 0x38:  // C
+      NEXT_OP;
+    OPCODE(0x38):  // C
       if (GetCF()) {
         JumpR(Fetch8());
         CLK(5);
@@ -935,14 +1068,14 @@ void Z80C::SingleStep(uint32_t m) {
         PCInc(1);
       }
       CLK(7);
-      break;
+      NEXT_OP;
 
-    case 0xe9:  // JP (HL)
+    OPCODE(0xe9):  // JP (HL)
       SetPC(RegXHL());
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0x10:  // DJNZ
+    OPCODE(0x10):  // DJNZ
       SetRegB(RegB() - 1);
       if (0 != RegB()) {
         JumpR(Fetch8());
@@ -951,130 +1084,130 @@ void Z80C::SingleStep(uint32_t m) {
         PCInc(1);
       }
       CLK(5);
-      break;
+      NEXT_OP;
 
-    case 0xc7:  // RST 00H
+    OPCODE(0xc7):  // RST 00H
       Push(GetPC());
       Jump(0x00);
       CLK(4);
-      break;
-    case 0xcf:  // RST 08H
+      NEXT_OP;
+    OPCODE(0xcf):  // RST 08H
       Push(GetPC());
       Jump(0x08);
       CLK(4);
-      break;
-    case 0xd7:  // RST 10H
+      NEXT_OP;
+    OPCODE(0xd7):  // RST 10H
       Push(GetPC());
       Jump(0x10);
       CLK(4);
-      break;
-    case 0xdf:  // RST 18H
+      NEXT_OP;
+    OPCODE(0xdf):  // RST 18H
       Push(GetPC());
       Jump(0x18);
       CLK(4);
-      break;
-    case 0xe7:  // RST 20H
+      NEXT_OP;
+    OPCODE(0xe7):  // RST 20H
       Push(GetPC());
       Jump(0x20);
       CLK(4);
-      break;
-    case 0xef:  // RST 28H
+      NEXT_OP;
+    OPCODE(0xef):  // RST 28H
       Push(GetPC());
       Jump(0x28);
       CLK(4);
-      break;
-    case 0xf7:  // RST 30H
+      NEXT_OP;
+    OPCODE(0xf7):  // RST 30H
       Push(GetPC());
       Jump(0x30);
       CLK(4);
-      break;
-    case 0xff:  // RST 38H
+      NEXT_OP;
+    OPCODE(0xff):  // RST 38H
       Push(GetPC());
       Jump(0x38);
       CLK(4);
-      break;
+      NEXT_OP;
 
       // 16 bit arithmatic operations
 
     // ADD XHL,dd
-    case 0x09:  // BC
+    OPCODE(0x09):  // BC
       SetRegXHL(ADD16(RegXHL(), RegBC()));
       CLK(11);
-      break;
-    case 0x19:  // DE
+      NEXT_OP;
+    OPCODE(0x19):  // DE
       SetRegXHL(ADD16(RegXHL(), RegDE()));
       CLK(11);
-      break;
-    case 0x29:  // xHL
+      NEXT_OP;
+    OPCODE(0x29):  // xHL
       w = RegXHL();
       SetRegXHL(ADD16(w, w));
       CLK(11);
-      break;
-    case 0x39:  // SP
+      NEXT_OP;
+    OPCODE(0x39):  // SP
       SetRegXHL(ADD16(RegXHL(), RegSP()));
       CLK(11);
-      break;
+      NEXT_OP;
 
     // INC dd
-    case 0x03:  // BC
+    OPCODE(0x03):  // BC
       SetRegBC(RegBC() + 1);
       CLK(6);
-      break;
-    case 0x13:  // DE
+      NEXT_OP;
+    OPCODE(0x13):  // DE
       SetRegDE(RegDE() + 1);
       CLK(6);
-      break;
-    case 0x23:  // xHL
+      NEXT_OP;
+    OPCODE(0x23):  // xHL
       SetRegXHL(RegXHL() + 1);
       CLK(6);
-      break;
-    case 0x33:  // SP
+      NEXT_OP;
+    OPCODE(0x33):  // SP
       SetRegSP(RegSP() + 1);
       CLK(6);
-      break;
+      NEXT_OP;
 
     // DEC dd
-    case 0x0B:  // BC
+    OPCODE(0x0b):  // BC
       SetRegBC(RegBC() - 1);
       CLK(6);
-      break;
-    case 0x1B:  // DE
+      NEXT_OP;
+    OPCODE(0x1b):  // DE
       SetRegDE(RegDE() - 1);
       CLK(6);
-      break;
-    case 0x2B:  // xHL
+      NEXT_OP;
+    OPCODE(0x2b):  // xHL
       SetRegXHL(RegXHL() - 1);
       CLK(6);
-      break;
-    case 0x3B:  // SP
+      NEXT_OP;
+    OPCODE(0x3b):  // SP
       SetRegSP(RegSP() - 1);
       CLK(6);
-      break;
+      NEXT_OP;
 
       // exchange
 
-    case 0x08:  // EX AF,AF'
+    OPCODE(0x08):  // EX AF,AF'
       w = GetAF();
       SetAF(reg_.r_af);
       reg_.r_af = w;
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0xe3:  // EX (SP),xHL
+    OPCODE(0xe3):  // EX (SP),xHL
       w = Read16(RegSP());
       Write16(RegSP(), RegXHL());
       SetRegXHL(w);
       CLK(19);
-      break;
+      NEXT_OP;
 
-    case 0xeb:  // EX DE,HL
+    OPCODE(0xeb):  // EX DE,HL
       w = RegDE();
       SetRegDE(RegHL());
       SetRegHL(w);
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0xd9:  // EXX
+    OPCODE(0xd9):  // EXX
       w = RegHL();
       SetRegHL(reg_.r_hl);
       reg_.r_hl = w;
@@ -1085,16 +1218,16 @@ void Z80C::SingleStep(uint32_t m) {
       SetRegBC(reg_.r_bc);
       reg_.r_bc = w;
       CLK(4);
-      break;
+      NEXT_OP;
 
       // CPU control
 
-    case 0xf3:  // DI
+    OPCODE(0xf3):  // DI
       reg_.iff1 = reg_.iff2 = false;
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0xfb:  // EI
+    OPCODE(0xfb):  // EI
       w = Fetch8();
       CLK(4);
       if ((w & 0xf7) != 0xf3) {
@@ -1103,13 +1236,13 @@ void Z80C::SingleStep(uint32_t m) {
         TestIntr();
       } else
         PCDec(1);
-      break;
+      NEXT_OP;
 
-    case 0x00:  // NOP
+    OPCODE(0x00):  // NOP
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0x76:  // HALT
+    OPCODE(0x76):  // HALT
       PCDec(1);
       wait_state_ = 1;
       if (intr_) {
@@ -1117,345 +1250,345 @@ void Z80C::SingleStep(uint32_t m) {
         CLK(64);
       } else
         clock_count_ = 0;
-      break;
+      NEXT_OP;
 
       // 8 bit arithmatic
 
     // ADD A,-
-    case 0x80:  // B
+    OPCODE(0x80):  // B
       ADDA(RegB());
       CLK(4);
-      break;
-    case 0x81:  // C
+      NEXT_OP;
+    OPCODE(0x81):  // C
       ADDA(RegC());
       CLK(4);
-      break;
-    case 0x82:  // D
+      NEXT_OP;
+    OPCODE(0x82):  // D
       ADDA(RegD());
       CLK(4);
-      break;
-    case 0x83:  // E
+      NEXT_OP;
+    OPCODE(0x83):  // E
       ADDA(RegE());
       CLK(4);
-      break;
-    case 0x84:  // H
+      NEXT_OP;
+    OPCODE(0x84):  // H
       ADDA(RegXH());
       CLK(4);
-      break;
-    case 0x85:  // L
+      NEXT_OP;
+    OPCODE(0x85):  // L
       ADDA(RegXL());
       CLK(4);
-      break;
-    case 0x86:  // M
+      NEXT_OP;
+    OPCODE(0x86):  // M
       ADDA(GetM());
       CLK(7);
-      break;
-    case 0x87:  // A
+      NEXT_OP;
+    OPCODE(0x87):  // A
       ADDA(RegA());
       CLK(4);
-      break;
-    case 0xc6:  // n
+      NEXT_OP;
+    OPCODE(0xc6):  // n
       ADDA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // ADC A,-
-    case 0x88:  // B
+    OPCODE(0x88):  // B
       ADCA(RegB());
       CLK(4);
-      break;
-    case 0x89:  // C
+      NEXT_OP;
+    OPCODE(0x89):  // C
       ADCA(RegC());
       CLK(4);
-      break;
-    case 0x8a:  // D
+      NEXT_OP;
+    OPCODE(0x8a):  // D
       ADCA(RegD());
       CLK(4);
-      break;
-    case 0x8b:  // E
+      NEXT_OP;
+    OPCODE(0x8b):  // E
       ADCA(RegE());
       CLK(4);
-      break;
-    case 0x8c:  // H
+      NEXT_OP;
+    OPCODE(0x8c):  // H
       ADCA(RegXH());
       CLK(4);
-      break;
-    case 0x8d:  // L
+      NEXT_OP;
+    OPCODE(0x8d):  // L
       ADCA(RegXL());
       CLK(4);
-      break;
-    case 0x8e:  // M
+      NEXT_OP;
+    OPCODE(0x8e):  // M
       ADCA(GetM());
       CLK(7);
-      break;
-    case 0x8f:  // A
+      NEXT_OP;
+    OPCODE(0x8f):  // A
       ADCA(RegA());
       CLK(4);
-      break;
-    case 0xce:  // n
+      NEXT_OP;
+    OPCODE(0xce):  // n
       ADCA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // SUB -
-    case 0x90:  // B
+    OPCODE(0x90):  // B
       SUBA(RegB());
       CLK(4);
-      break;
-    case 0x91:  // C
+      NEXT_OP;
+    OPCODE(0x91):  // C
       SUBA(RegC());
       CLK(4);
-      break;
-    case 0x92:  // D
+      NEXT_OP;
+    OPCODE(0x92):  // D
       SUBA(RegD());
       CLK(4);
-      break;
-    case 0x93:  // E
+      NEXT_OP;
+    OPCODE(0x93):  // E
       SUBA(RegE());
       CLK(4);
-      break;
-    case 0x94:  // H
+      NEXT_OP;
+    OPCODE(0x94):  // H
       SUBA(RegXH());
       CLK(4);
-      break;
-    case 0x95:  // L
+      NEXT_OP;
+    OPCODE(0x95):  // L
       SUBA(RegXL());
       CLK(4);
-      break;
-    case 0x96:  // M
+      NEXT_OP;
+    OPCODE(0x96):  // M
       SUBA(GetM());
       CLK(7);
-      break;
-    case 0x97:  // A
+      NEXT_OP;
+    OPCODE(0x97):  // A
       SUBA(RegA());
       CLK(4);
-      break;
-    case 0xd6:  // n
+      NEXT_OP;
+    OPCODE(0xd6):  // n
       SUBA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // SBC A,-
-    case 0x98:  // B
+    OPCODE(0x98):  // B
       SBCA(RegB());
       CLK(4);
-      break;
-    case 0x99:  // C
+      NEXT_OP;
+    OPCODE(0x99):  // C
       SBCA(RegC());
       CLK(4);
-      break;
-    case 0x9a:  // D
+      NEXT_OP;
+    OPCODE(0x9a):  // D
       SBCA(RegD());
       CLK(4);
-      break;
-    case 0x9b:  // E
+      NEXT_OP;
+    OPCODE(0x9b):  // E
       SBCA(RegE());
       CLK(4);
-      break;
-    case 0x9c:  // H
+      NEXT_OP;
+    OPCODE(0x9c):  // H
       SBCA(RegXH());
       CLK(4);
-      break;
-    case 0x9d:  // L
+      NEXT_OP;
+    OPCODE(0x9d):  // L
       SBCA(RegXL());
       CLK(4);
-      break;
-    case 0x9e:  // M
+      NEXT_OP;
+    OPCODE(0x9e):  // M
       SBCA(GetM());
       CLK(7);
-      break;
-    case 0x9f:  // A
+      NEXT_OP;
+    OPCODE(0x9f):  // A
       SBCA(RegA());
       CLK(4);
-      break;
-    case 0xde:  // n
+      NEXT_OP;
+    OPCODE(0xde):  // n
       SBCA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // AND -
-    case 0xa0:  // B
+    OPCODE(0xa0):  // B
       ANDA(RegB());
       CLK(4);
-      break;
-    case 0xa1:  // C
+      NEXT_OP;
+    OPCODE(0xa1):  // C
       ANDA(RegC());
       CLK(4);
-      break;
-    case 0xa2:  // D
+      NEXT_OP;
+    OPCODE(0xa2):  // D
       ANDA(RegD());
       CLK(4);
-      break;
-    case 0xa3:  // E
+      NEXT_OP;
+    OPCODE(0xa3):  // E
       ANDA(RegE());
       CLK(4);
-      break;
-    case 0xa4:  // H
+      NEXT_OP;
+    OPCODE(0xa4):  // H
       ANDA(RegXH());
       CLK(4);
-      break;
-    case 0xa5:  // L
+      NEXT_OP;
+    OPCODE(0xa5):  // L
       ANDA(RegXL());
       CLK(4);
-      break;
-    case 0xa6:  // M
+      NEXT_OP;
+    OPCODE(0xa6):  // M
       ANDA(GetM());
       CLK(7);
-      break;
-    case 0xa7:  // A
+      NEXT_OP;
+    OPCODE(0xa7):  // A
       ANDA(RegA());
       CLK(4);
-      break;
-    case 0xe6:  // n
+      NEXT_OP;
+    OPCODE(0xe6):  // n
       ANDA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // XOR -
-    case 0xa8:  // B
+    OPCODE(0xa8):  // B
       XORA(RegB());
       CLK(4);
-      break;
-    case 0xa9:  // C
+      NEXT_OP;
+    OPCODE(0xa9):  // C
       XORA(RegC());
       CLK(4);
-      break;
-    case 0xaa:  // D
+      NEXT_OP;
+    OPCODE(0xaa):  // D
       XORA(RegD());
       CLK(4);
-      break;
-    case 0xab:  // E
+      NEXT_OP;
+    OPCODE(0xab):  // E
       XORA(RegE());
       CLK(4);
-      break;
-    case 0xac:  // H
+      NEXT_OP;
+    OPCODE(0xac):  // H
       XORA(RegXH());
       CLK(4);
-      break;
-    case 0xad:  // L
+      NEXT_OP;
+    OPCODE(0xad):  // L
       XORA(RegXL());
       CLK(4);
-      break;
-    case 0xae:  // M
+      NEXT_OP;
+    OPCODE(0xae):  // M
       XORA(GetM());
       CLK(7);
-      break;
-    case 0xaf:  // A
+      NEXT_OP;
+    OPCODE(0xaf):  // A
       XORA(RegA());
       CLK(4);
-      break;
-    case 0xee:  // n
+      NEXT_OP;
+    OPCODE(0xee):  // n
       XORA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // OR -
-    case 0xb0:  // B
+    OPCODE(0xb0):  // B
       ORA(RegB());
       CLK(4);
-      break;
-    case 0xb1:  // C
+      NEXT_OP;
+    OPCODE(0xb1):  // C
       ORA(RegC());
       CLK(4);
-      break;
-    case 0xb2:  // D
+      NEXT_OP;
+    OPCODE(0xb2):  // D
       ORA(RegD());
       CLK(4);
-      break;
-    case 0xb3:  // E
+      NEXT_OP;
+    OPCODE(0xb3):  // E
       ORA(RegE());
       CLK(4);
-      break;
-    case 0xb4:  // H
+      NEXT_OP;
+    OPCODE(0xb4):  // H
       ORA(RegXH());
       CLK(4);
-      break;
-    case 0xb5:  // L
+      NEXT_OP;
+    OPCODE(0xb5):  // L
       ORA(RegXL());
       CLK(4);
-      break;
-    case 0xb6:  // M
+      NEXT_OP;
+    OPCODE(0xb6):  // M
       ORA(GetM());
       CLK(7);
-      break;
-    case 0xb7:  // A
+      NEXT_OP;
+    OPCODE(0xb7):  // A
       ORA(RegA());
       CLK(4);
-      break;
-    case 0xf6:  // n
+      NEXT_OP;
+    OPCODE(0xf6):  // n
       ORA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // CP -
-    case 0xb8:  // B
+    OPCODE(0xb8):  // B
       CPA(RegB());
       CLK(4);
-      break;
-    case 0xb9:  // C
+      NEXT_OP;
+    OPCODE(0xb9):  // C
       CPA(RegC());
       CLK(4);
-      break;
-    case 0xba:  // D
+      NEXT_OP;
+    OPCODE(0xba):  // D
       CPA(RegD());
       CLK(4);
-      break;
-    case 0xbb:  // E
+      NEXT_OP;
+    OPCODE(0xbb):  // E
       CPA(RegE());
       CLK(4);
-      break;
-    case 0xbc:  // H
+      NEXT_OP;
+    OPCODE(0xbc):  // H
       CPA(RegXH());
       CLK(4);
-      break;
-    case 0xbd:  // L
+      NEXT_OP;
+    OPCODE(0xbd):  // L
       CPA(RegXL());
       CLK(4);
-      break;
-    case 0xbe:  // M
+      NEXT_OP;
+    OPCODE(0xbe):  // M
       CPA(GetM());
       CLK(7);
-      break;
-    case 0xbf:  // A
+      NEXT_OP;
+    OPCODE(0xbf):  // A
       CPA(RegA());
       CLK(4);
-      break;
-    case 0xfe:  // n
+      NEXT_OP;
+    OPCODE(0xfe):  // n
       CPA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // INC r
-    case 0x04:  // B
+    OPCODE(0x04):  // B
       SetRegB((Inc8(RegB())));
       CLK(4);
-      break;
-    case 0x0c:  // C
+      NEXT_OP;
+    OPCODE(0x0c):  // C
       SetRegC((Inc8(RegC())));
       CLK(4);
-      break;
-    case 0x14:  // D
+      NEXT_OP;
+    OPCODE(0x14):  // D
       SetRegD((Inc8(RegD())));
       CLK(4);
-      break;
-    case 0x1c:  // E
+      NEXT_OP;
+    OPCODE(0x1c):  // E
       SetRegE((Inc8(RegE())));
       CLK(4);
-      break;
-    case 0x24:  // H
+      NEXT_OP;
+    OPCODE(0x24):  // H
       SetRegXH(Inc8(RegXH()));
       CLK(4);
-      break;
-    case 0x2c:  // L
+      NEXT_OP;
+    OPCODE(0x2c):  // L
       SetRegXL(Inc8(RegXL()));
       CLK(4);
-      break;
-    case 0x3c:  // A
+      NEXT_OP;
+    OPCODE(0x3c):  // A
       SetRegA((Inc8(RegA())));
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0x34:  // M
+    OPCODE(0x34):  // M
       w = RegXHL();
       if (index_mode_ != USEHL) {
         w += int8_t(Fetch8());
@@ -1463,39 +1596,39 @@ void Z80C::SingleStep(uint32_t m) {
       }
       Write8(w, Inc8(Read8(w)));
       CLK(11);
-      break;
+      NEXT_OP;
 
     // DEC r
-    case 0x05:  // B
+    OPCODE(0x05):  // B
       SetRegB(Dec8(RegB()));
       CLK(4);
-      break;
-    case 0x0d:  // C
+      NEXT_OP;
+    OPCODE(0x0d):  // C
       SetRegC(Dec8(RegC()));
       CLK(4);
-      break;
-    case 0x15:  // D
+      NEXT_OP;
+    OPCODE(0x15):  // D
       SetRegD(Dec8(RegD()));
       CLK(4);
-      break;
-    case 0x1d:  // E
+      NEXT_OP;
+    OPCODE(0x1d):  // E
       SetRegE(Dec8(RegE()));
       CLK(4);
-      break;
-    case 0x25:  // H
+      NEXT_OP;
+    OPCODE(0x25):  // H
       SetRegXH(Dec8(RegXH()));
       CLK(4);
-      break;
-    case 0x2d:  // L
+      NEXT_OP;
+    OPCODE(0x2d):  // L
       SetRegXL(Dec8(RegXL()));
       CLK(4);
-      break;
-    case 0x3d:  // A
+      NEXT_OP;
+    OPCODE(0x3d):  // A
       SetRegA(Dec8(RegA()));
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0x35:  // M
+    OPCODE(0x35):  // M
       w = RegXHL();
       if (index_mode_ != USEHL) {
         w += (int8_t)(Fetch8());
@@ -1503,342 +1636,342 @@ void Z80C::SingleStep(uint32_t m) {
       }
       Write8(w, Dec8(Read8(w)));
       CLK(11);
-      break;
+      NEXT_OP;
 
       // stack op.
 
     // PUSH
-    case 0xc5:  // BC
+    OPCODE(0xc5):  // BC
       Push(RegBC());
       CLK(11);
-      break;
-    case 0xd5:  // DE
+      NEXT_OP;
+    OPCODE(0xd5):  // DE
       Push(RegDE());
       CLK(11);
-      break;
-    case 0xe5:  // xHL
+      NEXT_OP;
+    OPCODE(0xe5):  // xHL
       Push(RegXHL());
       CLK(11);
-      break;
+      NEXT_OP;
 #ifndef NO_UNOFFICIALFLAGS
-    case 0xf5:  // AF
+    OPCODE(0xf5):  // AF
       Push(GetAF());
       CLK(11);
-      break;
+      NEXT_OP;
 #else
-    case 0xf5:  // AF
+    OPCODE(0xf5):  // AF
       Push(GetAF() & 0xffd7);
       CLK(11);
-      break;
+      NEXT_OP;
 #endif
 
     // POP
-    case 0xc1:  // BC
+    OPCODE(0xc1):  // BC
       SetRegBC(Pop());
       CLK(10);
-      break;
-    case 0xd1:  // DE
+      NEXT_OP;
+    OPCODE(0xd1):  // DE
       SetRegDE(Pop());
       CLK(10);
-      break;
-    case 0xe1:  // xHL
+      NEXT_OP;
+    OPCODE(0xe1):  // xHL
       SetRegXHL(Pop());
       CLK(10);
-      break;
-    case 0xf1:  // AF
+      NEXT_OP;
+    OPCODE(0xf1):  // AF
       SetAF(Pop());
       CLK(10);
-      break;
+      NEXT_OP;
 
       // 16 bit load
 
     // LD dd,nn
-    case 0x01:  // BC
+    OPCODE(0x01):  // BC
       SetRegBC(Fetch16());
       CLK(10);
-      break;
-    case 0x11:  // DE
+      NEXT_OP;
+    OPCODE(0x11):  // DE
       SetRegDE(Fetch16());
       CLK(10);
-      break;
-    case 0x21:  // xHL
+      NEXT_OP;
+    OPCODE(0x21):  // xHL
       SetRegXHL(Fetch16());
       CLK(10);
-      break;
-    case 0x31:  // SP
+      NEXT_OP;
+    OPCODE(0x31):  // SP
       SetRegSP(Fetch16());
       CLK(10);
-      break;
+      NEXT_OP;
 
-    case 0x22:  // LD (nn),xHL
+    OPCODE(0x22):  // LD (nn),xHL
       Write16(Fetch16(), RegXHL());
       CLK(22);
-      break;
+      NEXT_OP;
 
-    case 0x2a:  // LD xHL,(nn)
+    OPCODE(0x2a):  // LD xHL,(nn)
       SetRegXHL(Read16(Fetch16()));
       CLK(22);
-      break;
+      NEXT_OP;
 
-    case 0xf9:  // LD SP,HL
+    OPCODE(0xf9):  // LD SP,HL
       SetRegSP(RegXHL());
       CLK(6);
-      break;
+      NEXT_OP;
 
       // 8 bit LDs
 
     // LD B,-
-    case 0x40:  // B
+    OPCODE(0x40):  // B
       CLK(4);
-      break;
-    case 0x41:  // C
+      NEXT_OP;
+    OPCODE(0x41):  // C
       SetRegB(RegC());
       CLK(4);
-      break;
-    case 0x42:  // D
+      NEXT_OP;
+    OPCODE(0x42):  // D
       SetRegB(RegD());
       CLK(4);
-      break;
-    case 0x43:  // E
+      NEXT_OP;
+    OPCODE(0x43):  // E
       SetRegB(RegE());
       CLK(4);
-      break;
-    case 0x44:  // H
+      NEXT_OP;
+    OPCODE(0x44):  // H
       SetRegB(RegXH());
       CLK(4);
-      break;
-    case 0x45:  // L
+      NEXT_OP;
+    OPCODE(0x45):  // L
       SetRegB(RegXL());
       CLK(4);
-      break;
-    case 0x46:  // M
+      NEXT_OP;
+    OPCODE(0x46):  // M
       SetRegB(GetM());
       CLK(7);
-      break;
-    case 0x47:  // A
+      NEXT_OP;
+    OPCODE(0x47):  // A
       SetRegB(RegA());
       CLK(4);
-      break;
-    case 0x06:  // n
+      NEXT_OP;
+    OPCODE(0x06):  // n
       SetRegB(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // LD C,-
-    case 0x48:  // B
+    OPCODE(0x48):  // B
       SetRegC(RegB());
       CLK(4);
-      break;
-    case 0x49:  // C
+      NEXT_OP;
+    OPCODE(0x49):  // C
       CLK(4);
-      break;
-    case 0x4a:  // D
+      NEXT_OP;
+    OPCODE(0x4a):  // D
       SetRegC(RegD());
       CLK(4);
-      break;
-    case 0x4b:  // E
+      NEXT_OP;
+    OPCODE(0x4b):  // E
       SetRegC(RegE());
       CLK(4);
-      break;
-    case 0x4c:  // H
+      NEXT_OP;
+    OPCODE(0x4c):  // H
       SetRegC(RegXH());
       CLK(4);
-      break;
-    case 0x4d:  // L
+      NEXT_OP;
+    OPCODE(0x4d):  // L
       SetRegC(RegXL());
       CLK(4);
-      break;
-    case 0x4e:  // M
+      NEXT_OP;
+    OPCODE(0x4e):  // M
       SetRegC(GetM());
       CLK(7);
-      break;
-    case 0x4f:  // A
+      NEXT_OP;
+    OPCODE(0x4f):  // A
       SetRegC(RegA());
       CLK(4);
-      break;
-    case 0x0e:  // n
+      NEXT_OP;
+    OPCODE(0x0e):  // n
       SetRegC(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // LD D,-
-    case 0x50:  // B
+    OPCODE(0x50):  // B
       SetRegD(RegB());
       CLK(4);
-      break;
-    case 0x51:  // C
+      NEXT_OP;
+    OPCODE(0x51):  // C
       SetRegD(RegC());
       CLK(4);
-      break;
-    case 0x52:  // D
+      NEXT_OP;
+    OPCODE(0x52):  // D
       CLK(4);
-      break;
-    case 0x53:  // E
+      NEXT_OP;
+    OPCODE(0x53):  // E
       SetRegD(RegE());
       CLK(4);
-      break;
-    case 0x54:  // H
+      NEXT_OP;
+    OPCODE(0x54):  // H
       SetRegD(RegXH());
       CLK(4);
-      break;
-    case 0x55:  // L
+      NEXT_OP;
+    OPCODE(0x55):  // L
       SetRegD(RegXL());
       CLK(4);
-      break;
-    case 0x56:  // M
+      NEXT_OP;
+    OPCODE(0x56):  // M
       SetRegD(GetM());
       CLK(7);
-      break;
-    case 0x57:  // A
+      NEXT_OP;
+    OPCODE(0x57):  // A
       SetRegD(RegA());
       CLK(4);
-      break;
-    case 0x16:  // n
+      NEXT_OP;
+    OPCODE(0x16):  // n
       SetRegD(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // LD E,-
-    case 0x58:  // B
+    OPCODE(0x58):  // B
       SetRegE(RegB());
       CLK(4);
-      break;
-    case 0x59:  // C
+      NEXT_OP;
+    OPCODE(0x59):  // C
       SetRegE(RegC());
       CLK(4);
-      break;
-    case 0x5a:  // D
+      NEXT_OP;
+    OPCODE(0x5a):  // D
       SetRegE(RegD());
       CLK(4);
-      break;
-    case 0x5b:  // E
+      NEXT_OP;
+    OPCODE(0x5b):  // E
       CLK(4);
-      break;
-    case 0x5c:  // H
+      NEXT_OP;
+    OPCODE(0x5c):  // H
       SetRegE(RegXH());
       CLK(4);
-      break;
-    case 0x5d:  // L
+      NEXT_OP;
+    OPCODE(0x5d):  // L
       SetRegE(RegXL());
       CLK(4);
-      break;
-    case 0x5e:  // M
+      NEXT_OP;
+    OPCODE(0x5e):  // M
       SetRegE(GetM());
       CLK(7);
-      break;
-    case 0x5f:  // A
+      NEXT_OP;
+    OPCODE(0x5f):  // A
       SetRegE(RegA());
       CLK(4);
-      break;
-    case 0x1e:  // n
+      NEXT_OP;
+    OPCODE(0x1e):  // n
       SetRegE(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // LD H,-
-    case 0x60:  // B
+    OPCODE(0x60):  // B
       SetRegXH(RegB());
       CLK(4);
-      break;
-    case 0x61:  // C
+      NEXT_OP;
+    OPCODE(0x61):  // C
       SetRegXH(RegC());
       CLK(4);
-      break;
-    case 0x62:  // D
+      NEXT_OP;
+    OPCODE(0x62):  // D
       SetRegXH(RegD());
       CLK(4);
-      break;
-    case 0x63:  // E
+      NEXT_OP;
+    OPCODE(0x63):  // E
       SetRegXH(RegE());
       CLK(4);
-      break;
-    case 0x64:  // H
+      NEXT_OP;
+    OPCODE(0x64):  // H
       CLK(4);
-      break;
-    case 0x65:  // L
+      NEXT_OP;
+    OPCODE(0x65):  // L
       SetRegXH(RegXL());
       CLK(4);
-      break;
-    case 0x66:  // M
+      NEXT_OP;
+    OPCODE(0x66):  // M
       SetRegH(GetM());
       CLK(7);
-      break;
-    case 0x67:  // A
+      NEXT_OP;
+    OPCODE(0x67):  // A
       SetRegXH(RegA());
       CLK(4);
-      break;
-    case 0x26:  // n
+      NEXT_OP;
+    OPCODE(0x26):  // n
       SetRegXH(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // LD L,-
-    case 0x68:  // B
+    OPCODE(0x68):  // B
       SetRegXL(RegB());
       CLK(4);
-      break;
-    case 0x69:  // C
+      NEXT_OP;
+    OPCODE(0x69):  // C
       SetRegXL(RegC());
       CLK(4);
-      break;
-    case 0x6a:  // D
+      NEXT_OP;
+    OPCODE(0x6a):  // D
       SetRegXL(RegD());
       CLK(4);
-      break;
-    case 0x6b:  // E
+      NEXT_OP;
+    OPCODE(0x6b):  // E
       SetRegXL(RegE());
       CLK(4);
-      break;
-    case 0x6c:  // H
+      NEXT_OP;
+    OPCODE(0x6c):  // H
       SetRegXL(RegXH());
       CLK(4);
-      break;
-    case 0x6d:  // L
+      NEXT_OP;
+    OPCODE(0x6d):  // L
       CLK(4);
-      break;
-    case 0x6e:  // M
+      NEXT_OP;
+    OPCODE(0x6e):  // M
       SetRegL(GetM());
       CLK(7);
-      break;
-    case 0x6f:  // A
+      NEXT_OP;
+    OPCODE(0x6f):  // A
       SetRegXL(RegA());
       CLK(4);
-      break;
-    case 0x2e:  // n
+      NEXT_OP;
+    OPCODE(0x2e):  // n
       SetRegXL(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // LD M,-
-    case 0x70:  // B
+    OPCODE(0x70):  // B
       SetM(RegB());
       CLK(7);
-      break;
-    case 0x71:  // C
+      NEXT_OP;
+    OPCODE(0x71):  // C
       SetM(RegC());
       CLK(7);
-      break;
-    case 0x72:  // D
+      NEXT_OP;
+    OPCODE(0x72):  // D
       SetM(RegD());
       CLK(7);
-      break;
-    case 0x73:  // E
+      NEXT_OP;
+    OPCODE(0x73):  // E
       SetM(RegE());
       CLK(7);
-      break;
-    case 0x74:  // H
+      NEXT_OP;
+    OPCODE(0x74):  // H
       SetM(RegH());
       CLK(7);
-      break;
-    case 0x75:  // L
+      NEXT_OP;
+    OPCODE(0x75):  // L
       SetM(RegL());
       CLK(7);
-      break;
-    case 0x77:  // A
+      NEXT_OP;
+    OPCODE(0x77):  // A
       SetM(RegA());
       CLK(7);
-      break;
-    case 0x36:  // n
+      NEXT_OP;
+    OPCODE(0x36):  // n
       w = RegXHL();
       if (index_mode_ != USEHL) {
         w += int8_t(Fetch8());
@@ -1846,75 +1979,75 @@ void Z80C::SingleStep(uint32_t m) {
       }
       Write8(w, Fetch8());
       CLK(11);
-      break;
+      NEXT_OP;
 
     // LD A,-
-    case 0x78:  // B
+    OPCODE(0x78):  // B
       SetRegA(RegB());
       CLK(4);
-      break;
-    case 0x79:  // C
+      NEXT_OP;
+    OPCODE(0x79):  // C
       SetRegA(RegC());
       CLK(4);
-      break;
-    case 0x7a:  // D
+      NEXT_OP;
+    OPCODE(0x7a):  // D
       SetRegA(RegD());
       CLK(4);
-      break;
-    case 0x7b:  // E
+      NEXT_OP;
+    OPCODE(0x7b):  // E
       SetRegA(RegE());
       CLK(4);
-      break;
-    case 0x7c:  // H
+      NEXT_OP;
+    OPCODE(0x7c):  // H
       SetRegA(RegXH());
       CLK(4);
-      break;
-    case 0x7d:  // L
+      NEXT_OP;
+    OPCODE(0x7d):  // L
       SetRegA(RegXL());
       CLK(4);
-      break;
-    case 0x7e:  // M
+      NEXT_OP;
+    OPCODE(0x7e):  // M
       SetRegA(GetM());
       CLK(7);
-      break;
-    case 0x7f:  // A
+      NEXT_OP;
+    OPCODE(0x7f):  // A
       CLK(4);
-      break;
-    case 0x3e:  // n
+      NEXT_OP;
+    OPCODE(0x3e):  // n
       SetRegA(Fetch8());
       CLK(7);
-      break;
+      NEXT_OP;
 
     // LD (--), A
-    case 0x02:  // BC
+    OPCODE(0x02):  // BC
       Write8(RegBC(), RegA());
       CLK(7);
-      break;
-    case 0x12:  // DE
+      NEXT_OP;
+    OPCODE(0x12):  // DE
       Write8(RegDE(), RegA());
       CLK(7);
-      break;
-    case 0x32:  // nn
+      NEXT_OP;
+    OPCODE(0x32):  // nn
       Write8(Fetch16(), RegA());
       CLK(13);
-      break;
+      NEXT_OP;
 
     // LD A, (--)
-    case 0x0a:  // BC
+    OPCODE(0x0a):  // BC
       SetRegA(Read8(RegBC()));
       CLK(7);
-      break;
-    case 0x1a:  // DE
+      NEXT_OP;
+    OPCODE(0x1a):  // DE
       SetRegA(Read8(RegDE()));
       CLK(7);
-      break;
-    case 0x3a:  // nn
+      NEXT_OP;
+    OPCODE(0x3a):  // nn
       SetRegA(Read8(Fetch16()));
       CLK(13);
-      break;
+      NEXT_OP;
 
       // DD / FD
-    case 0xdd:
+    OPCODE(0xdd):
       w = Fetch8();
       if ((w & 0xdf) != 0xdd)  // not DD nor FD
       {
@@ -1922,41 +2055,45 @@ void Z80C::SingleStep(uint32_t m) {
         SingleStep(w);
         index_mode_ = USEHL;
         CLK(4);
-        break;
+        NEXT_OP;
       }
       PCDec(1);
       CLK(4);
-      break;
+      NEXT_OP;
 
-    case 0xfd:
+    OPCODE(0xfd):
       w = Fetch8();
       if ((w & 0xdf) != 0xdd) {
         index_mode_ = USEIY;
         SingleStep(w);
         index_mode_ = USEHL;
         CLK(4);
-        break;
+        NEXT_OP;
       }
       PCDec(1);
       CLK(4);
-      break;
+      NEXT_OP;
 
       // CB
-    case 0xcb:
-      if (index_mode_ == USEHL)
+    OPCODE(0xcb):
+      if (index_mode_ == USEHL) {
         reg_.rreg++;
+        FetchWait();
+      }
       CodeCB();
-      break;
+      NEXT_OP;
 
       // ED
-    case 0xed:
+    OPCODE(0xed):
       w = Fetch8();
       reg_.rreg++;
+      FetchWait();
+      DISPATCH(ed_ops, w);
       switch (w) {
           // 入出力 ED 系
 
         // IN r,(c)
-        case 0x40:
+        OPCODE_ED(0x40):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -1970,7 +2107,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(12);
           break;
 
-        case 0x48:
+        OPCODE_ED(0x48):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -1984,7 +2121,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(12);
           break;
 
-        case 0x50:
+        OPCODE_ED(0x50):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -1998,7 +2135,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(12);
           break;
 
-        case 0x58:
+        OPCODE_ED(0x58):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2012,7 +2149,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(12);
           break;
 
-        case 0x60:
+        OPCODE_ED(0x60):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2026,7 +2163,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(12);
           break;
 
-        case 0x68:
+        OPCODE_ED(0x68):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2040,7 +2177,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(12);
           break;
 
-        case 0x70:
+        OPCODE_ED(0x70):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2050,7 +2187,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(12);
           break;
 
-        case 0x78:
+        OPCODE_ED(0x78):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2065,7 +2202,7 @@ void Z80C::SingleStep(uint32_t m) {
           break;
 
         // OUT (C),r
-        case 0x41:
+        OPCODE_ED(0x41):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2076,7 +2213,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0x49:
+        OPCODE_ED(0x49):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2087,7 +2224,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0x51:
+        OPCODE_ED(0x51):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2098,7 +2235,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0x59:
+        OPCODE_ED(0x59):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2109,7 +2246,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0x61:
+        OPCODE_ED(0x61):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2120,7 +2257,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0x69:
+        OPCODE_ED(0x69):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2131,7 +2268,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0x71:
+        OPCODE_ED(0x71):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2142,7 +2279,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0x79:
+        OPCODE_ED(0x79):
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2153,7 +2290,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0xa2:  // INI
+        OPCODE_ED(0xa2):  // INI
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2165,7 +2302,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(16);
           break;
 
-        case 0xaa:  // IND
+        OPCODE_ED(0xaa):  // IND
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2177,7 +2314,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(16);
           break;
 
-        case 0xa3:  // OUTI
+        OPCODE_ED(0xa3):  // OUTI
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2191,7 +2328,7 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0xab:  // OUTD
+        OPCODE_ED(0xab):  // OUTD
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
@@ -2205,69 +2342,77 @@ void Z80C::SingleStep(uint32_t m) {
           OutTestIntr();
           break;
 
-        case 0xb2:  // INIR
+        OPCODE_ED(0xb2):  // INIR
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
           }
-          Write8(RegHL(), Inp(RegBC()));
-          SetRegHL(RegHL() + 1);
-          SetRegB(RegB() - 1);
-          SetFlags(ZF | NF, RegB() ? NF : NF | ZF);
-          CLK(16);
-          if (RegB())
-            PCDec(2);
+          do {
+            Write8(RegHL(), Inp(RegBC()));
+            SetRegHL(RegHL() + 1);
+            SetRegB(RegB() - 1);
+            SetFlags(ZF | NF, RegB() ? NF : NF | ZF);
+            CLK(16);
+            if (RegB())
+              PCDec(2);
+          } while (RepeatIO(0xb2));
           break;
 
-        case 0xba:  // INDR
+        OPCODE_ED(0xba):  // INDR
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
           }
-          Write8(RegHL(), Inp(RegBC()));
-          SetRegHL(RegHL() - 1);
-          SetRegB(RegB() - 1);
-          SetFlags(ZF | NF, RegB() ? NF : NF | ZF);
-          CLK(16);
-          if (RegB())
-            PCDec(2);
+          do {
+            Write8(RegHL(), Inp(RegBC()));
+            SetRegHL(RegHL() - 1);
+            SetRegB(RegB() - 1);
+            SetFlags(ZF | NF, RegB() ? NF : NF | ZF);
+            CLK(16);
+            if (RegB())
+              PCDec(2);
+          } while (RepeatIO(0xba));
           break;
 
-        case 0xb3:  // OTIR
+        OPCODE_ED(0xb3):  // OTIR
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
           }
-          Outp(RegBC(), Read8(RegHL()));
-          SetPC(GetPC());
-          SetRegHL(RegHL() + 1);
-          SetRegB(RegB() - 1);
-          SetFlags(ZF | NF, RegB() ? NF : NF | ZF);
-          CLK(16);
-          if (RegB())
-            PCDec(2);
-          OutTestIntr();
+          do {
+            Outp(RegBC(), Read8(RegHL()));
+            SetPC(GetPC());
+            SetRegHL(RegHL() + 1);
+            SetRegB(RegB() - 1);
+            SetFlags(ZF | NF, RegB() ? NF : NF | ZF);
+            CLK(16);
+            if (RegB())
+              PCDec(2);
+            OutTestIntr();
+          } while (RepeatIO(0xb3));
           break;
 
-        case 0xbb:  // OTDR
+        OPCODE_ED(0xbb):  // OTDR
           if (IsSyncPort(RegBC() & 0xff) && !Sync()) {
             PCDec(2);
             break;
           }
-          Outp(RegBC(), Read8(RegHL()));
-          SetPC(GetPC());
-          SetRegHL(RegHL() - 1);
-          SetRegB(RegB() - 1);
-          SetFlags(ZF | NF, RegB() ? NF : NF | ZF);
-          CLK(16);
-          if (RegB())
-            PCDec(2);
-          OutTestIntr();
+          do {
+            Outp(RegBC(), Read8(RegHL()));
+            SetPC(GetPC());
+            SetRegHL(RegHL() - 1);
+            SetRegB(RegB() - 1);
+            SetFlags(ZF | NF, RegB() ? NF : NF | ZF);
+            CLK(16);
+            if (RegB())
+              PCDec(2);
+            OutTestIntr();
+          } while (RepeatIO(0xbb));
           break;
 
           // ブロック転送系
 
-        case 0xa0:  // LDI
+        OPCODE_ED(0xa0):  // LDI
           Write8(RegDE(), Read8(RegHL()));
           SetRegDE(RegDE() + 1);
           SetRegHL(RegHL() + 1);
@@ -2276,7 +2421,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(16);
           break;
 
-        case 0xa8:  // LDD
+        OPCODE_ED(0xa8):  // LDD
           Write8(RegDE(), Read8(RegHL()));
           SetRegDE(RegDE() - 1);
           SetRegHL(RegHL() - 1);
@@ -2285,7 +2430,8 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(16);
           break;
 
-        case 0xb0:  // LDIR
+        OPCODE_ED(0xb0):  // LDIR
+          BlockCopy(1);
           Write8(RegDE(), Read8(RegHL()));
           SetRegDE(RegDE() + 1);
           SetRegHL(RegHL() + 1);
@@ -2299,7 +2445,8 @@ void Z80C::SingleStep(uint32_t m) {
           }
           break;
 
-        case 0xb8:  // LDDR
+        OPCODE_ED(0xb8):  // LDDR
+          BlockCopy(-1);
           Write8(RegDE(), Read8(RegHL()));
           SetRegDE(RegDE() - 1);
           SetRegHL(RegHL() - 1);
@@ -2315,21 +2462,23 @@ void Z80C::SingleStep(uint32_t m) {
 
           // ブロックサーチ系
 
-        case 0xa1:  // CPI
+        OPCODE_ED(0xa1):  // CPI
           CPI();
           break;
 
-        case 0xa9:  // CPD
+        OPCODE_ED(0xa9):  // CPD
           CPD();
           break;
 
-        case 0xb1:  // CPIR
+        OPCODE_ED(0xb1):  // CPIR
+          BlockSearch(1);
           CPI();
           if (!GetZF() && RegBC())
             PCDec(2);
           break;
 
-        case 0xb9:  // CPDR
+        OPCODE_ED(0xb9):  // CPDR
+          BlockSearch(-1);
           CPD();
           if (!GetZF() && RegBC())
             PCDec(2);
@@ -2337,71 +2486,71 @@ void Z80C::SingleStep(uint32_t m) {
 
           // misc
 
-        case 0x44:
-        case 0x4c:
-        case 0x54:
-        case 0x5c:  // NEG
-        case 0x64:
-        case 0x6c:
-        case 0x74:
-        case 0x7c:  // NEG
+        OPCODE_ED(0x44):
+        OPCODE_ED(0x4c):
+        OPCODE_ED(0x54):
+        OPCODE_ED(0x5c):  // NEG
+        OPCODE_ED(0x64):
+        OPCODE_ED(0x6c):
+        OPCODE_ED(0x74):
+        OPCODE_ED(0x7c):  // NEG
           b = RegA();
           SetRegA(0);
           SUBA(b);
           CLK(8);
           break;
 
-        case 0x46:
-        case 0x4e:
-        case 0x66:
-        case 0x6e:  // IM 0
+        OPCODE_ED(0x46):
+        OPCODE_ED(0x4e):
+        OPCODE_ED(0x66):
+        OPCODE_ED(0x6e):  // IM 0
           reg_.intmode = 0;
           CLK(8);
           break;
 
-        case 0x56:
-        case 0x76:  // IM 1
+        OPCODE_ED(0x56):
+        OPCODE_ED(0x76):  // IM 1
           reg_.intmode = 1;
           CLK(8);
           break;
-        case 0x5e:
-        case 0x7e:  // IM 2
+        OPCODE_ED(0x5e):
+        OPCODE_ED(0x7e):  // IM 2
           reg_.intmode = 2;
           CLK(8);
           break;
 
-        case 0x57:  // LD A,I
+        OPCODE_ED(0x57):  // LD A,I
           SetRegA((reg_.ireg));
           SetZS(reg_.ireg);
           SetFlags(NF | HF | PF, reg_.iff1 ? PF : 0);
           CLK(9);
           break;
 
-        case 0x5F:  // LD A,R
+        OPCODE_ED(0x5f):  // LD A,R
           SetRegA((reg_.rreg & 0x7f) + (reg_.rreg7 & 0x80));
           SetZS(RegA());
           SetFlags(NF | HF | PF, (reg_.iff1 ? PF : 0));
           CLK(9);
           break;
 
-        case 0x47:  // LD I,A
+        OPCODE_ED(0x47):  // LD I,A
           reg_.ireg = RegA();
           CLK(9);
           break;
 
-        case 0x4f:  // LD R,A
+        OPCODE_ED(0x4f):  // LD R,A
           reg_.rreg7 = reg_.rreg = RegA();
           CLK(9);
           break;
 
-        case 0x45:  // RETN
-        case 0x4d:  // RETI
-        case 0x55:
-        case 0x5d:
-        case 0x65:
-        case 0x6d:
-        case 0x75:
-        case 0x7d:
+        OPCODE_ED(0x45):  // RETN
+        OPCODE_ED(0x4d):  // RETI
+        OPCODE_ED(0x55):
+        OPCODE_ED(0x5d):
+        OPCODE_ED(0x65):
+        OPCODE_ED(0x6d):
+        OPCODE_ED(0x75):
+        OPCODE_ED(0x7d):
           reg_.iff1 = reg_.iff2;
           Ret();
           CLK(14);
@@ -2409,7 +2558,7 @@ void Z80C::SingleStep(uint32_t m) {
 
           // 桁移動命令
 
-        case 0x6f:  // RLD
+        OPCODE_ED(0x6f):  // RLD
         {
           uint8_t d, e;
 
@@ -2424,7 +2573,7 @@ void Z80C::SingleStep(uint32_t m) {
           CLK(18);
         } break;
 
-        case 0x67:  // RRD
+        OPCODE_ED(0x67):  // RRD
         {
           uint8_t d, e;
 
@@ -2442,37 +2591,37 @@ void Z80C::SingleStep(uint32_t m) {
           // ED系 16 ビットロード
 
         // LD (nn),dd
-        case 0x43:  // BC
+        OPCODE_ED(0x43):  // BC
           Write16(Fetch16(), RegBC());
           CLK(20);
           break;
-        case 0x53:  // DE
+        OPCODE_ED(0x53):  // DE
           Write16(Fetch16(), RegDE());
           CLK(20);
           break;
-        case 0x63:  // HL
+        OPCODE_ED(0x63):  // HL
           Write16(Fetch16(), RegHL());
           CLK(20);
           break;
-        case 0x73:  // SP
+        OPCODE_ED(0x73):  // SP
           Write16(Fetch16(), RegSP());
           CLK(20);
           break;
 
         // LD dd,(nn)
-        case 0x4b:  // BC
+        OPCODE_ED(0x4b):  // BC
           SetRegBC(Read16(Fetch16()));
           CLK(20);
           break;
-        case 0x5b:  // DE
+        OPCODE_ED(0x5b):  // DE
           SetRegDE(Read16(Fetch16()));
           CLK(20);
           break;
-        case 0x6b:  // HL
+        OPCODE_ED(0x6b):  // HL
           SetRegHL(Read16(Fetch16()));
           CLK(20);
           break;
-        case 0x7b:  // SP
+        OPCODE_ED(0x7b):  // SP
           SetRegSP(Read16(Fetch16()));
           CLK(20);
           break;
@@ -2480,50 +2629,50 @@ void Z80C::SingleStep(uint32_t m) {
           // ED系 16 ビット演算
 
         // ADC HL,dd
-        case 0x4a:  // BC
+        OPCODE_ED(0x4a):  // BC
           ADCHL(RegBC());
           CLK(15);
           break;
-        case 0x5a:  // DE
+        OPCODE_ED(0x5a):  // DE
           ADCHL(RegDE());
           CLK(15);
           break;
-        case 0x6a:  // HL
+        OPCODE_ED(0x6a):  // HL
           ADCHL(RegHL());
           CLK(15);
           break;
-        case 0x7a:  // SP
+        OPCODE_ED(0x7a):  // SP
           ADCHL(RegSP());
           CLK(15);
           break;
 
         // SBC HL,dd
-        case 0x42:  // BC
+        OPCODE_ED(0x42):  // BC
           SBCHL(RegBC());
           CLK(15);
           break;
-        case 0x52:  // DE
+        OPCODE_ED(0x52):  // DE
           SBCHL(RegDE());
           CLK(15);
           break;
-        case 0x62:  // HL
+        OPCODE_ED(0x62):  // HL
           SBCHL(RegHL());
           CLK(15);
           break;
-        case 0x72:  // SP
+        OPCODE_ED(0x72):  // SP
           SBCHL(RegSP());
           CLK(15);
           break;
-        default:
+        OPCODE_ED_DEFAULT:
           // notreached
           assert(false);
           break;
       }
-      break;  // 0xed
+      NEXT_OP;  // 0xed
     default:
       // notreached
       assert(false);
-      break;
+      NEXT_OP;
   }
 }
 
@@ -2608,6 +2757,63 @@ void Z80C::CPD() {
   CLK(16);
 }
 
+// ---------------------------------------------------------------------------
+// ブロック命令の繰り返し
+// Run の中ではブロック命令の繰り返しの間に割り込みを受け付けないので，
+// 残りクロックで続けて実行されるはずの繰り返しは命令を読み直さずに実行できる．
+// ダンプ中，割り込みを受け付ける可能性がある場合 (OutTestIntr)，
+// DD/FD が前置されている場合は 1 回ずつ実行する
+//
+inline bool Z80C::CanRepeat() {
+  return clock_count_ < 0 && !dump_log_ && !(reg_.iff1 && intr_) && index_mode_ == USEHL;
+}
+
+// 今回の実行の前にまとめて実行できる繰り返しの回数 (count 回まで)
+// clocks は繰り返し 1 回のクロック数
+uint32_t Z80C::BlockRepeats(uint32_t count, int clocks) {
+  if (!CanRepeat())
+    return 0;
+  return static_cast<uint32_t>(std::min<int64_t>(count, (-clock_count_ - 1) / clocks));
+}
+
+// LDIR/LDDR: 最後の 1 回 (BC が 0 になる回か，クロックが尽きる回) の手前までを転送する
+void Z80C::BlockCopy(int dir) {
+  uint32_t n = BlockRepeats((RegBC() - 1) & 0xffff, 21);
+  if (!n)
+    return;
+  // 命令自身を書き換える場合はその手前まで
+  uint32_t de = RegDE();
+  n = CopyBlock(de, RegHL(), std::min(n, BytesBefore(de, GetPC() - 2, dir)), dir);
+  SetRegDE(dir > 0 ? RegDE() + n : RegDE() - n);
+  SetRegHL(dir > 0 ? RegHL() + n : RegHL() - n);
+  SetRegBC(RegBC() - n);
+  reg_.rreg += uint8_t(n * 2);
+  AddWaits(GetPC() - 2, 2 * n);
+  CLK(21 * n);
+}
+
+// CPIR/CPDR: 一致するバイトの手前までを読み飛ばす
+void Z80C::BlockSearch(int dir) {
+  uint32_t n = BlockRepeats((RegBC() - 1) & 0xffff, 16);
+  if (!n)
+    return;
+  n = SkipBlock(RegHL(), n, dir, RegA());
+  SetRegHL(dir > 0 ? RegHL() + n : RegHL() - n);
+  SetRegBC((RegBC() - n) & 0xffff);
+  reg_.rreg += uint8_t(n * 2);
+  AddWaits(GetPC() - 2, 2 * n);
+  CLK(16 * n);
+}
+
+// INIR/INDR/OTIR/OTDR: 1 回実行した後，次の繰り返しも続けて実行するか
+bool Z80C::RepeatIO(uint32_t op) {
+  if (!RegB() || !CanRepeat() || !PeekInst(0xed, op))
+    return false;
+  PCInc(2);
+  reg_.rreg += 2;
+  return true;
+}
+
 // ---------------------------------------------------------------------------
 // フラグ関数 ---------------------------------------------------------------
 
@@ -2832,6 +3038,7 @@ bool Z80C::LoadStatus(const uint8_t* s) {
   reg_ = st->reg;
 
   SetPC(reg_.pc);
+  idle_.Reset();
 
   intr_ = st->intr;
   wait_state_ = st->wait;
@@ -13,11 +13,15 @@
 #include "common/io_bus.h"
 #include "common/memory_manager.h"
 #include "devices/z80.h"
+#include "devices/z80_idle.h"
+#include "devices/z80_profiler.h"
 #include "devices/z80diag.h"
 
 class IOBus;
 
-#define Z80C_STATISTICS
+// 命令ディスパッチに computed goto (GCC/Clang) を使い，命令間で関数を抜けずに
+// 次の命令へ分岐する．CMake の M88_Z80C_THREADED_DISPATCH で有効になる．
+// #define Z80C_THREADED_DISPATCH
 
 // ----------------------------------------------------------------------------
 //  Z80 Emulator
@@ -61,6 +65,14 @@ class IOBus;
 //  in:     wait    止める場合 true
 //                  wait 状態の場合 Exec が命令を実行しないようになる
 //
+//  void EnableIdleSkip(bool enable)
+//  アイドルループ (Z80IdleDetector) を検出したら，次のイベントまでの
+//  周回を省略する
+//
+//  void EnableProfiler(bool enable)
+//  命令ごとに Z80Profiler へ実行位置とクロックを記録する
+//  (有効な間はアイドルループの省略などの高速化を行わない)
+//
 
 class Z80C;
 
@@ -76,24 +88,40 @@ class CPUExecutor {
   static int64_t ExecDual(Z80C* first, Z80C* second, int64_t count);
   static int64_t ExecDual2(Z80C* first, Z80C* second, int64_t count);
 
+  // 実行方法とダンプの有無ごとに特殊化した実行関数
+  // (ExecSingle などは呼び出しのたびにダンプの有無を確認してこれを呼ぶ)
+  using ExecFunc = int64_t (*)(Z80C* first, Z80C* second, int64_t clocks);
+  static ExecFunc GetExecFunc(Z80ExecMode mode, bool dump = false);
+  // Z80X と同じインターフェース．クロックは常にメイン CPU の単位で数えるので何もしない
+  void SetClockShift(int) {}
+
   void Stop(int count);
   static void StopDual(int count);
 
   // クロックカウンタ取得
   [[nodiscard]] int64_t GetClocks() const { return exec_clocks_ + (clock_count_ << eshift_); }
+  // LoadStatus は下位 32 bit しか戻さないので，必要ならこれで戻す (実行中には呼ばない)
+  void SetClocks(int64_t clocks) { exec_clocks_ = clocks - (clock_count_ << eshift_); }
   static int64_t GetCCount();
 
  protected:
   // XXX
   void CLK(int count) { clock_count_ += count; }
   bool Sync();
+  int64_t SkipClocks(int64_t period);
 
   int64_t clock_count_ = 0;
   int64_t exec_clocks_ = 0;
 
  private:
-  int64_t Exec0(Z80C* cpu, int64_t stop, int64_t other);
-  int64_t Exec1(Z80C* cpu, int64_t stop, int64_t other);
+  // kShift: クロック比 (1:1 = 0, 2:1 = 1), kDump: 命令ごとにダンプを出力する
+  template <int kShift, bool kDump>
+  int64_t Exec(Z80C* cpu, int64_t stop, int64_t other);
+  template <bool kDump>
+  static int64_t RunSingle(Z80C* first, Z80C* second, int64_t clocks);
+  template <int kShift, bool kDump>
+  static int64_t RunDual(Z80C* first, Z80C* second, int64_t count);
+  static bool IsDumping(const Z80C* first, const Z80C* second);
 
   Z80C* cpu_;
 
@@ -107,9 +135,6 @@ class CPUExecutor {
 
   int64_t stop_count_ = 0;
   int64_t delay_count_ = 0;
-
-  // XXX
-  bool dump_log_ = false;
 };
 
 class Z80C : public Device, private IOStrategy, public MemStrategy, public CPUExecutor {
@@ -120,11 +145,6 @@ class Z80C : public Device, private IOStrategy, public MemStrategy, public CPUEx
     nmi,
   };
 
-  struct Statistics {
-    uint32_t execute[0x10000];
-    void Clear() { memset(execute, 0, sizeof(execute)); }
-  };
-
   explicit Z80C(const ID& id);
   ~Z80C() override;
 
@@ -138,6 +158,7 @@ class Z80C : public Device, private IOStrategy, public MemStrategy, public CPUEx
   void IOCALL IRQ(uint32_t, uint32_t d) { intr_ = d; }
   void IOCALL NMI(uint32_t = 0, uint32_t = 0);
   void Wait(bool flag);
+  void EnableIdleSkip(bool enable);
 
   // State save/load
   uint32_t IFCALL GetStatusSize() override;
@@ -146,14 +167,17 @@ class Z80C : public Device, private IOStrategy, public MemStrategy, public CPUEx
 
   const Z80Reg& GetReg() { return reg_; }
 
-  int* GetWaits() { return nullptr; }
-
   void TestIntr();
   bool IsIntr() { return !!intr_; }
   bool EnableDump(bool dump);
   int GetDumpState() { return dump_log_ != nullptr; }
 
-  Statistics* GetStatistics();
+  void EnableProfiler(bool enable) { profiler_.Enable(enable); }
+  Z80Profiler* GetProfiler() { return &profiler_; }
+
+ protected:
+  // 命令のクロックに，その命令のメモリアクセスのウェイトを加えて進める
+  void CLK(int count) { clock_count_ += count + TakeWaits(); }
 
  private:
   friend class CPUExecutor;
@@ -173,6 +197,10 @@ class Z80C : public Device, private IOStrategy, public MemStrategy, public CPUEx
 
   Z80Reg reg_{};
 
+  // アイドルループの省略
+  bool idle_skip_ = false;
+  Z80IdleDetector idle_;
+
   static const Descriptor descriptor;
   static const OutFuncPtr outdef[];
 
@@ -202,14 +230,16 @@ class Z80C : public Device, private IOStrategy, public MemStrategy, public CPUEx
   FILE* dump_log_;
   Z80Diag diag_;
 
-#ifdef Z80C_STATISTICS
-  Statistics statistics{};
-#endif
+  Z80Profiler profiler_;
 
   // 内部インターフェース
  private:
-  void SingleStep(uint32_t inst);
+  void SingleStep(uint32_t inst, bool chain = false);
   void SingleStep();
+  void Run();
+  void RunIdleSkip();
+  void RunProfile();
+  void CheckIdle(uint32_t pc);
 
   void OutTestIntr();
 
@@ -249,6 +279,11 @@ class Z80C : public Device, private IOStrategy, public MemStrategy, public CPUEx
 
   void CPI();
   void CPD();
+  bool CanRepeat();
+  uint32_t BlockRepeats(uint32_t count, int clocks);
+  void BlockCopy(int dir);
+  void BlockSearch(int dir);
+  bool RepeatIO(uint32_t op);
   void CodeCB();
 
   uint8_t RLC(uint8_t);
@@ -351,14 +386,6 @@ class Z80C : public Device, private IOStrategy, public MemStrategy, public CPUEx
   }
 };
 
-inline Z80C::Statistics* Z80C::GetStatistics() {
-#ifdef Z80C_STATISTICS
-  return &statistics;
-#else
-  return 0;
-#endif
-}
-
 // static
 inline int64_t CPUExecutor::GetCCount() {
   return currentcpu ? currentcpu->GetClocks() - currentcpu->start_count_ : 0;
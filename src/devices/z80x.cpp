@@ -11,15 +11,18 @@
 // static
 int64_t Z80X::ExecSingle(Z80X* first, Z80X* second, int64_t clocks) {
   int64_t start = first->GetClocks();
-  int64_t target = start + clocks;
-  while (first->GetClocks() < target) {
+  target_ = start + clocks;
+  dual_ = false;
+  first->clock_shift_ = 0;
+  while (first->GetClocks() < target_) {
     currentcpu = first;
-    first->SingleStep();
+    first->Run(target_ - first->GetClocks(), 0);
   }
   int64_t cycles = first->GetClocks() - start;
   first->SyncCycles();
-  second->exec_cycles_ = first->exec_cycles_;
-  second->cycles_ = first->cycles_;
+  // 実行しなかった CPU も同じ時刻まで進める (SetClockShift(1) の CPU は半分のクロック)
+  second->exec_cycles_ = first->exec_cycles_ >> second->clock_shift_;
+  second->cycles_ = 0;
   return cycles;
 }
 
@@ -29,14 +32,18 @@ int64_t Z80X::ExecSingle(Z80X* first, Z80X* second, int64_t clocks) {
 // static
 int64_t Z80X::ExecDual(Z80X* first, Z80X* second, int64_t clocks) {
   int64_t start = std::min(first->GetClocks(), second->GetClocks());
-  int64_t target = start + clocks;
-  while (first->GetClocks() < target || second->GetClocks() < target) {
-    if (first->GetClocks() < second->GetClocks()) {
+  target_ = start + clocks;
+  dual_ = true;
+  first->clock_shift_ = second->clock_shift_ = 0;
+  while (first->GetClocks() < target_ || second->GetClocks() < target_) {
+    int64_t c1 = first->GetClocks();
+    int64_t c2 = second->GetClocks();
+    if (c1 < c2) {
       currentcpu = first;
-      first->SingleStep();
+      first->Run(Slice(c1, c2, target_), c2 - c1);
     } else {
       currentcpu = second;
-      second->SingleStep();
+      second->Run(Slice(c2, c1, target_), c1 - c2);
     }
   }
   int64_t cycles = std::min(first->GetClocks(), second->GetClocks()) - start;
@@ -52,14 +59,19 @@ int64_t Z80X::ExecDual(Z80X* first, Z80X* second, int64_t clocks) {
 int64_t Z80X::ExecDual2(Z80X* first, Z80X* second, int64_t clocks) {
   currentcpu = first;
   int64_t start = std::min(first->GetClocks(), second->GetClocks() * 2);
-  int64_t target = start + clocks;
-  while (first->GetClocks() < target || second->GetClocks() * 2 < target) {
-    if (first->GetClocks() < second->GetClocks() * 2) {
+  target_ = start + clocks;
+  dual_ = true;
+  first->clock_shift_ = 0;
+  second->clock_shift_ = 1;
+  while (first->GetClocks() < target_ || second->GetClocks() * 2 < target_) {
+    int64_t c1 = first->GetClocks();
+    int64_t c2 = second->GetClocks() * 2;
+    if (c1 < c2) {
       currentcpu = first;
-      first->SingleStep();
+      first->Run(Slice(c1, c2, target_), c2 - c1);
     } else {
       currentcpu = second;
-      second->SingleStep();
+      second->Run((Slice(c2, c1, target_) + 1) / 2, (c1 - c2) / 2);
     }
   }
   int64_t cycles = std::min(first->GetClocks(), second->GetClocks() * 2) - start;
@@ -68,11 +80,34 @@ int64_t Z80X::ExecDual2(Z80X* first, Z80X* second, int64_t clocks) {
   return cycles;
 }
 
+// ---------------------------------------------------------------------------
+// 実行方法に対応する実行関数
+//
+// static
+Z80X::ExecFunc Z80X::GetExecFunc(Z80ExecMode mode) {
+  static const ExecFunc funcs[] = {&ExecSingle, &ExecDual, &ExecDual2};
+  return funcs[static_cast<int>(mode)];
+}
+
+// ---------------------------------------------------------------------------
+// 実行するクロック数 (主 CPU のクロック)
+//
+// static
+int64_t Z80X::Slice(int64_t self, int64_t other, int64_t limit) {
+#ifdef Z80X_HORIZON
+  return std::min(limit, other + kMaxLead) - self;
+#else
+  return limit - self;
+#endif
+}
+
 // ---------------------------------------------------------------------------
 // Exec を途中で中断
+// 実行中の z80_run は libZ80 の break 機構で打ち切る
 //
 void Z80X::Stop(int count) {
-  cycles_ = -count;
+  target_ = (GetClocks() << clock_shift_) + count;
+  z80_break(&z80_);
 }
 
 // static
@@ -83,28 +118,86 @@ void Z80X::StopDual(int count) {
 
 // static
 Z80X* Z80X::currentcpu = nullptr;
+// static
+int64_t Z80X::target_ = 0;
+// static
+bool Z80X::dual_ = false;
 
 // static
 uint8_t Z80X::ZRead8(void* ctx, uint16_t addr) {
   auto* self = reinterpret_cast<Z80X*>(ctx);
-  return self->Read8(addr);
+  uint8_t data = self->Read8(addr);
+  self->z80_.cycles += zusize(self->TakeWaits());
+  return data;
+}
+
+// static
+// オペランドの読み込みにはウェイトを加えない (Z80C と同じ)
+uint8_t Z80X::ZFetch(void* ctx, uint16_t addr) {
+  auto* self = reinterpret_cast<Z80X*>(ctx);
+  uint8_t data = self->Read8(addr);
+  self->TakeWaits();
+  return data;
+}
+
+// static
+uint8_t Z80X::ZFetchOpcode(void* ctx, uint16_t addr) {
+  auto* self = reinterpret_cast<Z80X*>(ctx);
+#ifdef Z80X_HORIZON
+  // 相手 CPU より先行したまま同期ポートへ I/O しようとしたら，代わりに NOP を実行して
+  // 打ち切る (Z80C の Sync と同じ)．命令は Run で巻き戻し，相手 CPU が追いついてから実行する
+  if (dual_ && self->running_ && self->cycles_ + int64_t(self->z80_.cycles) > self->sync_end_ &&
+      self->IsSyncIO(addr)) {
+    self->deferred_ = true;
+    z80_break(&self->z80_);
+    return 0x00;
+  }
+#endif
+  if (self->idle_skip_) {
+    if (Z80IdleDetector::IsLoopBranch(self->last_pc_, addr))
+      self->CheckIdle(addr);
+    self->last_pc_ = addr;
+  }
+  uint8_t op = self->Read8(addr);
+  if (op == 0xed)
+    self->BlockRepeat(addr);
+  self->z80_.cycles += zusize(self->TakeWaits());
+  return op;
+}
+
+// static
+uint8_t Z80X::ZFetchOpcodeProfile(void* ctx, uint16_t addr) {
+  auto* self = reinterpret_cast<Z80X*>(ctx);
+  self->profiler_.Enter(addr, self->PageOf(addr), self->GetClocks());
+  return ZFetchOpcode(ctx, addr);
 }
 
 // static
 void Z80X::ZWrite8(void* ctx, uint16_t addr, uint8_t data) {
   auto* self = reinterpret_cast<Z80X*>(ctx);
   self->Write8(addr, data);
+  self->z80_.cycles += zusize(self->TakeWaits());
 }
 
 // static
 uint8_t Z80X::ZIn(void* ctx, uint16_t addr) {
   auto* self = reinterpret_cast<Z80X*>(ctx);
+#ifdef Z80X_HORIZON
+  // 相手 CPU との同期点 (相手 CPU は追いついている)．この命令で実行を打ち切り，
+  // 相手 CPU に切り替える
+  if (dual_ && self->IsSyncPort(addr & 0xff))
+    z80_break(&self->z80_);
+#endif
   return self->Inp(addr);
 }
 
 // static
 void Z80X::ZOut(void* ctx, uint16_t addr, uint8_t data) {
   auto* self = reinterpret_cast<Z80X*>(ctx);
+#ifdef Z80X_HORIZON
+  if (dual_ && self->IsSyncPort(addr & 0xff))
+    z80_break(&self->z80_);
+#endif
   self->Outp(addr, data);
 }
 
@@ -135,8 +228,8 @@ Z80X::Z80X(const ID& id) : Device(id), IOStrategy(), MemStrategy() {
   z80_.cycles = 0;
   z80_.cycle_limit = Z80_MAXIMUM_CYCLES_PER_STEP;
   z80_.context = (void*)this;
-  z80_.fetch_opcode = &Z80X::ZRead8;
-  z80_.fetch = &Z80X::ZRead8;
+  z80_.fetch_opcode = &Z80X::ZFetchOpcode;
+  z80_.fetch = &Z80X::ZFetch;
   z80_.read = &Z80X::ZRead8;
   z80_.write = &Z80X::ZWrite8;
   z80_.in = &Z80X::ZIn;
@@ -181,6 +274,7 @@ void Z80X::Reset(uint32_t, uint32_t) {
   reg_.intmode = 0;  // IM0
   SetPC(0);          // pc, sp = 0
   wait_state_ = 0;
+  idle_.Reset();
 
   exec_cycles_ = 0;
 }
@@ -200,9 +294,126 @@ void Z80X::Wait(bool wait) {
     wait_state_ &= ~2;
 }
 
+// ---------------------------------------------------------------------------
+// アイドルループの省略
+// Run に渡された残りクロックを超えない範囲で周回を省略する
+//
+void Z80X::EnableIdleSkip(bool enable) {
+  idle_skip_ = enable;
+  idle_.Reset();
+}
+
+// ---------------------------------------------------------------------------
+// 実行プロファイラ
+// 有効な間だけ記録付きのフェッチ関数に差し替える
+//
+void Z80X::EnableProfiler(bool enable) {
+  profiler_.Enable(enable);
+  z80_.fetch_opcode = profiler_.IsEnabled() ? &Z80X::ZFetchOpcodeProfile : &Z80X::ZFetchOpcode;
+}
+
+void Z80X::CheckIdle(uint32_t pc) {
+  if (!running_)
+    return;
+  ImportReg();
+  uint32_t effects = IOEffects() + MemEffects();
+  if (!idle_.Check(pc, reg_, effects, GetClocks()))
+    return;
+  // BlockRepeat と同様に，Run に渡されたクロックまでを残りとする
+  int64_t budget = run_end_ - cycles_ - int64_t(z80_.cycles);
+  int64_t n = budget / idle_.period();
+  if (n > 0) {
+    z80_.cycles += zusize(n * idle_.period());
+    z80_.r += uint8_t(n * idle_.rdelta());
+  }
+  idle_.Reset();
+}
+
+// ---------------------------------------------------------------------------
+// ブロック命令の繰り返し
+// LDIR/LDDR/CPIR/CPDR を実行する直前 (ED のフェッチ時) に，Run の残りクロックで
+// 続けて実行されるはずの繰り返しのうち，最後の 1 回を除いた分をまとめて実行する．
+// 最後の 1 回は libZ80 が実行するので，フラグはそこで設定される．
+// libZ80 は繰り返しの合間に割り込みを受け付けるので，受け付けられる状態では行わない
+//
+void Z80X::BlockRepeat(uint32_t pc) {
+  // Z80X_HORIZON でなければ z80_run は 1 命令ずつなので，cycle_limit ではなく
+  // Run に渡されたクロックまでを残りとする
+  int64_t budget = run_end_ - cycles_ - int64_t(z80_.cycles);
+  uint32_t op;
+  if (!running_ || budget <= 0 || z80_.cycles >= z80_.cycle_limit || z80_.request ||
+      (z80_.iff1 && z80_.int_line) || !Peek8(pc + 1, &op) || (op & 0xf6) != 0xb0)
+    return;
+
+  // 繰り返し 1 回は 21 クロック
+  uint32_t n = static_cast<uint32_t>(
+      std::min<int64_t>((Z80_BC(z80_) - 1) & 0xffff, (budget - 1) / 21));
+  int dir = op & 8 ? -1 : 1;
+  uint32_t hl = Z80_HL(z80_);
+  if (op & 1) {
+    // CPIR/CPDR: 一致するバイトの手前まで
+    n = SkipBlock(hl, n, dir, Z80_AF(z80_) >> 8);
+  } else {
+    // LDIR/LDDR: 命令自身を書き換える場合はその手前まで
+    uint32_t de = Z80_DE(z80_);
+    n = CopyBlock(de, hl, std::min(n, BytesBefore(de, pc, dir)), dir);
+    Z80_DE(z80_) = dir > 0 ? de + n : de - n;
+  }
+  if (!n)
+    return;
+  Z80_HL(z80_) = dir > 0 ? hl + n : hl - n;
+  Z80_BC(z80_) -= n;
+  Z80_MEMPTR(z80_) = pc + 1;
+  z80_.r += uint8_t(n * 2);
+  AddWaits(pc, 2 * n);
+  z80_.cycles += zusize(21) * n;
+}
+
 void Z80X::SingleStep() {
+  running_ = true;
   cycles_ += z80_run(&z80_, 4);
+  running_ = false;
+}
+
+void Z80X::Run(int64_t limit, [[maybe_unused]] int64_t sync) {
+  run_end_ = cycles_ + limit;
+#ifdef Z80X_HORIZON
+  sync_end_ = cycles_ + sync;
+  running_ = true;
+  cycles_ += z80_run(&z80_, zusize(std::max<int64_t>(limit, 1)));
+  running_ = false;
+  if (deferred_) {
+    // 代わりに実行した NOP を取り消す
+    deferred_ = false;
+    Z80_PC(z80_) = uint16_t(Z80_PC(z80_) - 1);
+    z80_.r--;
+    cycles_ -= 4;
+  }
+#else
+  SingleStep();
+#endif
+}
+
+#ifdef Z80X_HORIZON
+bool Z80X::IsSyncIO(uint32_t pc) {
+  uint32_t op = 0;
+  uint32_t port = 0;
+  if (!Peek8(pc, &op))
+    return false;
+  switch (op) {
+    case 0xd3:  // OUT (n),A
+    case 0xdb:  // IN A,(n)
+      return Peek8(pc + 1, &port) && IsSyncPort(port);
+    case 0xed:
+      // IN r,(C) / OUT (C),r と INI/IND/OUTI/OUTD (繰り返しを含む)
+      if (!Peek8(pc + 1, &op) || ((op & 0xc6) != 0x40 && (op & 0xe6) != 0xa2))
+        return false;
+      return IsSyncPort(Z80_BC(z80_) & 0xff);
+    default:
+      return false;
+  }
 }
+#endif
 
 void Z80X::ImportReg() {
   reg_.r.w.af = Z80_AF(z80_);
@@ -277,6 +488,7 @@ bool Z80X::LoadStatus(const uint8_t* s) {
   reg_ = st->reg;
   ExportReg();
   SetPC(reg_.pc);
+  idle_.Reset();
 
   z80_.request = st->z80_request;
   z80_.resume = st->z80_resume;
@@ -12,11 +12,20 @@
 #include "common/io_bus.h"
 #include "common/memory_manager.h"
 #include "devices/z80.h"
+#include "devices/z80_idle.h"
+#include "devices/z80_profiler.h"
 #include "devices/z80c.h"
 #include "devices/z80diag.h"
 // XXX not to confuse with z80.h in the current directory.
 #include "Z80/API/Z80.h"
 
+// libZ80 を 4 クロックずつではなく，Exec の終了時刻 (次のスケジューライベント)
+// まで続けて実行する．2CPU 実行時は相手 CPU との差を kMaxLead クロックまでとし，
+// 同期ポートへの I/O で実行を打ち切る．相手 CPU より先行している間は同期ポートへの
+// I/O を行わず，相手 CPU が追いついてから実行し直す．
+// CMake の M88_Z80X_HORIZON で有効になる．
+// #define Z80X_HORIZON
+
 class Z80X : public Device, private IOStrategy, public MemStrategy {
  public:
   enum {
@@ -38,17 +47,26 @@ class Z80X : public Device, private IOStrategy, public MemStrategy {
   void IOCALL IRQ(uint32_t, uint32_t d);
   void IOCALL NMI(uint32_t = 0, uint32_t = 0);
   void Wait(bool flag);
+  // アイドルループを検出したら Run の残りクロック分の周回を省略する
+  void EnableIdleSkip(bool enable);
 
   // Execution
   static int64_t ExecSingle(Z80X* first, Z80X* second, int64_t clocks);
   static int64_t ExecDual(Z80X* first, Z80X* second, int64_t clocks);
   static int64_t ExecDual2(Z80X* first, Z80X* second, int64_t clocks);
+  // 実行方法に対応する実行関数 (ダンプはないので Z80C と異なり dump は取らない)
+  using ExecFunc = int64_t (*)(Z80X* first, Z80X* second, int64_t clocks);
+  static ExecFunc GetExecFunc(Z80ExecMode mode);
+  // ExecSingle で実行しない CPU のクロック比 (main:sub = 1:1 なら 0, 2:1 なら 1)
+  void SetClockShift(int shift) { clock_shift_ = shift; }
 
   void Stop(int count);
   static void StopDual(int count);
 
   // クロックカウンタ取得
-  [[nodiscard]] int64_t GetClocks() const { return exec_cycles_ + cycles_; }
+  [[nodiscard]] int64_t GetClocks() const { return exec_cycles_ + cycles_ + RunningCycles(); }
+  // LoadStatus は下位 32 bit しか戻さないので，必要ならこれで戻す (実行中には呼ばない)
+  void SetClocks(int64_t clocks) { exec_cycles_ = clocks - cycles_ - RunningCycles(); }
   static int64_t GetCCount();
 
   bool EnableDump(bool dump) {}
@@ -58,15 +76,16 @@ class Z80X : public Device, private IOStrategy, public MemStrategy {
     ImportReg();
     return reg_;
   }
-  [[nodiscard]] uint32_t GetPC() const { return reg_.pc; }
-  int* GetWaits() { return nullptr; }
+  [[nodiscard]] uint32_t GetPC() const { return Z80_PC(z80_); }
 
   // State save/load
   uint32_t IFCALL GetStatusSize() override;
   bool IFCALL SaveStatus(uint8_t* status) override;
   bool IFCALL LoadStatus(const uint8_t* status) override;
 
-  Z80C::Statistics* GetStatistics() { return nullptr; }
+  // 実行プロファイラ (有効な間は命令のフェッチごとに記録する)
+  void EnableProfiler(bool enable);
+  Z80Profiler* GetProfiler() { return &profiler_; }
 
  private:
   friend class CPUExecutorX;
@@ -86,8 +105,22 @@ class Z80X : public Device, private IOStrategy, public MemStrategy {
     int execcount;
   };
 
+#ifdef Z80X_HORIZON
+  // 2CPU 実行時に相手 CPU より先行してよいクロック数
+  static constexpr int64_t kMaxLead = 128;
+#endif
+
   // Execute ~1 instruction
   void SingleStep();
+  // Execute instructions starting within |limit| cycles
+  // (Z80X_HORIZON: in one z80_run, otherwise by SingleStep)
+  // sync: 相手 CPU のクロックに追いつくまでのクロック数 (Z80X_HORIZON の 2CPU 実行時のみ使う)
+  void Run(int64_t limit, int64_t sync);
+  // 自 CPU のクロックで limit まで，ただし相手 CPU (other) より kMaxLead 以上先行しない
+  static int64_t Slice(int64_t self, int64_t other, int64_t limit);
+
+  // z80_run 実行中に進んだクロック数
+  [[nodiscard]] int64_t RunningCycles() const { return running_ ? int64_t(z80_.cycles) : 0; }
 
   // Sync execution / clock count
   void SyncCycles() {
@@ -95,6 +128,13 @@ class Z80X : public Device, private IOStrategy, public MemStrategy {
     cycles_ = 0;
   }
 
+  void CheckIdle(uint32_t pc);
+  void BlockRepeat(uint32_t pc);
+#ifdef Z80X_HORIZON
+  // pc から始まる命令が同期ポートへの I/O か
+  bool IsSyncIO(uint32_t pc);
+#endif
+
   // Syncs libz80 reg -> Z80Reg
   void ImportReg();
   // Syncs Z80Reg -> libz80 reg
@@ -102,6 +142,9 @@ class Z80X : public Device, private IOStrategy, public MemStrategy {
 
   // for libZ80
   static uint8_t ZRead8(void* ctx, uint16_t addr);
+  static uint8_t ZFetch(void* ctx, uint16_t addr);
+  static uint8_t ZFetchOpcode(void* ctx, uint16_t addr);
+  static uint8_t ZFetchOpcodeProfile(void* ctx, uint16_t addr);
   static void ZWrite8(void* ctx, uint16_t addr, uint8_t data);
   static uint8_t ZIn(void* ctx, uint16_t addr);
   static void ZOut(void* ctx, uint16_t addr, uint8_t data);
@@ -116,8 +159,31 @@ class Z80X : public Device, private IOStrategy, public MemStrategy {
   // Execution
   int64_t cycles_ = 0;
   int64_t exec_cycles_ = 0;
+  // z80_run 実行中
+  bool running_ = false;
+  // Run の終了時刻 (自 CPU のクロック．cycles_ と同じ基準)
+  int64_t run_end_ = 0;
+#ifdef Z80X_HORIZON
+  // 相手 CPU のクロック (run_end_ と同じ基準)．これより先では同期ポートへの I/O を待たせる
+  int64_t sync_end_ = 0;
+  // 同期ポートへの I/O の代わりに NOP を実行した (Run で巻き戻す)
+  bool deferred_ = false;
+#endif
+  // ExecDual2 の副 CPU は 1 (主 CPU のクロックに換算するためのシフト量)
+  int clock_shift_ = 0;
 
   static Z80X* currentcpu;
+  // Exec の終了時刻 (主 CPU のクロック)
+  static int64_t target_;
+  // 2CPU 実行中
+  static bool dual_;
+
+  // アイドルループの省略 (直前にフェッチした命令のアドレス)
+  bool idle_skip_ = false;
+  uint32_t last_pc_ = 0;
+  Z80IdleDetector idle_;
+
+  Z80Profiler profiler_;
 
   static const Descriptor descriptor;
   static const OutFuncPtr outdef[];
@@ -135,5 +201,5 @@ class Z80X : public Device, private IOStrategy, public MemStrategy {
 
 // static
 inline int64_t Z80X::GetCCount() {
-  return currentcpu ? currentcpu->cycles_ : 0;
+  return currentcpu ? currentcpu->cycles_ + currentcpu->RunningCycles() : 0;
 }
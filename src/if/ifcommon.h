@@ -126,6 +126,7 @@ struct IIOBus {
     portin = 1,
     portout = 2,
     sync = 4,
+    pure = 8,  // 読み出しに副作用がない (状態の読み出しのみ)
   };
   struct Connector {
     uint16_t bank;
@@ -35,6 +35,7 @@ CMT::~CMT() {
 
 bool CMT::Init(Scheduler* sched, IOBus* bus, services::TapeManager* tape_manager, int pinput) {
   scheduler_ = sched;
+  scheduler_->RegisterHandle(&event_);
   bus_ = bus;
   tape_manager_ = tape_manager;
   pinput_ = pinput;
@@ -39,6 +39,8 @@ class CMT : public Device {
   void IOCALL Out30(uint32_t, uint32_t en);
   uint32_t IOCALL In40(uint32_t);
 
+  [[nodiscard]] bool IsMotorOn() const { return motor_on_; }
+
   // Overrides Device
   [[nodiscard]] const Descriptor* IFCALL GetDesc() const override { return &descriptor; }
   uint32_t IFCALL GetStatusSize() override;
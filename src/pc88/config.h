@@ -170,6 +170,9 @@ class Config {
     // kSavePosition = 1 << 13,  // 起動時に前回終了時のウインドウ位置を復元
     // Use Piccolo-based hardware sound device
     kUsePiccolo = 1 << 14,
+    kSkipIdleLoop = 1 << 15,    // メイン CPU のアイドルループを省略する
+    kPrecisePacing = 1 << 16,   // 画面更新の間隔を 1ms より細かくそろえる
+    kSkipSubCPUWait = 1 << 17,  // サブ CPU のコマンド待ちを省略する
   };
 
   [[nodiscard]] BasicMode basic_mode() const { return basic_mode_; }
@@ -223,6 +226,8 @@ class Config {
   // uint32_t lpforder;
 
   int romeolatency;
+  // run-ahead するフレーム数 (0: 無効, 0-4)
+  int run_ahead_frames;
   int winposx;
   int winposy;
 
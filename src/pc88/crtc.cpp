@@ -37,6 +37,22 @@ constexpr uint8_t COLOR_BIT = 0b00000111;
 constexpr packed TEXT_BITP = PACK(TEXT_BIT);
 constexpr packed TEXT_SETP = PACK(TEXT_SET);
 constexpr packed TEXT_RESP = PACK(TEXT_RES);
+
+// テキスト 1 行分のハッシュ (8 バイトずつ混ぜる)
+uint64_t HashRow(const uint8_t* src, uint32_t size) {
+  constexpr uint64_t kMul = 0x9e3779b97f4a7c15ULL;
+  uint64_t h = size * kMul;
+  for (; size >= 8; size -= 8, src += 8) {
+    uint64_t x;
+    memcpy(&x, src, 8);
+    h = (h ^ x) * kMul;
+    h ^= h >> 29;
+  }
+  uint64_t x = 0;
+  memcpy(&x, src, size);
+  h = (h ^ x) * kMul;
+  return h ^ (h >> 32);
+}
 }  // namespace
 
 namespace pc8801 {
@@ -70,14 +86,17 @@ CRTC::CRTC(const ID& id) : Device(id) {}
 bool CRTC::Init(IOBus* bus, Scheduler* sched, PD8257* dmac) {
   bus_ = bus;
   scheduler_ = sched;
+  scheduler_->RegisterHandle(&sev_);
   dmac_ = dmac;
 
   font_ = std::make_unique<uint8_t[]>(0x8000 + 0x10000);
   fontrom_ = nullptr;
   pcgram_ = std::make_unique<uint8_t[]>(0x400);
   vram_ = std::make_unique<uint8_t[]>(0x1e00 + 0x1e00 + 0x1400);
+  glyph_keys_ = std::make_unique<uint32_t[]>(kGlyphSlots);
+  glyph_cells_ = std::make_unique<packed[]>(kGlyphSlots * kMaxCellLines * 4);
 
-  if (!font_ || !vram_ || !pcgram_) {
+  if (!font_ || !vram_ || !pcgram_ || !glyph_keys_ || !glyph_cells_) {
     Error::SetError(Error::OutOfMemory);
     return false;
   }
@@ -170,6 +189,7 @@ void CRTC::SetTextMode(bool color) {
     pat_rev_ = PACK(0x10);
     pat_mask_ = ~PACK(0x1f);
   }
+  InvalidateGlyphs();
   SetFlag(kRefresh);
 }
 
@@ -179,6 +199,7 @@ void CRTC::SetTextMode(bool color) {
 void CRTC::SetTextSize(bool wide) {
   widefont_ = wide;
   memset(attrcache_, kSecret, 0x1400);
+  InvalidateRows();
 }
 
 // ---------------------------------------------------------------------------
@@ -387,6 +408,7 @@ void CRTC::CreateTFontSub(const uint8_t* src, int idx, int num) {
       *destw++ = b;
     }
   }
+  InvalidateGlyphs();
 }
 
 void CRTC::ModifyFont(uint32_t off, uint32_t d) {
@@ -399,6 +421,7 @@ void CRTC::ModifyFont(uint32_t off, uint32_t d) {
     *destw++ = b;
     *destw++ = b;
   }
+  InvalidateGlyphs();
   SetFlag(kRefresh);
 }
 
@@ -426,6 +449,7 @@ void CRTC::CreateGFont() {
       destw += 32;
     }
   }
+  InvalidateGlyphs();
 }
 
 // ---------------------------------------------------------------------------
@@ -498,6 +522,7 @@ int CRTC::ExpandLineSub() {
                 memset(dest + line_size_, 0, line_size_ * skip);
                 // XXX
                 dmac_->Reload();
+                HashRows(row_, skip + 1);
                 return skip;
               }
             }
@@ -512,10 +537,19 @@ int CRTC::ExpandLineSub() {
     } else {
       memset(dest, 0, line_size_);
     }
+    HashRows(row_, 1);
   }
   return 0;
 }
 
+// 書き込んだ行のハッシュを取っておく
+void CRTC::HashRows(uint32_t row, uint32_t count) {
+  const uint8_t* src = vram_ptr_[bank_] + line_size_ * row;
+  uint32_t end = std::min(row + count, kMaxRows);
+  for (; row < end; ++row, src += line_size_)
+    row_hash_[bank_][row] = HashRow(src, line_size_);
+}
+
 inline void CRTC::ExpandLineEnd(uint32_t) {
   //  Log("Vertical Retrace\n");
   bus_->Out(PC88::kVrtc, 1);
@@ -564,7 +598,6 @@ void CRTC::UpdateScreen(uint8_t* image, int bpl, Draw::Region& region, bool ref)
       attr_cursor_ = ctype[1 + cursor_type];
 
     attr_blink_ = frame_time_ < blink_rate_ / 4 ? kSecret : 0;
-    underline_ptr_ = (lines_per_char_ - 1) * bpl_;
 
     Log(" update");
 
@@ -612,6 +645,15 @@ void CRTC::ClearText(uint8_t* dest) {
   }
   // すべてのテキストをシークレット属性扱いにする
   memset(attrcache_, kSecret, 0x1400);
+  InvalidateRows();
+}
+
+// ---------------------------------------------------------------------------
+//  すべての行を次の展開で描き直させる
+//
+void CRTC::InvalidateRows() {
+  for (auto& row : row_state_)
+    row.valid = false;
 }
 
 // ---------------------------------------------------------------------------
@@ -622,9 +664,21 @@ void CRTC::ExpandImage(uint8_t* image, Draw::Region& region) {
                                          PACK(4), PACK(5), PACK(6), PACK(7)};
 
   uint8_t attrflag[128];
+  ValidateGlyphs();
 
-  int top = 100;
+  // 書き換えた行が続く範囲ごとに region に加える
+  int top = -1;
   int bottom = -1;
+  int left = 999;
+  int right = -1;
+  auto flush = [&]() {
+    if (top >= 0) {
+      region.Update(left * 8, lines_per_char_ * top, (right + 1) * 8, lines_per_char_ * bottom - 1);
+      top = -1;
+      left = 999;
+      right = -1;
+    }
+  };
 
   int linestep = lines_per_char_ * bpl_;
 
@@ -632,28 +686,45 @@ void CRTC::ExpandImage(uint8_t* image, Draw::Region& region) {
 
   //  Log("ExpandImage Bank:%d\n", bank);
   //  image += y * linestep;
+  const uint64_t* hash = row_hash_[bank_];
   uint8_t* src = vram_ptr_[bank_];         // + y * linesize;
   uint8_t* cache = vram_ptr_[bank_ ^= 1];  // + y * linesize;
   uint8_t* cache_attr = attrcache_;        // + y * width;
 
-  uint32_t left = 999;
-  int right = -1;
+  // 行の内容以外で展開結果を左右するもの
+  uint8_t mode = (flags_ & (kInverse | kColor | kSkipline)) | (attr_blink_ << 4);
 
-  for (int y = 0; y <= yy; ++y, image += linestep) {
+  for (int y = 0; y <= yy;
+       ++y, image += linestep, src += line_size_, cache += line_size_, cache_attr += width_) {
     if (!IsSet(kSkipline) || !(y & 1)) {
       attr_ &= ~(kOverline | kUnderline);
+
+      // 前回描いた時と同じ行なら展開しない (attr_ だけ進めておく)
+      RowState& row = row_state_[y];
+      uint32_t cursor = cursor_y_ == uint32_t(y) && cursor_x_ < width_
+                            ? (cursor_x_ << 8) | attr_cursor_
+                            : 0;
+      if (row.valid && row.hash == hash[y] && row.cursor == cursor && row.mode == mode &&
+          row.attr_in == attr_) {
+        attr_ = row.attr_out;
+        flush();
+        continue;
+      }
+      row = {hash[y], cursor, mode, attr_, 0, true};
+
       ExpandAttributes(attrflag, src + width_, y);
+      row.attr_out = attr_;
 
+      int leftl = -1;
       int rightl = -1;
       if (widefont_) {
         for (uint32_t x = 0; x < width_; x += 2) {
           uint8_t a = attrflag[x];
           if ((src[x] ^ cache[x]) | (a ^ cache_attr[x])) {
-            pat_col_ = kColorPattern[(a >> 5) & 7];
             cache_attr[x] = a;
             rightl = x + 1;
-            if (x < left)
-              left = x;
+            if (leftl < 0)
+              leftl = x;
             PutCharW((packed*)&image[8 * x], src[x], a);
           }
         }
@@ -662,30 +733,28 @@ void CRTC::ExpandImage(uint8_t* image, Draw::Region& region) {
           uint8_t a = attrflag[x];
           //                  Log("%.2x ", a);
           if ((src[x] ^ cache[x]) | (a ^ cache_attr[x])) {
-            pat_col_ = kColorPattern[(a >> 5) & 7];
             cache_attr[x] = a;
             rightl = x;
-            if (x < left)
-              left = x;
+            if (leftl < 0)
+              leftl = x;
             PutChar((packed*)&image[8 * x], src[x], a);
           }
         }
         //              Log("\n");
       }
       if (rightl >= 0) {
-        if (rightl > right)
-          right = rightl;
-        if (top == 100)
+        if (top < 0)
           top = y;
+        left = std::min(left, leftl);
+        right = std::max(right, rightl);
         bottom = y + 1;
+      } else {
+        flush();
       }
     }
-    src += line_size_;
-    cache += line_size_;
-    cache_attr += width_;
   }
   //  Log("\n");
-  region.Update(left * 8, lines_per_char_ * top, (right + 1) * 8, lines_per_char_ * bottom - 1);
+  flush();
   //  Log("Update: from %3d to %3d\n", region.top, region.bottom);
 }
 
@@ -759,215 +828,99 @@ uint8_t CRTC::ChangeAttr(uint8_t code, uint8_t old_attr) const {
 }
 
 // ---------------------------------------------------------------------------
-//  テキスト表示
+//  文字セルのキャッシュ
+//  1 文字分の画像 (グリフ, 反転, 上線・下線, 色) を合成して持っておき，
+//  表示時にはマスクを掛けて写すだけにする．
+//  PCG・フォントの書き換え，テキストモード・文字の行数の変更で作り直す
 //
-inline void CRTC::PutChar(packed* dest, uint8_t ch, uint8_t attr) {
-  const auto* src =
-      reinterpret_cast<const packed*>(GetFont(((attr << 4) & 0x100) + (attr & kSecret ? 0 : ch)));
-  if (attr & kReverse)
-    PutReversed(dest, src), PutLineReversed(dest, attr);
-  else
-    PutNormal(dest, src), PutLineNormal(dest, attr);
+void CRTC::ValidateGlyphs() {
+  if (glyph_valid_ && glyph_lines_per_char_ == lines_per_char_ &&
+      glyph_char_limit_ == line_char_limit_)
+    return;
+  std::fill_n(glyph_keys_.get(), kGlyphSlots, ~0U);
+  glyph_lines_per_char_ = lines_per_char_;
+  glyph_char_limit_ = line_char_limit_;
+  // フォントは 2 ライン単位で描くため，line_char_limit_ が奇数だと 1 ライン多い
+  glyph_lines_ = std::max(lines_per_char_, (line_char_limit_ + 1) & ~1U);
+  glyph_valid_ = true;
 }
 
-#define NROW (bpl_ / sizeof(packed))
-// constexpr static int NROW = bpl_ / sizeof(packed);
-
-// ---------------------------------------------------------------------------
-//  普通のテキスト文字
-//
-void CRTC::PutNormal(packed* dest, const packed* src) {
-  uint32_t h;
-
-  for (h = 0; h < line_char_limit_; h += 2) {
-    packed x = *src++ | pat_col_;
-    packed y = *src++ | pat_col_;
-
-    DrawInline(dest[0], x);
-    DrawInline(dest[1], y);
-    DrawInline(dest[NROW + 0], x);
-    DrawInline(dest[NROW + 1], y);
-    dest += bpl_ * 2 / sizeof(packed);
-  }
-  packed p = pat_col_ | TEXT_RESP;
-  for (; h < lines_per_char_; ++h) {
-    DrawInline(dest[0], p);
-    DrawInline(dest[1], p);
-    dest += bpl_ / sizeof(packed);
+const packed* CRTC::GetGlyph(uint8_t ch, uint8_t attr, bool wide) {
+  uint32_t glyph = ((attr << 4) & 0x100) + (attr & kSecret ? 0 : ch);
+  uint32_t key = (glyph << 8) | (attr & (0xe0 | kUnderline | kOverline | kReverse)) |
+                 (wide ? 1 << 17 : 0);
+  uint32_t slot = (key * 0x9e3779b1U) >> (32 - kGlyphSlotBits);
+
+  packed* cell = &glyph_cells_[slot * kMaxCellLines * 4];
+  if (glyph_keys_[slot] != key) {
+    glyph_keys_[slot] = key;
+    const uint8_t* src = wide ? GetFontW(glyph) : GetFont(glyph);
+    ComposeGlyph(cell, reinterpret_cast<const packed*>(src), attr, wide ? 4 : 2);
   }
+  return cell;
 }
 
-// ---------------------------------------------------------------------------
-//  テキスト反転表示
-//
-void CRTC::PutReversed(packed* dest, const packed* src) {
-  uint32_t h;
+// width: 1 ラインの packed 数
+void CRTC::ComposeGlyph(packed* cell, const packed* src, uint8_t attr, int width) const {
+  packed col = kColorPattern[(attr >> 5) & 7];
+  packed rev = attr & kReverse ? pat_rev_ : 0;
 
+  uint32_t h;
+  packed* dest = cell;
   for (h = 0; h < line_char_limit_; h += 2) {
-    packed x = (*src++ ^ pat_rev_) | pat_col_;
-    packed y = (*src++ ^ pat_rev_) | pat_col_;
-
-    DrawInline(dest[0], x);
-    DrawInline(dest[1], y);
-    DrawInline(dest[NROW + 0], x);
-    DrawInline(dest[NROW + 1], y);
-    dest += bpl_ * 2 / sizeof(packed);
+    for (int i = 0; i < width; ++i)
+      dest[i] = dest[width + i] = (src[i] ^ rev) | col;
+    src += width;
+    dest += width * 2;
   }
-
-  packed p = pat_col_ ^ pat_rev_;
   for (; h < lines_per_char_; ++h) {
-    DrawInline(dest[0], p);
-    DrawInline(dest[1], p);
-    dest += bpl_ / sizeof(packed);
-  }
-}
-
-// ---------------------------------------------------------------------------
-//  オーバーライン、アンダーライン表示
-//
-void CRTC::PutLineNormal(packed* dest, uint8_t attr) {
-  packed d = pat_col_ | TEXT_SETP;
-  if (attr & kOverline)  // overline
-  {
-    DrawInline(dest[0], d);
-    DrawInline(dest[1], d);
+    for (int i = 0; i < width; ++i)
+      dest[i] = col ^ rev;
+    dest += width;
   }
-  if ((attr & kUnderline) && lines_per_char_ > 14) {
-    dest = (packed*)(((uint8_t*)dest) + underline_ptr_);
-    DrawInline(dest[0], d);
-    DrawInline(dest[1], d);
-  }
-}
 
-void CRTC::PutLineReversed(packed* dest, uint8_t attr) {
-  packed d = (pat_col_ | TEXT_SETP) ^ pat_rev_;
+  // オーバーライン、アンダーライン
+  packed line = (col | TEXT_SETP) ^ rev;
   if (attr & kOverline) {
-    DrawInline(dest[0], d);
-    DrawInline(dest[1], d);
+    for (int i = 0; i < width; ++i)
+      cell[i] = line;
   }
   if ((attr & kUnderline) && lines_per_char_ > 14) {
-    dest = (packed*)(((uint8_t*)dest) + underline_ptr_);
-    DrawInline(dest[0], d);
-    DrawInline(dest[1], d);
+    dest = cell + (lines_per_char_ - 1) * width;
+    for (int i = 0; i < width; ++i)
+      dest[i] = line;
   }
 }
 
-// ---------------------------------------------------------------------------
-//  テキスト表示(40 文字モード)
-//
-inline void CRTC::PutCharW(packed* dest, uint8_t ch, uint8_t attr) {
-  const packed* src = (const packed*)GetFontW(((attr << 4) & 0x100) + (attr & kSecret ? 0 : ch));
-
-  if (attr & kReverse)
-    PutReversedW(dest, src), PutLineReversedW(dest, attr);
-  else
-    PutNormalW(dest, src), PutLineNormalW(dest, attr);
-}
-
-// ---------------------------------------------------------------------------
-//  普通のテキスト文字
-//
-void CRTC::PutNormalW(packed* dest, const packed* src) {
-  uint32_t h;
-  packed x, y;
-
-  for (h = 0; h < line_char_limit_; h += 2) {
-    x = *src++ | pat_col_;
-    y = *src++ | pat_col_;
-    DrawInline(dest[0], x);
-    DrawInline(dest[1], y);
-    DrawInline(dest[NROW + 0], x);
-    DrawInline(dest[NROW + 1], y);
-
-    x = *src++ | pat_col_;
-    y = *src++ | pat_col_;
-    DrawInline(dest[2], x);
-    DrawInline(dest[3], y);
-    DrawInline(dest[NROW + 2], x);
-    DrawInline(dest[NROW + 3], y);
-    dest += bpl_ * 2 / sizeof(packed);
-  }
-  x = pat_col_ | TEXT_RESP;
-  for (; h < lines_per_char_; ++h) {
-    DrawInline(dest[0], x);
-    DrawInline(dest[1], x);
-    DrawInline(dest[2], x);
-    DrawInline(dest[3], x);
-    dest += bpl_ / sizeof(packed);
+// width 個の packed を 1 ラインとして，64bit ずつ画面に写す
+template <int width>
+inline void CRTC::BlitGlyph(packed* dest, const packed* src) const {
+  const uint64_t mask = uint64_t(pat_mask_) * 0x100000001ULL;
+  const uint32_t step = bpl_;
+  auto* d = reinterpret_cast<uint8_t*>(dest);
+  for (uint32_t h = glyph_lines_; h > 0; --h, src += width, d += step) {
+    for (int i = 0; i < width / 2; ++i) {
+      uint64_t x, y;
+      memcpy(&x, d + i * 8, 8);
+      memcpy(&y, src + i * 2, 8);
+      x = (x & mask) | y;
+      memcpy(d + i * 8, &x, 8);
+    }
   }
 }
 
 // ---------------------------------------------------------------------------
-//  テキスト反転表示
+//  テキスト表示
 //
-void CRTC::PutReversedW(packed* dest, const packed* src) {
-  uint32_t h;
-  packed x, y;
-
-  for (h = 0; h < line_char_limit_; h += 2) {
-    x = (*src++ ^ pat_rev_) | pat_col_;
-    y = (*src++ ^ pat_rev_) | pat_col_;
-    DrawInline(dest[0], x);
-    DrawInline(dest[1], y);
-    DrawInline(dest[NROW + 0], x);
-    DrawInline(dest[NROW + 1], y);
-
-    x = (*src++ ^ pat_rev_) | pat_col_;
-    y = (*src++ ^ pat_rev_) | pat_col_;
-    DrawInline(dest[2], x);
-    DrawInline(dest[3], y);
-    DrawInline(dest[NROW + 2], x);
-    DrawInline(dest[NROW + 3], y);
-
-    dest += bpl_ * 2 / sizeof(packed);
-  }
-
-  x = pat_col_ ^ pat_rev_;
-  for (; h < lines_per_char_; ++h) {
-    DrawInline(dest[0], x);
-    DrawInline(dest[1], x);
-    DrawInline(dest[2], x);
-    DrawInline(dest[3], x);
-    dest += bpl_ / sizeof(packed);
-  }
+inline void CRTC::PutChar(packed* dest, uint8_t ch, uint8_t attr) {
+  BlitGlyph<2>(dest, GetGlyph(ch, attr, false));
 }
 
 // ---------------------------------------------------------------------------
-//  オーバーライン、アンダーライン表示
+//  テキスト表示(40 文字モード)
 //
-void CRTC::PutLineNormalW(packed* dest, uint8_t attr) {
-  packed d = pat_col_ | TEXT_SETP;
-  if (attr & kOverline)  // overline
-  {
-    DrawInline(dest[0], d);
-    DrawInline(dest[1], d);
-    DrawInline(dest[2], d);
-    DrawInline(dest[3], d);
-  }
-  if ((attr & kUnderline) && lines_per_char_ > 14) {
-    dest = (packed*)(((uint8_t*)dest) + underline_ptr_);
-    DrawInline(dest[0], d);
-    DrawInline(dest[1], d);
-    DrawInline(dest[2], d);
-    DrawInline(dest[3], d);
-  }
-}
-
-void CRTC::PutLineReversedW(packed* dest, uint8_t attr) {
-  packed d = (pat_col_ | TEXT_SETP) ^ pat_rev_;
-  if (attr & kOverline) {
-    DrawInline(dest[0], d);
-    DrawInline(dest[1], d);
-    DrawInline(dest[2], d);
-    DrawInline(dest[3], d);
-  }
-  if ((attr & kUnderline) && lines_per_char_ > 14) {
-    dest = (packed*)(((uint8_t*)dest) + underline_ptr_);
-    DrawInline(dest[0], d);
-    DrawInline(dest[1], d);
-    DrawInline(dest[2], d);
-    DrawInline(dest[3], d);
-  }
+inline void CRTC::PutCharW(packed* dest, uint8_t ch, uint8_t attr) {
+  BlitGlyph<4>(dest, GetGlyph(ch, attr, true));
 }
 
 // ---------------------------------------------------------------------------
@@ -67,6 +67,8 @@ class CRTC : public Device {
  private:
   FRIEND_TEST(CRTCTest, ExpandAttributesTest);
   FRIEND_TEST(CRTCTest, ChangeAttrTest);
+  FRIEND_TEST(CRTCTest, GlyphCacheTest);
+  FRIEND_TEST(CRTCTest, RowSkipTest);
 
   // Note: only lower 8bits are saved.
   enum Flags : uint32_t {
@@ -146,25 +148,24 @@ class CRTC : public Device {
   void IOCALL ExpandLine(uint32_t = 0);
   void IOCALL ExpandLineEnd(uint32_t = 0);
   int ExpandLineSub();
+  void HashRows(uint32_t row, uint32_t count);
 
   void ClearText(uint8_t* image);
+  void InvalidateRows();
   void ExpandImage(uint8_t* image, Draw::Region& region);
   void ExpandAttributes(uint8_t* dest, const uint8_t* src, uint32_t y);
   [[nodiscard]] uint8_t ChangeAttr(uint8_t code, uint8_t old_attr) const;
 
-  void DrawInline(packed& dest, packed data) const { dest = (dest & pat_mask_) | data; }
-
   void PutChar(packed* dest, uint8_t c, uint8_t a);
-  void PutNormal(packed* dest, const packed* src);
-  void PutReversed(packed* dest, const packed* src);
-  void PutLineNormal(packed* dest, uint8_t attr);
-  void PutLineReversed(packed* dest, uint8_t attr);
-
   void PutCharW(packed* dest, uint8_t c, uint8_t a);
-  void PutNormalW(packed* dest, const packed* src);
-  void PutReversedW(packed* dest, const packed* src);
-  void PutLineNormalW(packed* dest, uint8_t attr);
-  void PutLineReversedW(packed* dest, uint8_t attr);
+
+  // glyph cache
+  void InvalidateGlyphs() { glyph_valid_ = false; }
+  void ValidateGlyphs();
+  const packed* GetGlyph(uint8_t c, uint8_t a, bool wide);
+  void ComposeGlyph(packed* cell, const packed* src, uint8_t a, int width) const;
+  template <int width>
+  void BlitGlyph(packed* dest, const packed* src) const;
 
   IOBus* bus_ = nullptr;
   PD8257* dmac_ = nullptr;
@@ -213,12 +214,10 @@ class CRTC : public Device {
   uint32_t pcg_dat_ = 0;
 
   int bpl_ = 1;
-  packed pat_col_ = 0;
   // mask pattern
   packed pat_mask_ = 0;
   // reverse pattern
   packed pat_rev_ = 0;
-  int underline_ptr_ = 0;
 
   // font data for rendering for text/semi-graphics/wide-text
   // 8x8 image per character (TEXT_SET or TEXT_RES per char)
@@ -232,6 +231,21 @@ class CRTC : public Device {
   std::unique_ptr<uint8_t[]> pcgram_;
   // PC-8001mkIISR CGROM
   uint8_t* cg80rom_;
+
+  // 属性を適用済みの文字セル (直接マップのキャッシュ)
+  // キーはグリフ番号, 色・反転・上線・下線, 40 文字モードかどうか．
+  // 1 セルは kMaxCellLines 行 x 4 packed (80 文字モードは左の 2 packed だけ使う)
+  static constexpr int kGlyphSlotBits = 10;
+  static constexpr uint32_t kGlyphSlots = 1 << kGlyphSlotBits;
+  static constexpr uint32_t kMaxCellLines = 64;
+  std::unique_ptr<uint32_t[]> glyph_keys_;
+  std::unique_ptr<packed[]> glyph_cells_;
+  // セルを作ったときの lines_per_char_, line_char_limit_
+  uint32_t glyph_lines_per_char_ = 0;
+  uint32_t glyph_char_limit_ = 0;
+  // セルの行数
+  uint32_t glyph_lines_ = 0;
+  bool glyph_valid_ = false;
   std::unique_ptr<uint8_t[]> vram_;
   uint8_t* vram_ptr_[2] = {nullptr, nullptr};
   uint8_t* attrcache_ = nullptr;
@@ -239,6 +253,22 @@ class CRTC : public Device {
   // VRAM Cache のバンク
   uint32_t bank_ = 0;
 
+  // 行ごとの変化の検出
+  // row_hash_ は DMA で転送した各バンクの行 (文字 + アトリビュート) のハッシュ．
+  // row_state_ は最後に描いた時の行の状態で，すべて一致すれば行を展開しない
+  static constexpr uint32_t kMaxRows = 64;
+  struct RowState {
+    uint64_t hash;
+    uint32_t cursor;
+    uint8_t mode;
+    // 行の開始時・終了時の attr_
+    uint8_t attr_in;
+    uint8_t attr_out;
+    bool valid;
+  };
+  uint64_t row_hash_[2][kMaxRows]{};
+  RowState row_state_[kMaxRows]{};
+
   // 1画面のテキストサイズ
   // uint32_t tvramsize_;
   // 画面の幅
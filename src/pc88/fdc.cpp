@@ -35,6 +35,7 @@ FDC::~FDC() = default;
 bool FDC::Init(services::DiskManager* dm, Scheduler* s, IOBus* b, int ip, int sp) {
   disk_manager_ = dm;
   scheduler_ = s;
+  scheduler_->RegisterHandle(&timer_handle_);
   bus_ = b;
 
   pintr_ = ip;
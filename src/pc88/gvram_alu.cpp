@@ -0,0 +1,94 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  GVRAMALU
+
+#include "pc88/gvram_alu.h"
+
+namespace pc8801 {
+
+// ---------------------------------------------------------------------------
+//  書き込むビット q に対して
+//    reset:  g & ~q          clear
+//    set:    (g & ~q) ^ q    clear, xor
+//    invert: g ^ q           xor
+//    nop:    g
+//
+void GVRAMALU::SetOperation(uint32_t port34) {
+  static const uint8_t clear[4] = {0xff, 0xff, 0x00, 0x00};
+  static const uint8_t inv[4] = {0x00, 0xff, 0xff, 0x00};
+
+  clear_ = 0;
+  xor_ = 0;
+  for (int i = 0; i < 3; ++i) {
+    uint32_t op = (port34 >> i) & 0x11;
+    op = (op | op >> 3) & 3;
+    clear_ |= uint32_t(clear[op]) << (i * 8);
+    xor_ |= uint32_t(inv[op]) << (i * 8);
+  }
+}
+
+void GVRAMALU::SetMode(uint32_t port35) {
+  mode_ = Mode((port35 >> 4) & 3);
+  compare_ = 0;
+  for (int i = 0; i < 3; ++i) {
+    if (port35 & (1 << i))
+      compare_ |= 0xffU << (i * 8);
+  }
+}
+
+// ---------------------------------------------------------------------------
+//  まとめて書き込む
+//  方法ごとにループを分け，ループの中では分岐しない．
+//  gvram への書き込みがメンバを書き換えうるとみなされないよう，マスクは変数に移しておく
+//
+void GVRAMALU::Write(uint32_t* gvram, const uint8_t* data, uint32_t count) const {
+  switch (mode_) {
+    case kLogical: {
+      const uint32_t clear = clear_;
+      const uint32_t inv = xor_;
+      for (uint32_t i = 0; i < count; ++i) {
+        uint32_t q = data[i] * 0x010101U;
+        gvram[i] = (gvram[i] & ~(q & clear)) ^ (q & inv);
+      }
+      break;
+    }
+    default:
+      Fill(gvram, 0, count);
+      break;
+  }
+}
+
+void GVRAMALU::Fill(uint32_t* gvram, uint32_t data, uint32_t count) const {
+  switch (mode_) {
+    case kLogical: {
+      const uint32_t q = data * 0x010101;
+      const uint32_t c = ~(q & clear_);
+      const uint32_t x = q & xor_;
+      for (uint32_t i = 0; i < count; ++i)
+        gvram[i] = (gvram[i] & c) ^ x;
+      break;
+    }
+    case kCopyAll: {
+      const uint32_t latch = latch_;
+      for (uint32_t i = 0; i < count; ++i)
+        gvram[i] = latch;
+      break;
+    }
+    case kCopyRtoB: {
+      const uint32_t b = (latch_ >> 8) & 0xff;
+      for (uint32_t i = 0; i < count; ++i)
+        gvram[i] = (gvram[i] & ~0xffU) | b;
+      break;
+    }
+    case kCopyBtoR: {
+      const uint32_t r = (latch_ & 0xff) << 8;
+      for (uint32_t i = 0; i < count; ++i)
+        gvram[i] = (gvram[i] & ~0xff00U) | r;
+      break;
+    }
+  }
+}
+
+}  // namespace pc8801
@@ -0,0 +1,67 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  GVRAMALU
+//  V2 モードの GVRAM 書き込み用 ALU．
+//  GVRAM 1 バイト分の 3 プレーンを 32bit (b7-0: B, b15-8: R, b23-16: G) にまとめて扱う．
+//  Port34/35 が変わったときにプレーンごとの演算をマスクにしておき，
+//  1 回の読み書きは数回の 32bit 演算で済ませる
+//
+
+#pragma once
+
+#include <stdint.h>
+
+namespace pc8801 {
+
+class GVRAMALU {
+ public:
+  // Port35 b5-b4 (ALU Write Control)
+  enum Mode { kLogical = 0, kCopyAll, kCopyRtoB, kCopyBtoR };
+
+  GVRAMALU() = default;
+
+  // Port34: b0-b2/b4-b6 プレーンごとの演算 (00: reset, 01: set, 10: invert, 11: nop)
+  void SetOperation(uint32_t port34);
+  // Port35: b5-b4 書き込み方法, b2-b0 比較データ
+  void SetMode(uint32_t port35);
+
+  [[nodiscard]] Mode mode() const { return mode_; }
+  [[nodiscard]] uint32_t latch() const { return latch_; }
+
+  // GVRAM の値 g をラッチし，比較データと一致したビットを返す
+  uint32_t Read(uint32_t g) {
+    latch_ = g;
+    uint32_t t = g ^ compare_;
+    return ~(t | t >> 8 | t >> 16) & 0xff;
+  }
+
+  // 1 バイトの書き込み．g は書き込み先の GVRAM の値
+  [[nodiscard]] uint32_t WriteLogical(uint32_t g, uint32_t data) const {
+    uint32_t q = data * 0x010101;
+    return (g & ~(q & clear_)) ^ (q & xor_);
+  }
+  [[nodiscard]] uint32_t WriteCopyAll() const { return latch_; }
+  [[nodiscard]] uint32_t WriteCopyRtoB(uint32_t g) const {
+    return (g & ~0xffU) | ((latch_ >> 8) & 0xff);
+  }
+  [[nodiscard]] uint32_t WriteCopyBtoR(uint32_t g) const {
+    return (g & ~0xff00U) | ((latch_ & 0xff) << 8);
+  }
+
+  // gvram[0..count) に data[0..count) を順に書き込む (RAM からの LDIR 転送)
+  void Write(uint32_t* gvram, const uint8_t* data, uint32_t count) const;
+  // gvram[0..count) に data を書き込む (塗りつぶし)
+  void Fill(uint32_t* gvram, uint32_t data, uint32_t count) const;
+
+ private:
+  Mode mode_ = kLogical;
+  // 書き込むビットのうち，消すプレーンと反転するプレーン
+  uint32_t clear_ = 0;
+  uint32_t xor_ = 0;
+  uint32_t compare_ = 0;
+  uint32_t latch_ = 0;
+};
+
+}  // namespace pc8801
@@ -0,0 +1,133 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  GVRAMDirtyMap
+//  GVRAM 16 バイト (1 ブロック) ごとの書き換えフラグ．
+//  0x400 ブロックを 64bit 語 16 個のビットで持ち，さらに空でない語を summary に持つ．
+//  書き込み側はビットを立てるだけ，画面側は立っているビットだけを tzcnt でたどる
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace pc8801 {
+
+class GVRAMDirtyMap {
+ public:
+  static constexpr uint32_t kBlocks = 0x400;
+
+  // GVRAM のオフセット addr を含むブロックに印を付ける
+  void Set(uint32_t addr) {
+    uint32_t block = (addr >> 4) & (kBlocks - 1);
+    bits_[block >> 6] |= uint64_t(1) << (block & 63);
+    summary_ |= 1U << (block >> 6);
+  }
+  // オフセット [addr, addr + count) を含むブロックに印を付ける (count > 0)
+  void SetRange(uint32_t addr, uint32_t count) { Mark(addr >> 4, ((addr + count - 1) >> 4) + 1); }
+  void SetAll() { Mark(0, kBlocks); }
+
+  [[nodiscard]] bool Test(uint32_t block) const {
+    return (bits_[block >> 6] >> (block & 63)) & 1;
+  }
+
+  // [block, end) のうち最初に印の付いたブロック．なければ end
+  [[nodiscard]] uint32_t FindNext(uint32_t block, uint32_t end) const {
+    while (block < end) {
+      uint32_t w = block >> 6;
+      uint64_t bits = bits_[w] & (~uint64_t(0) << (block & 63));
+      if (bits) {
+        block = (w << 6) + std::countr_zero(bits);
+        return block < end ? block : end;
+      }
+      uint32_t rest = summary_ & (~1U << w);
+      if (!rest)
+        return end;
+      block = uint32_t(std::countr_zero(rest)) << 6;
+    }
+    return end;
+  }
+
+  // [begin, end) の印を消す
+  void Clear(uint32_t begin, uint32_t end) {
+    for (uint32_t block = begin; block < end;) {
+      uint32_t w = block >> 6;
+      uint32_t last = std::min(end, (w + 1) << 6);
+      bits_[w] &= ~RangeMask(block & 63, last - (w << 6));
+      if (!bits_[w])
+        summary_ &= ~(1U << w);
+      block = last;
+    }
+  }
+
+ private:
+  // 語の中のビット [first, last) (last <= 64)
+  static uint64_t RangeMask(uint32_t first, uint32_t last) {
+    uint64_t upper = last < 64 ? (uint64_t(1) << last) - 1 : ~uint64_t(0);
+    return upper & (~uint64_t(0) << first);
+  }
+
+  void Mark(uint32_t begin, uint32_t end) {
+    for (uint32_t block = begin; block < end;) {
+      uint32_t w = block >> 6;
+      uint32_t last = std::min(end, (w + 1) << 6);
+      bits_[w] |= RangeMask(block & 63, last - (w << 6));
+      summary_ |= 1U << w;
+      block = last;
+    }
+  }
+
+  uint64_t bits_[kBlocks / 64]{};
+  uint32_t summary_ = 0;
+};
+
+// ---------------------------------------------------------------------------
+//  書き換えられたブロックをたどる
+//  GVRAM の 1 行 (80 バイト) は 5 ブロック．ブロック i の行は i / 5，列は i % 5．
+//  320x200 の 2 画面モードでは second に 2 画面目のブロックの位置を渡し，
+//  どちらかが書き換えられていれば描く．たどったブロックの印は消す．
+//  書き換えられた行が続く範囲ごとに report を呼ぶ
+//
+struct DirtyRows {
+  int begin = -1;   // 最初の行 (なければ -1)
+  int end = -1;     // 最後の行
+  int columns = 0;  // 書き換えられた列 (b0-b4)
+};
+
+inline uint32_t FindDirty(const GVRAMDirtyMap& dirty, uint32_t i, uint32_t n, uint32_t second) {
+  uint32_t next = dirty.FindNext(i, n);
+  if (second)
+    next = std::min(next, dirty.FindNext(i + second, second + n) - second);
+  return next;
+}
+
+template <class F, class R>
+void ForEachDirtyBlock(GVRAMDirtyMap& dirty, int rows, uint32_t second, F draw, R report) {
+  const uint32_t n = rows * 5;
+  DirtyRows run;
+  for (uint32_t i = FindDirty(dirty, 0, n, second); i < n; i = FindDirty(dirty, i + 1, n, second)) {
+    int y = int(i / 5);
+    int x = int(i % 5);
+    if (run.begin >= 0 && y > run.end + 1) {
+      report(run);
+      run = DirtyRows();
+    }
+    if (run.begin < 0)
+      run.begin = y;
+    run.end = y;
+    run.columns |= 1 << x;
+    draw(y, x, i);
+  }
+  if (run.begin >= 0) {
+    report(run);
+    dirty.Clear(0, n);
+    if (second)
+      dirty.Clear(second, second + n);
+  }
+}
+
+}  // namespace pc8801
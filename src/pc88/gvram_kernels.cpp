@@ -0,0 +1,222 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  GVRAMKernels
+//
+//  GVRAM の 1 バイトを 8 画素に広げるには，バイトを 8 画素分複製し，
+//  画素ごとに 0x80, 0x40, ... 0x01 と AND を取って比較すればよい．
+//  SSE2 では unpack で複製して 2 バイト (16 画素) ずつ，
+//  AVX2 では pshufb で複製して 4 バイト (32 画素) ずつ処理する．
+//  SSE2 を必ず持つ x64 でのみ有効にする
+
+#include "pc88/gvram_kernels.h"
+
+#if defined(_M_X64) && !defined(_M_ARM64EC) || defined(__x86_64__)
+#define GVRAM_KERNELS_X64
+#endif
+
+#ifdef GVRAM_KERNELS_X64
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace pc8801 {
+
+#ifdef GVRAM_KERNELS_X64
+namespace {
+// ---------------------------------------------------------------------------
+//  SSE2
+//
+inline __m128i BitsSSE2() {
+  return _mm_setr_epi8(char(0x80), 0x40, 0x20, 0x10, 8, 4, 2, 1, char(0x80), 0x40, 0x20, 0x10, 8,
+                       4, 2, 1);
+}
+
+// 各 32bit の b7-0, b15-8, b23-16 をそれぞれ 8 バイトずつに複製する (src 2 個分)
+inline void SplatSSE2(__m128i x, __m128i* b, __m128i* r, __m128i* g) {
+  __m128i t = _mm_unpacklo_epi8(x, x);
+  __m128i lo = _mm_unpacklo_epi16(t, t);  // B0 x4, R0 x4, G0 x4, -
+  __m128i hi = _mm_unpackhi_epi16(t, t);  // B1 x4, R1 x4, G1 x4, -
+  __m128i u = _mm_unpacklo_epi32(lo, hi);
+  __m128i v = _mm_unpackhi_epi32(lo, hi);
+  *b = _mm_unpacklo_epi32(u, u);
+  *r = _mm_unpackhi_epi32(u, u);
+  *g = _mm_unpacklo_epi32(v, v);
+}
+
+// 画素ごとに対応するビットが立っていれば 0xff
+inline __m128i TestSSE2(__m128i x, __m128i bits) {
+  return _mm_cmpeq_epi8(_mm_and_si128(x, bits), bits);
+}
+
+void ColorSSE2(uint8_t* dest, const uint32_t* src) {
+  const __m128i bits = BitsSSE2();
+  const __m128i keep = _mm_set1_epi8(0x0f);
+  const __m128i bset = _mm_set1_epi8(0x10);
+  const __m128i rset = _mm_set1_epi8(0x20);
+  const __m128i gsel = _mm_set1_epi8(char(0xc0));
+  const __m128i gres = _mm_set1_epi8(0x40);
+
+  for (int k = 0; k < 16; k += 2, dest += 16) {
+    __m128i b, r, g;
+    SplatSSE2(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + k)), &b, &r, &g);
+    __m128i pix = _mm_or_si128(_mm_and_si128(TestSSE2(b, bits), bset),
+                               _mm_and_si128(TestSSE2(r, bits), rset));
+    pix = _mm_or_si128(pix, _mm_xor_si128(_mm_and_si128(TestSSE2(g, bits), gsel), gres));
+
+    auto* d = reinterpret_cast<__m128i*>(dest);
+    _mm_storeu_si128(d, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(d), keep), pix));
+  }
+}
+
+void MonoSSE2(uint8_t* dest, const uint32_t* src, uint32_t mask) {
+  const __m128i bits = BitsSSE2();
+  const __m128i keep = _mm_set1_epi8(char(~0x20));
+  const __m128i set = _mm_set1_epi8(0x20);
+  const __m128i m = _mm_set1_epi32(int(mask));
+
+  for (int k = 0; k < 16; k += 4, dest += 32) {
+    // 4 個分の B|R|G を各 32bit の b7-0 に集める
+    __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k)), m);
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 8));
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 16));
+
+    __m128i b0, b1, unused;
+    SplatSSE2(a, &b0, &unused, &unused);
+    SplatSSE2(_mm_srli_si128(a, 8), &b1, &unused, &unused);
+
+    auto* d = reinterpret_cast<__m128i*>(dest);
+    __m128i pix = _mm_and_si128(TestSSE2(b0, bits), set);
+    _mm_storeu_si128(d, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(d), keep), pix));
+    pix = _mm_and_si128(TestSSE2(b1, bits), set);
+    _mm_storeu_si128(d + 1, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(d + 1), keep), pix));
+  }
+}
+
+// ---------------------------------------------------------------------------
+//  AVX2
+//  128bit の src 4 個分を両方のレーンに置き，pshufb で 1 プレーンずつ取り出す
+//
+TARGET_AVX2 inline __m256i BitsAVX2() {
+  return _mm256_broadcastsi128_si256(BitsSSE2());
+}
+
+// 下位レーンに src 0, 1，上位レーンに src 2, 3 の b7-0 を 8 バイトずつ並べる
+TARGET_AVX2 inline __m256i IndexAVX2() {
+  return _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 4, 4, 4, 4, 4, 4, 4, 4, 8, 8, 8, 8, 8, 8, 8, 8,
+                          12, 12, 12, 12, 12, 12, 12, 12);
+}
+
+TARGET_AVX2 inline __m256i TestAVX2(__m256i x, __m256i bits) {
+  return _mm256_cmpeq_epi8(_mm256_and_si256(x, bits), bits);
+}
+
+TARGET_AVX2 void ColorAVX2(uint8_t* dest, const uint32_t* src) {
+  const __m256i bits = BitsAVX2();
+  const __m256i bidx = IndexAVX2();
+  const __m256i ridx = _mm256_add_epi8(bidx, _mm256_set1_epi8(1));
+  const __m256i gidx = _mm256_add_epi8(bidx, _mm256_set1_epi8(2));
+  const __m256i keep = _mm256_set1_epi8(0x0f);
+  const __m256i bset = _mm256_set1_epi8(0x10);
+  const __m256i rset = _mm256_set1_epi8(0x20);
+  const __m256i gsel = _mm256_set1_epi8(char(0xc0));
+  const __m256i gres = _mm256_set1_epi8(0x40);
+
+  for (int k = 0; k < 16; k += 4, dest += 32) {
+    __m256i x = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k)));
+    __m256i b = TestAVX2(_mm256_shuffle_epi8(x, bidx), bits);
+    __m256i r = TestAVX2(_mm256_shuffle_epi8(x, ridx), bits);
+    __m256i g = TestAVX2(_mm256_shuffle_epi8(x, gidx), bits);
+    __m256i pix = _mm256_or_si256(_mm256_and_si256(b, bset), _mm256_and_si256(r, rset));
+    pix = _mm256_or_si256(pix, _mm256_xor_si256(_mm256_and_si256(g, gsel), gres));
+
+    auto* d = reinterpret_cast<__m256i*>(dest);
+    _mm256_storeu_si256(d, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(d), keep), pix));
+  }
+}
+
+TARGET_AVX2 void MonoAVX2(uint8_t* dest, const uint32_t* src, uint32_t mask) {
+  const __m256i bits = BitsAVX2();
+  const __m256i idx = IndexAVX2();
+  const __m256i keep = _mm256_set1_epi8(char(~0x20));
+  const __m256i set = _mm256_set1_epi8(0x20);
+  const __m128i m = _mm_set1_epi32(int(mask));
+
+  for (int k = 0; k < 16; k += 4, dest += 32) {
+    __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k)), m);
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 8));
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 16));
+    __m256i x = TestAVX2(_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(a), idx), bits);
+
+    auto* d = reinterpret_cast<__m256i*>(dest);
+    __m256i pix = _mm256_and_si256(x, set);
+    _mm256_storeu_si256(d, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(d), keep), pix));
+  }
+}
+
+// ---------------------------------------------------------------------------
+//  CPU の機能を調べる
+//
+bool HasAVX2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  // OS が YMM レジスタを保存するか
+  __cpuid(info, 1);
+  if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+    return false;
+  if ((_xgetbv(0) & 6) != 6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+constexpr GVRAMKernels kSSE2Kernels = {ColorSSE2, MonoSSE2, GVRAMKernels::kSSE2, "SSE2"};
+constexpr GVRAMKernels kAVX2Kernels = {ColorAVX2, MonoAVX2, GVRAMKernels::kAVX2, "AVX2"};
+}  // namespace
+#endif  // GVRAM_KERNELS_X64
+
+namespace {
+constexpr GVRAMKernels kNoKernels = {nullptr, nullptr, GVRAMKernels::kNone, "table"};
+}  // namespace
+
+const GVRAMKernels* GetGVRAMKernels(GVRAMKernels::Type type) {
+  switch (type) {
+#ifdef GVRAM_KERNELS_X64
+    case GVRAMKernels::kSSE2:
+      return &kSSE2Kernels;
+    case GVRAMKernels::kAVX2:
+      return HasAVX2() ? &kAVX2Kernels : nullptr;
+#endif
+    case GVRAMKernels::kNone:
+      return &kNoKernels;
+    default:
+      return nullptr;
+  }
+}
+
+const GVRAMKernels& GetGVRAMKernels() {
+  static const GVRAMKernels* best = [] {
+    static const GVRAMKernels::Type order[] = {GVRAMKernels::kAVX2, GVRAMKernels::kSSE2};
+    for (auto type : order) {
+      if (const GVRAMKernels* k = GetGVRAMKernels(type))
+        return k;
+    }
+    return &kNoKernels;
+  }();
+  return *best;
+}
+
+}  // namespace pc8801
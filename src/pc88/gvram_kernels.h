@@ -0,0 +1,34 @@
+// ---------------------------------------------------------------------------
+// M88 - PC8801 Series Emulator
+// Copyright (C) by cisc 1998, 2003.
+// ---------------------------------------------------------------------------
+//  GVRAMKernels
+//  GVRAM の 1 ブロック (16 バイト = 128 ドット) を画面イメージの画素に展開する SIMD 版の関数．
+//  src は Memory::Quadbyte 16 個 (b7-0: B, b15-8: R, b23-16: G)，dest は 128 画素．
+//  画素の 7 ドット目が src の b0 に対応する．
+//  使える命令セットは実行時に調べ，どれも使えなければ Screen はテーブルで展開する
+//
+
+#pragma once
+
+#include <stdint.h>
+
+namespace pc8801 {
+
+struct GVRAMKernels {
+  enum Type { kNone = 0, kSSE2, kAVX2 };
+
+  // カラー: dest の b7-b4 を B=0x10, R=0x20, G=0x80 (G が 0 なら 0x40) で置き換える
+  void (*color)(uint8_t* dest, const uint32_t* src);
+  // 白黒: (B|R|G) & mask が 1 のドットで dest の b5 を立て，0 なら落とす
+  void (*mono)(uint8_t* dest, const uint32_t* src, uint32_t mask);
+  Type type;
+  const char* name;
+};
+
+// 実行中の CPU で使える最も速い実装 (SIMD が使えなければ type == kNone)
+const GVRAMKernels& GetGVRAMKernels();
+// type の実装．この CPU で使えなければ nullptr
+const GVRAMKernels* GetGVRAMKernels(GVRAMKernels::Type type);
+
+}  // namespace pc8801
@@ -29,7 +29,7 @@ Memory::~Memory() {
     mm->Disconnect(mid);
 }
 
-bool Memory::Init(MemoryManager* _mm, IOBus* _bus, CRTC* _crtc, int* wt) {
+bool Memory::Init(MemoryManager* _mm, IOBus* _bus, CRTC* _crtc, uint8_t* wt) {
   mm = _mm;
   bus = _bus;
   crtc = _crtc;
@@ -249,31 +249,7 @@ void Memory::Out34(uint32_t, uint32_t data) {
     return;
 
   port34 = data;
-  for (int i = 0; i < 3; ++i) {
-    switch (data & 0x11) {
-      case 0x00:
-        maskr.byte[i] = 0xff;
-        masks.byte[i] = 0x00;
-        maski.byte[i] = 0x00;
-        break;
-      case 0x01:
-        maskr.byte[i] = 0x00;
-        masks.byte[i] = 0xff;
-        maski.byte[i] = 0x00;
-        break;
-      case 0x10:
-        maskr.byte[i] = 0x00;
-        masks.byte[i] = 0x00;
-        maski.byte[i] = 0xff;
-        break;
-      case 0x11:
-        maskr.byte[i] = 0x00;
-        masks.byte[i] = 0x00;
-        maski.byte[i] = 0x00;
-        break;
-    }
-    data >>= 1;
-  }
+  alu_.SetOperation(data);
 }
 
 // ----------------------------------------------------------------------------
@@ -287,9 +263,7 @@ void Memory::Out35(uint32_t, uint32_t data) {
     return;
 
   port35 = data;
-  aluread.byte[0] = (data & 1) ? 0xff : 0x00;
-  aluread.byte[1] = (data & 2) ? 0xff : 0x00;
-  aluread.byte[2] = (data & 4) ? 0xff : 0x00;
+  alu_.SetMode(data);
 
   if (data & 0x80) {
     port5x = 3;
@@ -764,28 +738,22 @@ void Memory::SelectGVRAM(uint32_t gvtop) {
 // ----------------------------------------------------------------------------
 //  GVRAM の読み書き
 //
-#define SETDIRTY(addr)      \
-  if (m->dirty_[addr >> 4]) \
-    return;                 \
-  else                      \
-    m->dirty_[addr >> 4] = 1;
-
 void Memory::WrGVRAM0(void* inst, uint32_t addr, uint32_t data) {
   Memory* m = static_cast<Memory*>(inst);
   m->gvram_[addr &= 0x3fff].byte[0] = data;
-  SETDIRTY(addr);
+  m->dirty_.Set(addr);
 }
 
 void Memory::WrGVRAM1(void* inst, uint32_t addr, uint32_t data) {
   Memory* m = static_cast<Memory*>(inst);
   m->gvram_[addr &= 0x3fff].byte[1] = data;
-  SETDIRTY(addr);
+  m->dirty_.Set(addr);
 }
 
 void Memory::WrGVRAM2(void* inst, uint32_t addr, uint32_t data) {
   Memory* m = static_cast<Memory*>(inst);
   m->gvram_[addr &= 0x3fff].byte[2] = data;
-  SETDIRTY(addr);
+  m->dirty_.Set(addr);
 }
 
 uint32_t Memory::RdGVRAM0(void* inst, uint32_t addr) {
@@ -810,7 +778,7 @@ void Memory::SelectALU(uint32_t gvtop) {
   static const MemoryBus::WriteFuncPtr funcs[4] = {WrALUSet, WrALURGB, WrALUB, WrALUR};
 
   mm->AllocR(mid, gvtop, 0x4000, RdALU);
-  mm->AllocW(mid, gvtop, 0x4000, funcs[(port35 >> 4) & 3]);
+  mm->AllocW(mid, gvtop, 0x4000, funcs[(port35 >> 4) & 3], WrALUBlock);
 
   if (!selgvram) {
     selgvram = true;
@@ -824,39 +792,52 @@ void Memory::SelectALU(uint32_t gvtop) {
 //
 uint32_t Memory::RdALU(void* inst, uint32_t addr) {
   Memory* m = static_cast<Memory*>(inst);
-  m->alureg = m->gvram_[addr & 0x3fff];
-  Quadbyte q(m->alureg.pack ^ m->aluread.pack);
-  return ~(q.byte[0] | q.byte[1] | q.byte[2]) & 0xff;
+  return m->alu_.Read(m->gvram_[addr & 0x3fff].pack);
 }
 
 void Memory::WrALUSet(void* inst, uint32_t addr, uint32_t data) {
   Memory* m = static_cast<Memory*>(inst);
-
-  // data &= 255;
-  Quadbyte q((data << 16) | (data << 8) | data);
-  addr &= 0x3fff;
-  m->gvram_[addr].pack =
-      ((m->gvram_[addr].pack & ~(q.pack & m->maskr.pack)) | (q.pack & m->masks.pack)) ^
-      (q.pack & m->maski.pack);
-  SETDIRTY(addr);
+  uint32_t& g = m->gvram_[addr &= 0x3fff].pack;
+  g = m->alu_.WriteLogical(g, data);
+  m->dirty_.Set(addr);
 }
 
 void Memory::WrALURGB(void* inst, uint32_t addr, uint32_t) {
   Memory* m = static_cast<Memory*>(inst);
-  m->gvram_[addr &= 0x3fff] = m->alureg;
-  SETDIRTY(addr);
+  m->gvram_[addr &= 0x3fff].pack = m->alu_.WriteCopyAll();
+  m->dirty_.Set(addr);
 }
 
 void Memory::WrALUR(void* inst, uint32_t addr, uint32_t) {
   Memory* m = static_cast<Memory*>(inst);
-  m->gvram_[addr &= 0x3fff].byte[1] = m->alureg.byte[0];
-  SETDIRTY(addr);
+  uint32_t& g = m->gvram_[addr &= 0x3fff].pack;
+  g = m->alu_.WriteCopyBtoR(g);
+  m->dirty_.Set(addr);
 }
 
 void Memory::WrALUB(void* inst, uint32_t addr, uint32_t) {
   Memory* m = static_cast<Memory*>(inst);
-  m->gvram_[addr &= 0x3fff].byte[0] = m->alureg.byte[1];
-  SETDIRTY(addr);
+  uint32_t& g = m->gvram_[addr &= 0x3fff].pack;
+  g = m->alu_.WriteCopyRtoB(g);
+  m->dirty_.Set(addr);
+}
+
+// ----------------------------------------------------------------------------
+//  ALU を通した GVRAM へのまとめ書き (RAM からの LDIR/LDDR 転送用)
+//  addr は GVRAM 内のオフセット．0x4000 を越えた分は先頭に戻る
+//
+void Memory::WriteALU(uint32_t addr, const uint8_t* data, uint32_t count) {
+  while (count) {
+    addr &= 0x3fff;
+    uint32_t n = std::min(count, 0x4000 - addr);
+    alu_.Write(&gvram_[addr].pack, data, n);
+    dirty_.SetRange(addr, n);
+    addr += n, data += n, count -= n;
+  }
+}
+
+void Memory::WrALUBlock(void* inst, uint32_t addr, const uint8_t* data, uint32_t count) {
+  static_cast<Memory*>(inst)->WriteALU(addr, data, count);
 }
 
 // ----------------------------------------------------------------------------
@@ -867,7 +848,6 @@ bool Memory::InitMemory() {
   ram_ = std::make_unique<uint8_t[]>(0x10000);
   tvram_ = std::make_unique<uint8_t[]>(0x1000);
   gvram_ = std::make_unique<Quadbyte[]>(0x4000);
-  dirty_ = std::make_unique<uint8_t[]>(0x400);
 
   if (!(rom_.get() && ram_.get() && tvram_.get())) {
     Error::SetError(Error::OutOfMemory);
@@ -875,7 +855,7 @@ bool Memory::InitMemory() {
   }
   SetRAMPattern(ram_.get(), 0x10000);
   memset(gvram_.get(), 0, sizeof(Quadbyte) * 0x4000);
-  memset(dirty_.get(), 1, 0x400);
+  dirty_.SetAll();
   memset(tvram_.get(), 0, 0x1000);
 
   ram_[0xff33] = 0;  // PACMAN 対策
@@ -1018,7 +998,7 @@ inline void Memory::SetWaits(uint32_t a, uint32_t s, uint32_t v) {
     uint32_t p = a >> MemoryManager::pagebits;
     uint32_t t = (a + s + MemoryManager::pagemask) >> MemoryManager::pagebits;
     for (; p < t; p++)
-      waits[p] = v;
+      waits[p] = uint8_t(v);
   }
 }
 
@@ -1079,7 +1059,7 @@ bool Memory::LoadStatus(const uint8_t* s) {
   for (int i = 0; i < 3; i++)
     for (int j = 0; j < 0x4000; j++)
       gvram_[j].byte[i] = status->gvram[i][j];
-  memset(dirty_.get(), 1, 0x400);
+  dirty_.SetAll();
   memcpy(eram_.get(), status->eram, 0x8000 * erambanks);
   return true;
 }
@@ -12,6 +12,8 @@
 
 #include "common/device.h"
 #include "pc88/config.h"
+#include "pc88/gvram_alu.h"
+#include "pc88/gvram_dirty.h"
 
 class IOBus;
 class MemoryManager;
@@ -96,7 +98,10 @@ class Memory : public Device, public IGetMemoryBank {
   uint8_t* GetROM() { return rom_.get(); }
   [[nodiscard]] bool HasEROM(int b) const { return (erom_mask_ & (1 << b)) == 0; }
   uint8_t* GetEROM(int b) { return erom_[b]; }
-  uint8_t* GetDirtyFlag() { return dirty_.get(); }
+  GVRAMDirtyMap& GetDirtyMap() { return dirty_; }
+
+  // ALU を通して GVRAM (オフセット addr から count バイト) にまとめて書き込む
+  void WriteALU(uint32_t addr, const uint8_t* data, uint32_t count);
 
   // Overrides for class IGetMemoryBank
   uint32_t IFCALL GetRdBank(uint32_t addr) override;
@@ -111,7 +116,7 @@ class Memory : public Device, public IGetMemoryBank {
   bool IsN80V2Ready() { return !!n80v2rom_; }
   bool IsCDBIOSReady() { return !!cdbios_; }
 
-  bool Init(MemoryManager* mgr, IOBus* bus, CRTC* crtc, int* waittbl);
+  bool Init(MemoryManager* mgr, IOBus* bus, CRTC* crtc, uint8_t* waittbl);
   void IOCALL Reset(uint32_t, uint32_t);
   void IOCALL Out31(uint32_t, uint32_t data);
   void IOCALL Out32(uint32_t, uint32_t data);
@@ -180,7 +185,7 @@ class Memory : public Device, public IGetMemoryBank {
 
   MemoryManager* mm = nullptr;
   int mid = -1;
-  int* waits = nullptr;
+  uint8_t* waits = nullptr;
   IOBus* bus = nullptr;
   CRTC* crtc = nullptr;
 
@@ -228,14 +233,10 @@ class Memory : public Device, public IGetMemoryBank {
   uint8_t* w00_ = nullptr;
   uint8_t* rc0_ = nullptr;
 
-  Quadbyte alureg = 0;
-  Quadbyte maskr = 0;
-  Quadbyte maski = 0;
-  Quadbyte masks = 0;
-  Quadbyte aluread = 0;
+  GVRAMALU alu_;
 
   std::unique_ptr<Quadbyte[]> gvram_;
-  std::unique_ptr<uint8_t[]> dirty_;
+  GVRAMDirtyMap dirty_;
 
   static const WaitDesc waittable[48];
 
@@ -253,6 +254,8 @@ class Memory : public Device, public IGetMemoryBank {
   static void WrALURGB(void* inst, uint32_t addr, uint32_t data);
   static void WrALUR(void* inst, uint32_t addr, uint32_t data);
   static void WrALUB(void* inst, uint32_t addr, uint32_t data);
+  // WrALU* のページへのブロック転送
+  static void WrALUBlock(void* inst, uint32_t addr, const uint8_t* data, uint32_t count);
   static uint32_t RdALU(void* inst, uint32_t addr);
 
   static const Descriptor descriptor;
@@ -221,6 +221,8 @@ void OPNIF::ApplyConfig(const Config* config) {
 //  Reset
 //
 void OPNIF::Reset(uint32_t, uint32_t) {
+  if (speculative_)
+    return;
   memset(regs_, 0, sizeof(regs_));
 
   regs_[0x29] = 0x1f;
@@ -260,9 +262,24 @@ inline void OPNUnit::SetIntrMask(bool en) {
     bus_->Out(pintr_, true);
 }
 
+// ---------------------------------------------------------------------------
+//  タイマーの保存と復元
+//
+void OPNUnit::SaveTimer(TimerState* state) {
+  Timer::SaveState(&state->counts);
+  state->status = ReadStatus();
+}
+
+void OPNUnit::RestoreTimer(const TimerState& state) {
+  Timer::RestoreState(state.counts);
+  // フラグを立てるのはタイマーだけなので，保存後に立ったものを下ろす
+  if (uint32_t raised = ReadStatus() & ~state.status)
+    ResetStatus(raised);
+}
+
 void OPNIF::SetIntrMask(uint32_t port, uint32_t intrmask) {
   //  Log("Intr enabled (%.2x)[%.2x]\n", a, intrmask);
-  if (port == is_mask_port_) {
+  if (port == is_mask_port_ && !speculative_) {
     opn_.SetIntrMask(!(is_mask_bit_ & intrmask));
     ym_.SetIntrMask(!(is_mask_bit_ & intrmask));
   }
@@ -274,7 +291,7 @@ void OPNIF::SetIntrMask(uint32_t port, uint32_t intrmask) {
 void OPNIF::SetIndex0(uint32_t a, uint32_t data) {
   //  Log("Index0[%.2x] = %.2x\n", a, data);
   index0_ = data;
-  if (enable_ && (data & 0xfc) == 0x2c) {
+  if (enable_ && !speculative_ && (data & 0xfc) == 0x2c) {
     regs_[0x2f] = 1;
     prescaler = data;
     opn_.SetReg(data, 0);
@@ -300,7 +317,9 @@ inline uint32_t OPNIF::ChipTime() {
 //
 void OPNIF::WriteData0(uint32_t a, uint32_t data) {
   //  Log("Write0[%.2x] = %.2x\n", a, data);
-  if (enable_) {
+  if (enable_ && speculative_) {
+    regs_[index0_] = data;
+  } else if (enable_) {
     Log("%.16x:OPN[0%.2x] = %.2x\n", scheduler_->GetTimeNS(), index0_, data);
     if (index0_ == 0x28) {
       Log("%.16x:KeyOnOff = %.2x\n", scheduler_->GetTimeNS(), data);
@@ -333,7 +352,10 @@ void OPNIF::WriteData0(uint32_t a, uint32_t data) {
 
 void OPNIF::WriteData1(uint32_t a, uint32_t data) {
   //  Log("Write1[%.2x] = %.2x\n", a, data);
-  if (enable_ && opna_mode_) {
+  if (enable_ && opna_mode_ && speculative_) {
+    data1_ = data;
+    regs_[0x100 | index1_] = data;
+  } else if (enable_ && opna_mode_) {
     Log("%.16x:OPN[1%.2x] = %.2x\n", scheduler_->GetTimeNS(), index1_, data);
     if (index1_ != 0x08 && index1_ != 0x10)
       TimeEvent(0);
@@ -435,6 +457,36 @@ void OPNIF::TimeEvent(uint32_t e) {
   }
 }
 
+// ---------------------------------------------------------------------------
+//  投機的な実行
+//  音源には書き込まないので，レジスタの写しとタイマーを戻すだけでよい．
+//  タイマーのイベントは Scheduler::RestoreState で戻る
+//
+void OPNIF::SetSpeculative(bool speculative) {
+  if (speculative == speculative_)
+    return;
+  speculative_ = speculative;
+  if (speculative) {
+    checkpoint_.index0 = index0_;
+    checkpoint_.index1 = index1_;
+    checkpoint_.data1 = data1_;
+    memcpy(checkpoint_.regs, regs_, sizeof(regs_));
+    checkpoint_.next_count = next_count_;
+    checkpoint_.prev_time_ns = prev_time_ns_;
+    opn_.SaveTimer(&checkpoint_.opn_timer);
+    ym_.SaveTimer(&checkpoint_.ym_timer);
+  } else {
+    index0_ = checkpoint_.index0;
+    index1_ = checkpoint_.index1;
+    data1_ = checkpoint_.data1;
+    memcpy(regs_, checkpoint_.regs, sizeof(regs_));
+    next_count_ = checkpoint_.next_count;
+    prev_time_ns_ = checkpoint_.prev_time_ns;
+    opn_.RestoreTimer(checkpoint_.opn_timer);
+    ym_.RestoreTimer(checkpoint_.ym_timer);
+  }
+}
+
 // ---------------------------------------------------------------------------
 //  状態のサイズ
 //
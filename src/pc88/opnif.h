@@ -35,6 +35,14 @@ class OPNUnit : public fmgen::OPNA {
     return (intr_enabled_ ? 1 : 0) | (intr_pending_ ? 2 : 0);
   }
 
+  // タイマーの状態 (投機的な実行の取り消し用)
+  struct TimerState {
+    fmgen::Timer::State counts;
+    uint32_t status;
+  };
+  void SaveTimer(TimerState* state);
+  void RestoreTimer(const TimerState& state);
+
  private:
   IOBus* bus_ = nullptr;
   int pintr_ = 0;
@@ -89,6 +97,9 @@ class OPNIF : public Device, public ISoundSource {
   void SetOPNMode(bool _opna) { opna_mode_ = _opna; }
   const uint8_t* GetRegs() const { return regs_; }
   void SetChannelMask(uint32_t mask);
+  // 投機的な実行 (run-ahead) の間はレジスタへの書き込みを音源に送らず，
+  // 終わったときに書き込みとタイマーの変化を取り消す
+  void SetSpeculative(bool speculative);
 
   void IOCALL SetIntrMask(uint32_t, uint32_t intrmask);
   void IOCALL Reset(uint32_t = 0, uint32_t = 0);
@@ -159,6 +170,20 @@ class OPNIF : public Device, public ISoundSource {
 
   uint8_t regs_[0x200]{};
 
+  // 投機的な実行を始める前の状態
+  struct Checkpoint {
+    uint32_t index0;
+    uint32_t index1;
+    uint32_t data1;
+    uint8_t regs[0x200];
+    int32_t next_count;
+    int64_t prev_time_ns;
+    OPNUnit::TimerState opn_timer;
+    YMFMInterface::TimerState ym_timer;
+  };
+  bool speculative_ = false;
+  Checkpoint checkpoint_{};
+
   //  プリスケーラの設定値
   //  static にするのは，FMGen の制限により，複数の OPN を異なるクロックに
   //  することが出来ないため．
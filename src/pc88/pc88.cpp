@@ -40,6 +40,16 @@
 
 using namespace pc8801;
 
+namespace {
+// 投機的な実行の前後で保存・復元しないデバイス
+// OPN は投機中の書き込みを自分で取り消す．CMT は復元にテープの走査が必要
+constexpr IDevice::ID kSpeculationSkip[] = {
+    DEV_ID('O', 'P', 'N', '1'),
+    DEV_ID('O', 'P', 'N', '2'),
+    DEV_ID('C', 'M', 'T', '0'),
+};
+}  // namespace
+
 // ---------------------------------------------------------------------------
 //  構築・破棄
 //
@@ -109,20 +119,28 @@ void PC88::DeInit() {
 //  実行
 //
 int64_t SchedulerImpl::ExecuteNS(int64_t ns) {
-  int64_t clocks = std::max(1LL, (int64_t)cpu_clock_ * ns / 1000000000LL);
-  int64_t ns_per_clock = 1000000000LL / (int64_t)cpu_clock_;
-  return pc_->Execute(clocks) * ns_per_clock;
+  int64_t clocks = std::max<int64_t>(1, clock_.NSToClocks(ns));
+  return clock_.ClocksToNS(pc_->Execute(clocks));
 }
 
 int64_t PC88::Execute(int64_t clocks) {
   LOADBEGIN("Core.CPU");
   int64_t ex = 0;
-  if (!(cpu_mode_ & stopwhenidle) || subsys_->IsBusy() || fdc_->IsBusy()) {
-    if ((cpu_mode_ & 1) == ms11)
-      ex = Z80XX::ExecDual(&main_cpu_, &sub_cpu_, clocks);
-    else
-      ex = Z80XX::ExecDual2(&main_cpu_, &sub_cpu_, clocks);
+  // サブ CPU がコマンド待ちで止まっている間はメイン CPU だけを実行する
+  bool idle = (cpu_mode_ & stopwhenwaiting) &&
+              subsys_->IsWaiting(sub_cpu_.GetPC(), sub_cpu_.GetReg(), sub_cpu_.MemEffects());
+  if (cpu_mode_ & stopwhenidle)
+    idle = !subsys_->IsBusy() || idle;
+  // 投機中にサブシステムがコマンドを受け取ったら，ディスクに触れないようにサブ CPU を止める
+  if (speculative_ && subsys_->IsBusy())
+    idle = true;
+  else if (fdc_->IsBusy())
+    idle = false;
+  if (!idle) {
+    ex = exec_dual_(&main_cpu_, &sub_cpu_, clocks);
   } else {
+    // 実行しないサブ CPU のクロックは現在のクロック比で進める
+    sub_cpu_.SetClockShift(cpu_mode_ & 1);
     ex = Z80XX::ExecSingle(&main_cpu_, &sub_cpu_, clocks);
   }
   LOADEND("Core.CPU");
@@ -133,12 +151,11 @@ int64_t PC88::Execute(int64_t clocks) {
 //  実行クロック数変更
 //
 void SchedulerImpl::ShortenNS(int64_t ns) {
-  // int64 nanos_per_clock = 10000LL / clocks_per_tick_;
-  Z80XX::StopDual(int(ns * cpu_clock_ / 1000000000LL));
+  Z80XX::StopDual(int(clock_.NSToClocks(ns)));
 }
 
 int64_t SchedulerImpl::GetNS() {
-  return Z80XX::GetCCount() * (1000000000LL / cpu_clock_);
+  return clock_.ClocksToNS(Z80XX::GetCCount());
 }
 
 // ---------------------------------------------------------------------------
@@ -219,6 +236,48 @@ uint64_t PC88::GetFramePeriodNS() {
   return crtc_ ? crtc_->GetFramePeriodNS() : kNanoSecsPerSec / 60;
 }
 
+// ---------------------------------------------------------------------------
+//  投機的な実行 (run-ahead)
+//  状態をメモリに保存し，EndSpeculation で元に戻す．
+//  サブシステムも状態を保存して普段どおり動かす．OPN への書き込みは音源に送らない．
+//  ディスクへの書き込みは元に戻せないので，サブシステムがコマンドを処理している間や
+//  ディスク・テープが動いている間は行わない．
+//
+bool PC88::BeginSpeculation() {
+  if (speculative_ || subsys_->IsBusy() || fdc_->IsBusy() || cmt_->IsMotorOn())
+    return false;
+
+  // バッファは使い回すので，構成が変わらなければメモリを確保しない
+  spec_status_.resize(devlist_.GetStatusSize(kSpeculationSkip));
+  if (!devlist_.SaveStatus(spec_status_.data(), kSpeculationSkip))
+    return false;
+  scheduler_.SaveState(&spec_scheduler_);
+  spec_main_clocks_ = main_cpu_.GetClocks();
+  spec_sub_clocks_ = sub_cpu_.GetClocks();
+
+  speculative_ = true;
+  opn1_->SetSpeculative(true);
+  opn2_->SetSpeculative(true);
+  return true;
+}
+
+void PC88::EndSpeculation() {
+  if (!speculative_)
+    return;
+  // LoadStatus でイベントを登録し直すデバイスがあるので，その間はイベントを変えずに，
+  // 最後に保存したイベントとハンドルに戻す
+  scheduler_.HoldEvents(true);
+  devlist_.LoadStatus(spec_status_.data());
+  scheduler_.HoldEvents(false);
+  scheduler_.RestoreState(spec_scheduler_);
+  main_cpu_.SetClocks(spec_main_clocks_);
+  sub_cpu_.SetClocks(spec_sub_clocks_);
+
+  opn1_->SetSpeculative(false);
+  opn2_->SetSpeculative(false);
+  speculative_ = false;
+}
+
 // ---------------------------------------------------------------------------
 //  リセット
 //
@@ -284,10 +343,10 @@ bool PC88::ConnectDevices() {
 
   static const IOBus::Connector c_base[] = {{kPReset, IOBus::portout, Base::reset},
                                             {kVrtc, IOBus::portout, Base::vrtc},
-                                            {0x30, IOBus::portin, Base::in30},
-                                            {0x31, IOBus::portin, Base::in31},
-                                            {0x40, IOBus::portin, Base::in40},
-                                            {0x6e, IOBus::portin, Base::in6e},
+                                            {0x30, IOBus::portin | IOBus::pure, Base::in30},
+                                            {0x31, IOBus::portin | IOBus::pure, Base::in31},
+                                            {0x40, IOBus::portin | IOBus::pure, Base::in40},
+                                            {0x6e, IOBus::portin | IOBus::pure, Base::in6e},
                                             {0, 0, 0}};
   base_ = std::make_unique<pc8801::Base>(DEV_ID('B', 'A', 'S', 'E'));
   if (!base_ || !main_iobus_.Connect(base_.get(), c_base))
@@ -352,6 +411,7 @@ bool PC88::ConnectDevices() {
     return false;
   if (!mem_main_->Init(&main_mm_, &main_iobus_, crtc_.get(), main_cpu_.GetWaits()))
     return false;
+  main_cpu_.GetProfiler()->SetMemoryBank(mem_main_.get());
 
   // TODO: CRTC is dependent on DMAC's object lifetime. (do not pass unique_ptr here)
   if (!crtc_->Init(&main_iobus_, &scheduler_, dmac_.get()))
@@ -443,7 +503,7 @@ bool PC88::ConnectDevices() {
   static const IOBus::Connector c_tape[] = {{kPSIOReq, IOBus::portout, CMT::kRequestData},
                                             {kTapeOpen, IOBus::portout, CMT::kTapeOpen},
                                             {0x30, IOBus::portout, CMT::kOut30},
-                                            {0x40, IOBus::portin, CMT::kIn40},
+                                            {0x40, IOBus::portin | IOBus::pure, CMT::kIn40},
                                             {0, 0, 0}};
   cmt_ = std::make_unique<CMT>();
   if (!cmt_ || !main_iobus_.Connect(cmt_.get(), c_tape))
@@ -486,7 +546,7 @@ bool PC88::ConnectDevices() {
   static const IOBus::Connector c_caln[] = {{kPReset, IOBus::portout, Calendar::kReset},
                                             {0x10, IOBus::portout, Calendar::kOut10},
                                             {0x40, IOBus::portout, Calendar::kOut40},
-                                            {0x40, IOBus::portin, Calendar::kIn40},
+                                            {0x40, IOBus::portin | IOBus::pure, Calendar::kIn40},
                                             {0, 0, 0}};
   calendar_ = std::make_unique<pc8801::Calendar>(DEV_ID('C', 'A', 'L', 'N'));
   if (!calendar_ || !calendar_->Init())
@@ -547,6 +607,7 @@ bool PC88::ConnectDevices2() {
       {0xfc, IOBus::portin | IOBus::sync, SubSystem::s_read0},
       {0xfd, IOBus::portin | IOBus::sync, SubSystem::s_read1},
       {0xfe, IOBus::portin | IOBus::sync, SubSystem::s_read2},
+      {kPIRQ2, IOBus::portout, SubSystem::s_intr},
       {0, 0, 0}};
   if (!subsys_ || !sub_iobus_.Connect(subsys_.get(), c_mem2))
     return false;
@@ -584,11 +645,17 @@ void PC88::ApplyConfig(const Config* cfg) {
   opn1_->ApplyConfig(cfg);
   opn2_->SetFMMixMode(!!(cfg->flag2() & Config::kUseFMClock));
   opn2_->ApplyConfig(cfg);
+  main_cpu_.EnableIdleSkip(!!(cfg->flag2() & Config::kSkipIdleLoop));
 
   cpu_mode_ = (cfg->cpumode == Config::kMainSubAuto) ? (cfg->mainsubratio > 1 ? ms21 : ms11)
                                                      : (cfg->cpumode & 1);
   if ((cfg->flags() & Config::kSubCPUControl) != 0)
     cpu_mode_ |= stopwhenidle;
+  if (cfg->flag2() & Config::kSkipSubCPUWait)
+    cpu_mode_ |= stopwhenwaiting;
+  // クロック比ごとの実行関数はここで選んでおき，Execute では選ばない
+  exec_dual_ = Z80XX::GetExecFunc((cpu_mode_ & 1) == ms11 ? Z80ExecMode::kDual
+                                                          : Z80ExecMode::kDual2);
 
   if (cfg->flags() & pc8801::Config::kEnablePad) {
     joy_pad_->SetButtonMode(cfg->flags() & Config::kSwappedButtons ? JoyPad::SWAPPED
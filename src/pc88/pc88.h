@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "common/clock_converter.h"
 #include "common/device.h"
 #include "common/draw.h"
 #include "common/emulation_loop.h"
@@ -15,6 +16,7 @@
 #include "devices/z80x.h"
 
 #include <memory>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 //  仮宣言
@@ -61,13 +63,17 @@ class SchedulerImpl : public Scheduler {
   void ShortenNS(int64_t ns) override;
   int64_t GetNS() override;
 
-  void set_cpu_clock(uint64_t cpu_clock) { cpu_clock_ = cpu_clock; }
-  [[nodiscard]] int64_t cpu_clock() const { return cpu_clock_; }
+  // 変換用の逆数はクロックが変わったときだけ求め直す
+  void set_cpu_clock(uint64_t cpu_clock) {
+    if (cpu_clock != clock_.hz())
+      clock_.SetClock(cpu_clock);
+  }
+  [[nodiscard]] int64_t cpu_clock() const { return clock_.hz(); }
 
  private:
   PC88* pc_;
   // CPU clock (Hz)
-  uint64_t cpu_clock_ = 3993600;
+  ClockConverter clock_{3993600};
 };
 
 // ---------------------------------------------------------------------------
@@ -92,6 +98,9 @@ class PC88 : public ICPUTime, public EmulationLoopDelegate {
   void TimeSync() override;
   void UpdateScreen(bool refresh) override;
   uint64_t GetFramePeriodNS() override;
+  bool BeginSpeculation() override;
+  void EndSpeculation() override;
+  [[nodiscard]] bool IsSpeculative() const { return speculative_; }
 
   // Overrides SchedulerExecutor
   int64_t Execute(int64_t clocks);
@@ -183,7 +192,8 @@ class PC88 : public ICPUTime, public EmulationLoopDelegate {
   enum CPUMode : uint8_t {
     ms11 = 0,
     ms21 = 1,          // bit 0
-    stopwhenidle = 4,  // bit 2
+    stopwhenidle = 4,     // bit 2
+    stopwhenwaiting = 8,  // bit 3
   };
 
   void VSync();
@@ -221,6 +231,8 @@ class PC88 : public ICPUTime, public EmulationLoopDelegate {
   std::unique_ptr<pc8801::JoyPad> joy_pad_;
 
   uint8_t cpu_mode_ = 0;
+  // 2CPU 実行時の実行関数 (ApplyConfig で cpu_mode_ に合わせて選ぶ)
+  Z80XX::ExecFunc exec_dual_ = &Z80XX::ExecDual;
   // 実効速度 (単位はclock)
   int64_t effective_clocks_ = 1;
 
@@ -229,6 +241,13 @@ class PC88 : public ICPUTime, public EmulationLoopDelegate {
 
   bool screen_updated_ = false;
 
+  // run-ahead: 投機的な実行を始める前の状態
+  bool speculative_ = false;
+  std::vector<uint8_t> spec_status_;
+  Scheduler::State spec_scheduler_;
+  int64_t spec_main_clocks_ = 0;
+  int64_t spec_sub_clocks_ = 0;
+
   Draw* draw_ = nullptr;
   Draw::Region region_{};
 
@@ -11,6 +11,7 @@
 #include "common/io_bus.h"
 #include "pc88/config.h"
 #include "pc88/crtc.h"
+#include "pc88/gvram_kernels.h"
 #include "pc88/memory.h"
 
 // #define LOGNAME "screen"
@@ -67,8 +68,9 @@ constexpr uint8_t palextable[2][8] = {
 // ---------------------------------------------------------------------------
 // 構築/消滅
 //
-Screen::Screen(const ID& id) : Device(id) {
+Screen::Screen(const ID& id) : Device(id), kernels_(&GetGVRAMKernels()) {
   CreateTable();
+  Log("gvram kernels: %s\n", kernels_->name);
 }
 
 Screen::~Screen() = default;
@@ -301,7 +303,7 @@ void Screen::UpdateScreen(uint8_t* image, int bpl, Draw::Region& region, bool re
     mode_changed_ = false;
     palette_changed_ = true;
     ClearScreen(image, bpl);
-    memset(memory_->GetDirtyFlag(), 1, 0x400);
+    memory_->GetDirtyMap().SetAll();
   }
   if (!n80mode_) {
     if (color_)
@@ -341,10 +343,21 @@ void Screen::UpdateScreen(uint8_t* image, int bpl, Draw::Region& region, bool re
   }
 }
 
+namespace {
+// 320x200 では GVRAM の 1 行が画面の 2 ライン (1280 ドット) になる
+int Columns320(int columns) {
+  static const int tmp[5] = {0x03, 0x0c, 0x11, 0x06, 0x18};
+  int dm = 0;
+  for (int x = 0; x < 5; ++x) {
+    if (columns & (1 << x))
+      dm |= tmp[x];
+  }
+  return dm;
+}
+
 // ---------------------------------------------------------------------------
-//  画面更新
+//  640x200 color
 //
-namespace {
 inline void WRITEC0_(packed& d, uint32_t a) {
   d = (d & ~PACK(GVRAMC_BIT)) | BETable0[(a >> 4) & 15] | BETable1[(a >> 12) & 15] |
       BETable2[(a >> 20) & 15];
@@ -354,96 +367,30 @@ inline void WRITEC1_(packed& d, uint32_t a) {
   d = (d & ~PACK(GVRAMC_BIT)) | BETable0[a & 15] | BETable1[(a >> 8) & 15] |
       BETable2[(a >> 16) & 15];
 }
-
-inline void WRITEC0F_(int o, uint32_t a, packed* d, int bpl) {
-  auto* next = (packed*)((uint8_t*)&d[o] + bpl);
-  *next = d[o] = (d[o] & ~PACK(GVRAMC_BIT)) | BETable0[(a >> 4) & 15] | BETable1[(a >> 12) & 15] |
-                 BETable2[(a >> 20) & 15];
-}
-
-inline void WRITEC1F_(int o, uint32_t a, packed* d, int bpl) {
-  auto* next = (packed*)((uint8_t*)&d[o] + bpl);
-  *next = d[o] = (d[o] & ~PACK(GVRAMC_BIT)) | BETable0[a & 15] | BETable1[(a >> 8) & 15] |
-                 BETable2[(a >> 16) & 15];
-}
 }  // namespace
 
 // 640x200, 3 plane color
 void Screen::UpdateScreen200c(uint8_t* image, int bpl, Draw::Region& region) {
-  uint8_t* dirty = memory_->GetDirtyFlag();
-  int y;
-  for (y = 0; y < 1000; y += sizeof(packed)) {
-    if (*(packed*)(&dirty[y]))
-      break;
-  }
-  if (y < 1000) {
-    y /= 5;
-
-    int begin = y, end = y;
-
-    image += 2 * bpl * y;
-    dirty += 5 * y;
-
-    Memory::Quadbyte* src = memory_->GetGVRAM() + y * 80;
-    int dm = 0;
-
-    if (!full_line_) {
-      for (; y < 200; ++y, image += 2 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest += 32) {
-          if (*dirty) {
-            *dirty = 0;
-            end = y;
-            dm |= 1 << x;
-
-            Memory::Quadbyte* s = src;
-            auto* d = (packed*)dest;
-            for (int j = 0; j < 4; ++j) {
-              WRITEC0_(d[0], s[0].pack);
-              WRITEC1_(d[1], s[0].pack);
-              WRITEC0_(d[2], s[1].pack);
-              WRITEC1_(d[3], s[1].pack);
-              WRITEC0_(d[4], s[2].pack);
-              WRITEC1_(d[5], s[2].pack);
-              WRITEC0_(d[6], s[3].pack);
-              WRITEC1_(d[7], s[3].pack);
-              d += 8;
-              s += 4;
-            }
-          }
-        }
-      }
+  Memory::Quadbyte* gvram = memory_->GetGVRAM();
+  auto color = kernels_->color;
+  bool full_line = full_line_;
+
+  auto draw = [&](int y, int x, uint32_t i) {
+    auto* d = (packed*)(image + 2 * bpl * y + x * 128);
+    Memory::Quadbyte* s = gvram + i * 16;
+    if (color) {
+      color((uint8_t*)d, &s->pack);
     } else {
-      for (; y < 200; ++y, image += 2 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest += 32) {
-          if (*dirty) {
-            *dirty = 0;
-            end = y;
-            dm |= 1 << x;
-
-            Memory::Quadbyte* s = src;
-            auto* d = (packed*)dest;
-            for (int j = 0; j < 4; ++j) {
-              WRITEC0F_(0, s[0].pack, d, bpl);
-              WRITEC1F_(1, s[0].pack, d, bpl);
-              WRITEC0F_(2, s[1].pack, d, bpl);
-              WRITEC1F_(3, s[1].pack, d, bpl);
-              WRITEC0F_(4, s[2].pack, d, bpl);
-              WRITEC1F_(5, s[2].pack, d, bpl);
-              WRITEC0F_(6, s[3].pack, d, bpl);
-              WRITEC1F_(7, s[3].pack, d, bpl);
-              d += 8;
-              s += 4;
-            }
-          }
-        }
-      }
+      for (int j = 0; j < 16; ++j)
+        WRITEC0_(d[2 * j], s[j].pack), WRITEC1_(d[2 * j + 1], s[j].pack);
     }
-    region.Update(RegionTable[dm * 2], 2 * begin, RegionTable[dm * 2 + 1], 2 * end + 1);
-  }
+    if (full_line)
+      memcpy((uint8_t*)d + bpl, d, 128);
+  };
+  ForEachDirtyBlock(memory_->GetDirtyMap(), 200, 0, draw, [&](const DirtyRows& rows) {
+    region.Update(RegionTable[rows.columns * 2], 2 * rows.begin,
+                  RegionTable[rows.columns * 2 + 1], 2 * rows.end + 1);
+  });
 }
 
 // ---------------------------------------------------------------------------
@@ -458,108 +405,39 @@ inline void WRITEB0_(packed& d, uint32_t a) {
 inline void WRITEB1_(packed& d, uint32_t a) {
   d = (d & ~PACK(GVRAMM_BIT)) | BETable1[(a | (a >> 8) | (a >> 16)) & 15];
 }
-
-inline void WRITEB0F_(int o, uint32_t a, packed* d, int bpl) {
-  auto* next = (packed*)((uint8_t*)&d[o] + bpl);
-  *next = d[o] = (d[o] & ~PACK(GVRAMM_BIT)) | BETable1[((a >> 4) | (a >> 12) | (a >> 20)) & 15];
-}
-
-inline void WRITEB1F_(int o, uint32_t a, packed* d, int bpl) {
-  auto* next = (packed*)((uint8_t*)&d[o] + bpl);
-  *next = d[o] = (d[o] & ~PACK(GVRAMM_BIT)) | BETable1[(a | (a >> 8) | (a >> 16)) & 15];
-}
 }  // namespace
 
 // 640x200, b/w
 void Screen::UpdateScreen200b(uint8_t* image, int bpl, Draw::Region& region) {
-  uint8_t* dirty = memory_->GetDirtyFlag();
-  int y;
-  for (y = 0; y < 1000; y += sizeof(packed)) {
-    if (*(packed*)(&dirty[y]))
-      break;
-  }
-  if (y < 1000) {
-    y /= 5;
-
-    int begin = y, end = y;
-
-    image += 2 * bpl * y;
-    dirty += 5 * y;
-
-    Memory::Quadbyte* src = memory_->GetGVRAM() + y * 80;
-
-    Memory::Quadbyte mask;
-    mask.byte[0] = port53_ & 2 ? 0x00 : 0xff;
-    mask.byte[1] = port53_ & 4 ? 0x00 : 0xff;
-    mask.byte[2] = port53_ & 8 ? 0x00 : 0xff;
-    mask.byte[3] = 0;
-
-    int dm = 0;
-    if (!full_line_) {
-      for (; y < 200; ++y, image += 2 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest += 32) {
-          if (*dirty) {
-            *dirty = 0;
-            end = y;
-            dm |= 1 << x;
-
-            Memory::Quadbyte* s = src;
-            auto* d = (packed*)dest;
-            for (int j = 0; j < 4; ++j) {
-              uint32_t xx = s[0].pack & mask.pack;
-              WRITEB0_(d[0], xx);
-              WRITEB1_(d[1], xx);
-              xx = s[1].pack & mask.pack;
-              WRITEB0_(d[2], xx);
-              WRITEB1_(d[3], xx);
-              xx = s[2].pack & mask.pack;
-              WRITEB0_(d[4], xx);
-              WRITEB1_(d[5], xx);
-              xx = s[3].pack & mask.pack;
-              WRITEB0_(d[6], xx);
-              WRITEB1_(d[7], xx);
-              d += 8;
-              s += 4;
-            }
-          }
-        }
-      }
+  Memory::Quadbyte* gvram = memory_->GetGVRAM();
+  auto mono = kernels_->mono;
+  bool full_line = full_line_;
+
+  Memory::Quadbyte mask;
+  mask.byte[0] = port53_ & 2 ? 0x00 : 0xff;
+  mask.byte[1] = port53_ & 4 ? 0x00 : 0xff;
+  mask.byte[2] = port53_ & 8 ? 0x00 : 0xff;
+  mask.byte[3] = 0;
+
+  auto draw = [&](int y, int x, uint32_t i) {
+    auto* d = (packed*)(image + 2 * bpl * y + x * 128);
+    Memory::Quadbyte* s = gvram + i * 16;
+    if (mono) {
+      mono((uint8_t*)d, &s->pack, mask.pack);
     } else {
-      for (; y < 200; ++y, image += 2 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest += 32) {
-          if (*dirty) {
-            *dirty = 0;
-            end = y;
-            dm |= 1 << x;
-
-            Memory::Quadbyte* s = src;
-            auto* d = (packed*)dest;
-            for (int j = 0; j < 4; ++j) {
-              uint32_t xx = s[0].pack & mask.pack;
-              WRITEB0F_(0, xx, d, bpl);
-              WRITEB1F_(1, xx, d, bpl);
-              xx = s[1].pack & mask.pack;
-              WRITEB0F_(2, xx, d, bpl);
-              WRITEB1F_(3, xx, d, bpl);
-              xx = s[2].pack & mask.pack;
-              WRITEB0F_(4, xx, d, bpl);
-              WRITEB1F_(5, xx, d, bpl);
-              xx = s[3].pack & mask.pack;
-              WRITEB0F_(6, xx, d, bpl);
-              WRITEB1F_(7, xx, d, bpl);
-              d += 8;
-              s += 4;
-            }
-          }
-        }
+      for (int j = 0; j < 16; ++j) {
+        uint32_t xx = s[j].pack & mask.pack;
+        WRITEB0_(d[2 * j], xx);
+        WRITEB1_(d[2 * j + 1], xx);
       }
     }
-    region.Update(RegionTable[dm * 2], 2 * begin, RegionTable[dm * 2 + 1], 2 * end + 1);
-  }
+    if (full_line)
+      memcpy((uint8_t*)d + bpl, d, 128);
+  };
+  ForEachDirtyBlock(memory_->GetDirtyMap(), 200, 0, draw, [&](const DirtyRows& rows) {
+    region.Update(RegionTable[rows.columns * 2], 2 * rows.begin,
+                  RegionTable[rows.columns * 2 + 1], 2 * rows.end + 1);
+  });
 }
 
 // ---------------------------------------------------------------------------
@@ -574,60 +452,30 @@ inline void WRITE400B_(packed* d, uint32_t a) {
 }  // namespace
 
 void Screen::UpdateScreen400b(uint8_t* image, int bpl, Draw::Region& region) {
-  uint8_t* dirty = memory_->GetDirtyFlag();
-  int y;
-  for (y = 0; y < 1000; y += sizeof(packed)) {
-    if (*(packed*)(&dirty[y]))
-      break;
-  }
-  if (y < 1000) {
-    y /= 5;
-
-    int begin = y, end = y;
-
-    image += bpl * y;
-    dirty += 5 * y;
-
-    Memory::Quadbyte* src = memory_->GetGVRAM() + y * 80;
-
-    Memory::Quadbyte mask;
-    mask.byte[0] = port53_ & 2 ? 0x00 : 0xff;
-    mask.byte[1] = port53_ & 4 ? 0x00 : 0xff;
-    mask.byte[2] = port53_ & 8 ? 0x00 : 0xff;
-    mask.byte[3] = 0;
-
-    int dm = 0;
-    for (; y < 200; ++y, image += bpl) {
-      uint8_t* dest0 = image;
-      uint8_t* dest1 = image + 200 * bpl;
-
-      for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest0 += 128, dest1 += 128) {
-        if (*dirty) {
-          *dirty = 0;
-          end = y;
-          dm |= 1 << x;
-
-          Memory::Quadbyte* s = src;
-          auto* d0 = (packed*)dest0;
-          auto* d1 = (packed*)dest1;
-          for (int j = 0; j < 4; ++j) {
-            WRITE400B_(d0, s[0].byte[0]);
-            WRITE400B_(d1, s[0].byte[1]);
-            WRITE400B_(d0 + 2, s[1].byte[0]);
-            WRITE400B_(d1 + 2, s[1].byte[1]);
-            WRITE400B_(d0 + 4, s[2].byte[0]);
-            WRITE400B_(d1 + 4, s[2].byte[1]);
-            WRITE400B_(d0 + 6, s[3].byte[0]);
-            WRITE400B_(d1 + 6, s[3].byte[1]);
-            d0 += 8;
-            d1 += 8;
-            s += 4;
-          }
-        }
+  Memory::Quadbyte* gvram = memory_->GetGVRAM();
+  auto mono = kernels_->mono;
+
+  auto draw = [&](int y, int x, uint32_t i) {
+    uint8_t* dest0 = image + bpl * y + x * 128;
+    uint8_t* dest1 = dest0 + 200 * bpl;
+    Memory::Quadbyte* s = gvram + i * 16;
+    if (mono) {
+      mono(dest0, &s->pack, 0x0000ff);
+      mono(dest1, &s->pack, 0x00ff00);
+    } else {
+      for (int j = 0; j < 16; ++j) {
+        WRITE400B_((packed*)dest0 + 2 * j, s[j].byte[0]);
+        WRITE400B_((packed*)dest1 + 2 * j, s[j].byte[1]);
       }
     }
-    region.Update(RegionTable[dm * 2], begin, RegionTable[dm * 2 + 1], 200 + end);
-  }
+  };
+  ForEachDirtyBlock(memory_->GetDirtyMap(), 200, 0, draw, [&](const DirtyRows& rows) {
+    // B プレーンは上半分，R プレーンは下半分
+    int l = RegionTable[rows.columns * 2];
+    int r = RegionTable[rows.columns * 2 + 1];
+    region.Update(l, rows.begin, r, rows.end);
+    region.Update(l, 200 + rows.begin, r, 200 + rows.end);
+  });
 }
 
 // ---------------------------------------------------------------------------
@@ -642,93 +490,40 @@ inline void WRITE80C1_(packed& d, uint32_t a) {
   d = (d & ~PACK(GVRAMC_BIT)) | E80Table[a & 15];
 }
 
-inline void WRITE80C0F_(int o, uint32_t a, packed* d, int bpl) {
-  auto* next = (packed*)((uint8_t*)&d[o] + bpl);
-  *next = d[o] = (d[o] & ~PACK(GVRAMC_BIT)) | E80Table[(a >> 4) & 15];
-}
-
-inline void WRITE80C1F_(int o, uint32_t a, packed* d, int bpl) {
-  auto* next = (packed*)((uint8_t*)&d[o] + bpl);
-  *next = d[o] = (d[o] & ~PACK(GVRAMC_BIT)) | E80Table[a & 15];
+// E80Table と同じく，B プレーンの 2 ドットを 1 組にして偶数ビットを B，奇数ビットを R にする
+inline void Expand80(uint32_t* planes, const Memory::Quadbyte* src) {
+  for (int i = 0; i < 16; ++i) {
+    uint32_t b = src[i].byte[0] & 0x55;
+    uint32_t r = src[i].byte[0] & 0xaa;
+    planes[i] = (b | (b << 1)) | ((r | (r >> 1)) << 8);
+  }
 }
 }  // namespace
 
 // 320x200, color?
 void Screen::UpdateScreen80c(uint8_t* image, int bpl, Draw::Region& region) {
-  uint8_t* dirty = memory_->GetDirtyFlag();
-  int y;
-  for (y = 0; y < 1000; y += sizeof(packed)) {
-    if (*(packed*)(&dirty[y]))
-      break;
-  }
-  if (y < 1000) {
-    y /= 5;
-
-    int begin = y, end = y;
-
-    image += 2 * bpl * y;
-    dirty += 5 * y;
-
-    Memory::Quadbyte* src = memory_->GetGVRAM() + y * 80;
-    int dm = 0;
-
-    if (!full_line_) {
-      for (; y < 200; ++y, image += 2 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest += 32) {
-          if (*dirty) {
-            *dirty = 0;
-            end = y;
-            dm |= 1 << x;
-
-            Memory::Quadbyte* s = src;
-            auto* d = (packed*)dest;
-            for (int j = 0; j < 4; ++j) {
-              WRITE80C0_(d[0], s[0].byte[0]);
-              WRITE80C1_(d[1], s[0].byte[0]);
-              WRITE80C0_(d[2], s[1].byte[0]);
-              WRITE80C1_(d[3], s[1].byte[0]);
-              WRITE80C0_(d[4], s[2].byte[0]);
-              WRITE80C1_(d[5], s[2].byte[0]);
-              WRITE80C0_(d[6], s[3].byte[0]);
-              WRITE80C1_(d[7], s[3].byte[0]);
-              d += 8;
-              s += 4;
-            }
-          }
-        }
-      }
+  Memory::Quadbyte* gvram = memory_->GetGVRAM();
+  auto color = kernels_->color;
+  bool full_line = full_line_;
+
+  auto draw = [&](int y, int x, uint32_t i) {
+    auto* d = (packed*)(image + 2 * bpl * y + x * 128);
+    Memory::Quadbyte* s = gvram + i * 16;
+    if (color) {
+      uint32_t planes[16];
+      Expand80(planes, s);
+      color((uint8_t*)d, planes);
     } else {
-      for (; y < 200; ++y, image += 2 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest += 32) {
-          if (*dirty) {
-            *dirty = 0;
-            end = y;
-            dm |= 1 << x;
-
-            Memory::Quadbyte* s = src;
-            auto* d = (packed*)dest;
-            for (int j = 0; j < 4; ++j) {
-              WRITE80C0F_(0, s[0].byte[0], d, bpl);
-              WRITE80C1F_(1, s[0].byte[0], d, bpl);
-              WRITE80C0F_(2, s[1].byte[0], d, bpl);
-              WRITE80C1F_(3, s[1].byte[0], d, bpl);
-              WRITE80C0F_(4, s[2].byte[0], d, bpl);
-              WRITE80C1F_(5, s[2].byte[0], d, bpl);
-              WRITE80C0F_(6, s[3].byte[0], d, bpl);
-              WRITE80C1F_(7, s[3].byte[0], d, bpl);
-              d += 8;
-              s += 4;
-            }
-          }
-        }
-      }
+      for (int j = 0; j < 16; ++j)
+        WRITE80C0_(d[2 * j], s[j].byte[0]), WRITE80C1_(d[2 * j + 1], s[j].byte[0]);
     }
-    region.Update(RegionTable[dm * 2], 2 * begin, RegionTable[dm * 2 + 1], 2 * end + 1);
-  }
+    if (full_line)
+      memcpy((uint8_t*)d + bpl, d, 128);
+  };
+  ForEachDirtyBlock(memory_->GetDirtyMap(), 200, 0, draw, [&](const DirtyRows& rows) {
+    region.Update(RegionTable[rows.columns * 2], 2 * rows.begin,
+                  RegionTable[rows.columns * 2 + 1], 2 * rows.end + 1);
+  });
 }
 
 // ---------------------------------------------------------------------------
@@ -743,278 +538,94 @@ inline void WRITE80B0_(packed& d, uint32_t a) {
 inline void WRITE80B1_(packed& d, uint32_t a) {
   d = (d & ~PACK(GVRAMM_BIT)) | BETable1[a & 15];
 }
-
-inline void WRITE80B0F_(int o, uint32_t a, packed* d, int bpl) {
-  auto* next = (packed*)((uint8_t*)&d[o] + bpl);
-  *next = d[o] = (d[o] & ~PACK(GVRAMM_BIT)) | BETable1[(a >> 4) & 15];
-}
-
-inline void WRITE80B1F_(int o, uint32_t a, packed* d, int bpl) {
-  auto* next = (packed*)((uint8_t*)&d[o] + bpl);
-  *next = d[o] = (d[o] & ~PACK(GVRAMM_BIT)) | BETable1[a & 15];
-}
 }  // namespace
 
 void Screen::UpdateScreen80b(uint8_t* image, int bpl, Draw::Region& region) {
-  uint8_t* dirty = memory_->GetDirtyFlag();
-  int y;
-  for (y = 0; y < 1000; y += sizeof(packed)) {
-    if (*(packed*)(&dirty[y]))
-      break;
-  }
-  if (y < 1000) {
-    y /= 5;
-
-    int begin = y, end = y;
-
-    image += 2 * bpl * y;
-    dirty += 5 * y;
-
-    Memory::Quadbyte* src = memory_->GetGVRAM() + y * 80;
-
-    Memory::Quadbyte mask;
-    if (!gmask_) {
-      mask.byte[0] = port53_ & 2 ? 0x00 : 0xff;
-      mask.byte[1] = port53_ & 4 ? 0x00 : 0xff;
-      mask.byte[2] = port53_ & 8 ? 0x00 : 0xff;
-    } else {
-      mask.byte[0] = gmask_ & 1 ? 0x00 : 0xff;
-      mask.byte[1] = gmask_ & 2 ? 0x00 : 0xff;
-      mask.byte[2] = gmask_ & 4 ? 0x00 : 0xff;
-    }
-    mask.byte[3] = 0;
-
-    int dm = 0;
-
-    if (!full_line_) {
-      for (; y < 200; ++y, image += 2 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest += 32) {
-          if (*dirty) {
-            *dirty = 0;
-            end = y;
-            dm |= 1 << x;
-
-            Memory::Quadbyte* s = src;
-            auto* d = (packed*)dest;
-            for (int j = 0; j < 4; ++j) {
-              WRITE80B0_(d[0], s[0].byte[0]);
-              WRITE80B1_(d[1], s[0].byte[0]);
-              WRITE80B0_(d[2], s[1].byte[0]);
-              WRITE80B1_(d[3], s[1].byte[0]);
-              WRITE80B0_(d[4], s[2].byte[0]);
-              WRITE80B1_(d[5], s[2].byte[0]);
-              WRITE80B0_(d[6], s[3].byte[0]);
-              WRITE80B1_(d[7], s[3].byte[0]);
-              d += 8;
-              s += 4;
-            }
-          }
-        }
-      }
+  Memory::Quadbyte* gvram = memory_->GetGVRAM();
+  auto mono = kernels_->mono;
+  bool full_line = full_line_;
+
+  auto draw = [&](int y, int x, uint32_t i) {
+    auto* d = (packed*)(image + 2 * bpl * y + x * 128);
+    Memory::Quadbyte* s = gvram + i * 16;
+    if (mono) {
+      mono((uint8_t*)d, &s->pack, 0xff);
     } else {
-      for (; y < 200; ++y, image += 2 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty, src += 16, dest += 32) {
-          if (*dirty) {
-            *dirty = 0;
-            end = y;
-            dm |= 1 << x;
-
-            Memory::Quadbyte* s = src;
-            auto* d = (packed*)dest;
-            for (int j = 0; j < 4; ++j) {
-              WRITE80B0F_(0, s[0].byte[0], d, bpl);
-              WRITE80B1F_(1, s[0].byte[0], d, bpl);
-              WRITE80B0F_(2, s[1].byte[0], d, bpl);
-              WRITE80B1F_(3, s[1].byte[0], d, bpl);
-              WRITE80B0F_(4, s[2].byte[0], d, bpl);
-              WRITE80B1F_(5, s[2].byte[0], d, bpl);
-              WRITE80B0F_(6, s[3].byte[0], d, bpl);
-              WRITE80B1F_(7, s[3].byte[0], d, bpl);
-              d += 8;
-              s += 4;
-            }
-          }
-        }
-      }
+      for (int j = 0; j < 16; ++j)
+        WRITE80B0_(d[2 * j], s[j].byte[0]), WRITE80B1_(d[2 * j + 1], s[j].byte[0]);
     }
-    region.Update(RegionTable[dm * 2], 2 * begin, RegionTable[dm * 2 + 1], 2 * end + 1);
-  }
+    if (full_line)
+      memcpy((uint8_t*)d + bpl, d, 128);
+  };
+  ForEachDirtyBlock(memory_->GetDirtyMap(), 200, 0, draw, [&](const DirtyRows& rows) {
+    region.Update(RegionTable[rows.columns * 2], 2 * rows.begin,
+                  RegionTable[rows.columns * 2 + 1], 2 * rows.end + 1);
+  });
 }
 
 // ---------------------------------------------------------------------------
 //  画面更新 (320x200x2 color)
+//  GVRAM の 1 バイトが 16 ドット (packed 4 個) になる．ブロック内 j 番目のバイトの位置
 //
+namespace {
+inline packed* Dest320(uint8_t* line, int bpl, int x, int j) {
+  int o = x * 256 + j * 16;
+  return (packed*)(o < 640 ? line + o : line + 2 * bpl + o - 640);
+}
+}  // namespace
+
 #define WRITEC320(d)                                                                           \
   m = E80SRMask[(bp1 | rp1 >> 2 | gp1 >> 4) & 3];                                              \
   d = (d & ~PACK(GVRAMC_BIT)) | (E80SRTable[(bp1 & 0x03) | (rp1 & 0x0c) | (gp1 & 0x30)] & m) | \
       (E80SRTable[(bp2 & 0x03) | (rp2 & 0x0c) | (gp2 & 0x30)] & ~m)
-#define WRITEC320F(o)                                                \
-  m = E80SRMask[(bp1 | rp1 >> 2 | gp1 >> 4) & 3];                    \
-  *((packed*)(((uint8_t*)(dest + o)) + bpl)) = dest[o] =             \
-      (dest[o] & ~PACK(GVRAMC_BIT)) |                                \
-      (E80SRTable[(bp1 & 0x03) | (rp1 & 0x0c) | (gp1 & 0x30)] & m) | \
-      (E80SRTable[(bp2 & 0x03) | (rp2 & 0x0c) | (gp2 & 0x30)] & ~m)
+
 void Screen::UpdateScreen320c(uint8_t* image, int bpl, Draw::Region& region) {
-  uint8_t* dirty1 = memory_->GetDirtyFlag();
-  uint8_t* dirty2 = dirty1 + 0x200;
-  int y;
-  for (y = 0; y < 500; y += sizeof(packed)) {
-    if (*(packed*)(&dirty1[y]) || *(packed*)(&dirty2[y]))
-      break;
+  Memory::Quadbyte* gvram1 = memory_->GetGVRAM();
+  Memory::Quadbyte* gvram2 = memory_->GetGVRAM() + 0x2000;
+  uint32_t dspoff = port53_;
+  if (grph_priority_) {
+    std::swap(gvram1, gvram2);
+    dspoff = ((port53_ >> 1) & 2) | ((port53_ << 1) & 4);
   }
-  if (y < 500) {
-    y /= 5;
-
-    int begin = y * 2, end = y * 2 + 1;
-
-    image += 4 * bpl * y;
-    dirty1 += 5 * y;
-    dirty2 += 5 * y;
-
-    Memory::Quadbyte* src1 = nullptr;
-    Memory::Quadbyte* src2 = nullptr;
-    uint32_t dspoff;
-    if (!grph_priority_) {
-      src1 = memory_->GetGVRAM() + y * 80;
-      src2 = memory_->GetGVRAM() + y * 80 + 0x2000;
-      dspoff = port53_;
-    } else {
-      src1 = memory_->GetGVRAM() + y * 80 + 0x2000;
-      src2 = memory_->GetGVRAM() + y * 80;
-      dspoff = ((port53_ >> 1) & 2) | ((port53_ << 1) & 4);
-    }
-    int dm = 0;
-
-    uint32_t bp1, rp1, gp1, bp2, rp2, gp2;
-    bp1 = rp1 = gp1 = bp2 = rp2 = gp2 = 0;
-
-    if (!full_line_) {
-      for (; y < 100; ++y, image += 4 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty1, ++dirty2) {
-          if (*dirty1 || *dirty2) {
-            *dirty1 = *dirty2 = 0;
-            end = y * 2 + 1;
-            static const int tmp[5] = {0x03, 0x0c, 0x11, 0x06, 0x18};
-            dm |= tmp[x];
-
-            packed m;
-            for (int j = 0; j < 16; ++j) {
-              if (!(dspoff & 2)) {
-                bp1 = src1->byte[0];
-                rp1 = src1->byte[1] << 2;
-                gp1 = src1->byte[2] << 4;
-              }
-              if (!(dspoff & 4)) {
-                bp2 = src2->byte[0];
-                rp2 = src2->byte[1] << 2;
-                gp2 = src2->byte[2] << 4;
-              }
-
-              WRITEC320(dest[3]);
-              bp1 >>= 2;
-              rp1 >>= 2;
-              gp1 >>= 2;
-              bp2 >>= 2;
-              rp2 >>= 2;
-              gp2 >>= 2;
-              WRITEC320(dest[2]);
-              bp1 >>= 2;
-              rp1 >>= 2;
-              gp1 >>= 2;
-              bp2 >>= 2;
-              rp2 >>= 2;
-              gp2 >>= 2;
-              WRITEC320(dest[1]);
-              bp1 >>= 2;
-              rp1 >>= 2;
-              gp1 >>= 2;
-              bp2 >>= 2;
-              rp2 >>= 2;
-              gp2 >>= 2;
-              WRITEC320(dest[0]);
-              if (x == 2 && j == 7)
-                dest = (packed*)(image + 2 * bpl);
-              else
-                dest += 4;
-              ++src1;
-              ++src2;
-            }
-          } else {
-            src1 += 16;
-            src2 += 16;
-            dest = (x == 2 ? (packed*)(image + 2 * bpl) + 32 : dest + 64);
-          }
-        }
+  bool full_line = full_line_;
+
+  auto draw = [&](int y, int x, uint32_t i) {
+    uint8_t* line = image + 4 * bpl * y;
+    Memory::Quadbyte* src1 = gvram1 + i * 16;
+    Memory::Quadbyte* src2 = gvram2 + i * 16;
+    uint32_t bp1 = 0, rp1 = 0, gp1 = 0, bp2 = 0, rp2 = 0, gp2 = 0;
+    packed m;
+    for (int j = 0; j < 16; ++j, ++src1, ++src2) {
+      if (!(dspoff & 2)) {
+        bp1 = src1->byte[0];
+        rp1 = src1->byte[1] << 2;
+        gp1 = src1->byte[2] << 4;
       }
-    } else {
-      for (; y < 100; ++y, image += 4 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty1, ++dirty2) {
-          if (*dirty1 || *dirty2) {
-            *dirty1 = *dirty2 = 0;
-            end = y * 2 + 1;
-            static const int tmp[5] = {0x03, 0x0c, 0x11, 0x06, 0x18};
-            dm |= tmp[x];
-
-            packed m;
-            for (int j = 0; j < 16; ++j) {
-              if (!(dspoff & 2)) {
-                bp1 = src1->byte[0];
-                rp1 = src1->byte[1] << 2;
-                gp1 = src1->byte[2] << 4;
-              }
-              if (!(dspoff & 4)) {
-                bp2 = src2->byte[0];
-                rp2 = src2->byte[1] << 2;
-                gp2 = src2->byte[2] << 4;
-              }
-
-              WRITEC320F(3);
-              bp1 >>= 2;
-              rp1 >>= 2;
-              gp1 >>= 2;
-              bp2 >>= 2;
-              rp2 >>= 2;
-              gp2 >>= 2;
-              WRITEC320F(2);
-              bp1 >>= 2;
-              rp1 >>= 2;
-              gp1 >>= 2;
-              bp2 >>= 2;
-              rp2 >>= 2;
-              gp2 >>= 2;
-              WRITEC320F(1);
-              bp1 >>= 2;
-              rp1 >>= 2;
-              gp1 >>= 2;
-              bp2 >>= 2;
-              rp2 >>= 2;
-              gp2 >>= 2;
-              WRITEC320F(0);
-              if (x == 2 && j == 7)
-                dest = (packed*)(image + 2 * bpl);
-              else
-                dest += 4;
-              ++src1;
-              ++src2;
-            }
-          } else {
-            src1 += 16;
-            src2 += 16;
-            dest = (x == 2 ? (packed*)(image + 2 * bpl) + 32 : dest + 64);
-          }
-        }
+      if (!(dspoff & 4)) {
+        bp2 = src2->byte[0];
+        rp2 = src2->byte[1] << 2;
+        gp2 = src2->byte[2] << 4;
+      }
+
+      packed* dest = Dest320(line, bpl, x, j);
+      for (int k = 3; k >= 0; --k) {
+        WRITEC320(dest[k]);
+        bp1 >>= 2;
+        rp1 >>= 2;
+        gp1 >>= 2;
+        bp2 >>= 2;
+        rp2 >>= 2;
+        gp2 >>= 2;
       }
+      if (full_line)
+        memcpy((uint8_t*)dest + bpl, dest, 16);
     }
-    region.Update(RegionTable[dm * 2], 2 * begin, RegionTable[dm * 2 + 1], 2 * end + 1);
-  }
+  };
+  ForEachDirtyBlock(memory_->GetDirtyMap(), 100, 0x200, draw, [&](const DirtyRows& rows) {
+    int dm = Columns320(rows.columns);
+    region.Update(RegionTable[dm * 2], 4 * rows.begin, RegionTable[dm * 2 + 1],
+                  4 * rows.end + 3);
+  });
 }
 
 // ---------------------------------------------------------------------------
@@ -1022,130 +633,44 @@ void Screen::UpdateScreen320c(uint8_t* image, int bpl, Draw::Region& region) {
 //
 #define WRITEB320(d, a) d = (d & ~PACK(GVRAMM_BIT)) | BE80Table[a & 3]
 
-#define WRITEB320F(o, a)                                 \
-  *((packed*)(((uint8_t*)(dest + o)) + bpl)) = dest[o] = \
-      (dest[o] & ~PACK(GVRAMM_BIT)) | BE80Table[a & 3]
-
 void Screen::UpdateScreen320b(uint8_t* image, int bpl, Draw::Region& region) {
-  uint8_t* dirty1 = memory_->GetDirtyFlag();
-  uint8_t* dirty2 = dirty1 + 0x200;
-  int y;
-  for (y = 0; y < 500; y += sizeof(packed)) {
-    if (*(packed*)(&dirty1[y]) || *(packed*)(&dirty2[y]))
-      break;
-  }
-  if (y < 500) {
-    y /= 5;
-
-    int begin = y * 2, end = y * 2 + 1;
-
-    image += 4 * bpl * y;
-    dirty1 += 5 * y;
-    dirty2 += 5 * y;
-
-    Memory::Quadbyte* src = memory_->GetGVRAM() + y * 80;
-
-    Memory::Quadbyte mask1;
-    Memory::Quadbyte mask2;
-    mask1.byte[0] = port53_ & 2 ? 0x00 : 0xff;
-    mask1.byte[1] = port53_ & 4 ? 0x00 : 0xff;
-    mask1.byte[2] = port53_ & 8 ? 0x00 : 0xff;
-    mask1.byte[3] = 0;
-    mask2.byte[0] = port53_ & 16 ? 0x00 : 0xff;
-    mask2.byte[1] = port53_ & 32 ? 0x00 : 0xff;
-    mask2.byte[2] = port53_ & 64 ? 0x00 : 0xff;
-    mask2.byte[3] = 0;
-
-    int dm = 0;
-    if (!full_line_) {
-      for (; y < 100; ++y, image += 4 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty1, ++dirty2) {
-          if (*dirty1 || *dirty2) {
-            *dirty1 = *dirty2 = 0;
-            end = y * 2 + 1;
-            static const int tmp[5] = {0x03, 0x0c, 0x11, 0x06, 0x18};
-            dm |= tmp[x];
-
-            for (int j = 0; j < 8; ++j) {
-              uint32_t s;
-              s = (src[0].pack & mask1.pack) | (src[0x2000].pack & mask2.pack);
-              s = (s | (s >> 8) | (s >> 16));
-              WRITEB320(dest[3], s);
-              s >>= 2;
-              WRITEB320(dest[2], s);
-              s >>= 2;
-              WRITEB320(dest[1], s);
-              s >>= 2;
-              WRITEB320(dest[0], s);
-              s = (src[1].pack & mask1.pack) | (src[0x2001].pack & mask2.pack);
-              s = (s | (s >> 8) | (s >> 16));
-              WRITEB320(dest[7], s);
-              s >>= 2;
-              WRITEB320(dest[6], s);
-              s >>= 2;
-              WRITEB320(dest[5], s);
-              s >>= 2;
-              WRITEB320(dest[4], s);
-              if (x == 2 && j == 3)
-                dest = (packed*)(image + 2 * bpl);
-              else
-                dest += 8;
-              src += 2;
-            }
-          } else {
-            src += 16;
-            dest = (x == 2 ? (packed*)(image + 2 * bpl) + 32 : dest + 64);
-          }
-        }
-      }
-    } else {
-      for (; y < 100; ++y, image += 4 * bpl) {
-        auto* dest = (packed*)image;
-
-        for (int x = 0; x < 5; ++x, ++dirty1, ++dirty2) {
-          if (*dirty1 || *dirty2) {
-            *dirty1 = *dirty2 = 0;
-            end = y * 2 + 1;
-            static const int tmp[5] = {0x03, 0x0c, 0x11, 0x06, 0x18};
-            dm |= tmp[x];
-
-            for (int j = 0; j < 8; ++j) {
-              uint32_t s;
-              s = (src[0].pack & mask1.pack) | (src[0x2000].pack & mask2.pack);
-              s = (s | (s >> 8) | (s >> 16));
-              WRITEB320F(3, s);
-              s >>= 2;
-              WRITEB320F(2, s);
-              s >>= 2;
-              WRITEB320F(1, s);
-              s >>= 2;
-              WRITEB320F(0, s);
-              s = (src[1].pack & mask1.pack) | (src[0x2001].pack & mask2.pack);
-              s = (s | (s >> 8) | (s >> 16));
-              WRITEB320F(7, s);
-              s >>= 2;
-              WRITEB320F(6, s);
-              s >>= 2;
-              WRITEB320F(5, s);
-              s >>= 2;
-              WRITEB320F(4, s);
-              if (x == 2 && j == 3)
-                dest = (packed*)(image + 2 * bpl);
-              else
-                dest += 8;
-              src += 2;
-            }
-          } else {
-            src += 16;
-            dest = (x == 2 ? (packed*)(image + 2 * bpl) + 32 : dest + 64);
-          }
-        }
-      }
+  Memory::Quadbyte* gvram = memory_->GetGVRAM();
+  bool full_line = full_line_;
+
+  Memory::Quadbyte mask1;
+  Memory::Quadbyte mask2;
+  mask1.byte[0] = port53_ & 2 ? 0x00 : 0xff;
+  mask1.byte[1] = port53_ & 4 ? 0x00 : 0xff;
+  mask1.byte[2] = port53_ & 8 ? 0x00 : 0xff;
+  mask1.byte[3] = 0;
+  mask2.byte[0] = port53_ & 16 ? 0x00 : 0xff;
+  mask2.byte[1] = port53_ & 32 ? 0x00 : 0xff;
+  mask2.byte[2] = port53_ & 64 ? 0x00 : 0xff;
+  mask2.byte[3] = 0;
+
+  auto draw = [&](int y, int x, uint32_t i) {
+    uint8_t* line = image + 4 * bpl * y;
+    Memory::Quadbyte* src = gvram + i * 16;
+    for (int j = 0; j < 16; ++j, ++src) {
+      uint32_t s = (src[0].pack & mask1.pack) | (src[0x2000].pack & mask2.pack);
+      s = (s | (s >> 8) | (s >> 16));
+      packed* dest = Dest320(line, bpl, x, j);
+      WRITEB320(dest[3], s);
+      s >>= 2;
+      WRITEB320(dest[2], s);
+      s >>= 2;
+      WRITEB320(dest[1], s);
+      s >>= 2;
+      WRITEB320(dest[0], s);
+      if (full_line)
+        memcpy((uint8_t*)dest + bpl, dest, 16);
     }
-    region.Update(RegionTable[dm * 2], 2 * begin, RegionTable[dm * 2 + 1], 2 * end + 1);
-  }
+  };
+  ForEachDirtyBlock(memory_->GetDirtyMap(), 100, 0x200, draw, [&](const DirtyRows& rows) {
+    int dm = Columns320(rows.columns);
+    region.Update(RegionTable[dm * 2], 4 * rows.begin, RegionTable[dm * 2 + 1],
+                  4 * rows.end + 3);
+  });
 }
 
 // ---------------------------------------------------------------------------
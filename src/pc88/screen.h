@@ -29,6 +29,7 @@ namespace pc8801 {
 
 class CRTC;
 class Memory;
+struct GVRAMKernels;
 
 // ---------------------------------------------------------------------------
 //  88 の画面に関するクラス
@@ -92,6 +93,8 @@ class Screen : public Device {
   IOBus* bus_ = nullptr;
   Memory* memory_ = nullptr;
   CRTC* crtc_ = nullptr;
+  // GVRAM の展開に使う SIMD 版の関数 (nullptr ならテーブルを使う)
+  const GVRAMKernels* kernels_;
 
   Draw::Palette pal_[8]{};
   Draw::Palette bg_pal_{};
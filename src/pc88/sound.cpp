@@ -90,7 +90,9 @@ void Sound::CleanUp() {
 //
 int Sound::Get(Sample16* dest, int nsamples) {
   int mixsamples = std::min(nsamples, buffer_size_);
-  if (mixsamples > 0) {
+  if (mixsamples > 0 && muted_) {
+    memset(dest, 0, mixsamples * 2 * sizeof(Sample16));
+  } else if (mixsamples > 0) {
     // 合成
     {
       memset(mixing_buf_.get(), 0, mixsamples * 2 * sizeof(int32_t));
@@ -114,6 +116,8 @@ int Sound::Get(Sample16* dest, int nsamples) {
 int Sound::Get(Sample32* dest, int nsamples) {
   // 合成
   memset(dest, 0, nsamples * 2 * sizeof(int32_t));
+  if (muted_)
+    return nsamples;
   std::lock_guard<std::mutex> lock(mtx_);
   for (auto& ss : sslist_)
     ss->Mix(dest, nsamples);
@@ -172,8 +176,15 @@ bool Sound::Disconnect(ISoundSource* ss) {
 //  arg:    src     更新する音源を指定(今の実装では無視されます)
 //
 bool Sound::Update(ISoundSource* /*src*/) {
-  if (!enabled_)
+  // 投機的な実行 (run-ahead) の間は合成しない
+  if (!enabled_ || pc_->IsSpeculative())
     return true;
+  if (muted_) {
+    // 合成はしないが，止めている間の時間は進めておく
+    prev_clock_ = pc_->GetCPUClocks64();
+    clock_remainder_ = 0;
+    return true;
+  }
 
   int64_t current_clock = pc_->GetCPUClocks64();
   int64_t clocks = current_clock - prev_clock_ + clock_remainder_;
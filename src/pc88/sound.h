@@ -11,6 +11,7 @@
 #include "common/device.h"
 #include "common/sampling_rate_converter.h"
 
+#include <atomic>
 #include <mutex>
 #include <vector>
 
@@ -33,6 +34,8 @@ class Sound : public Device, public ISoundControl, protected SoundSource32 {
 
   void ApplyConfig(const Config* config);
   bool SetRate(uint32_t rate, int bufsize);
+  // 合成を止める (早送り用)．音源のレジスタとタイマーは動き続ける
+  void Mute(bool mute) { muted_ = mute; }
 
   void IOCALL UpdateCounter(uint32_t);
 
@@ -72,6 +75,7 @@ class Sound : public Device, public ISoundControl, protected SoundSource32 {
   // uint32_t cfgflg = 0;
 
   bool enabled_ = false;
+  std::atomic<bool> muted_ = false;
 
   std::vector<ISoundSource*> sslist_;
   std::mutex mtx_;
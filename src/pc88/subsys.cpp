@@ -6,6 +6,8 @@
 
 #include "pc88/subsys.h"
 
+#include <algorithm>
+
 #include "common/device.h"
 #include "common/memory_manager.h"
 #include "common/status_bar.h"
@@ -104,6 +106,7 @@ void SubSystem::Reset(uint32_t, uint32_t) {
   pio_main_.Reset();
   pio_sub_.Reset();
   idle_count_ = 0;
+  ResetWait();
 }
 
 // ---------------------------------------------------------------------------
@@ -118,23 +121,27 @@ uint32_t SubSystem::IntAck(uint32_t) {
 //
 void SubSystem::M_Set0(uint32_t, uint32_t data) {
   idle_count_ = 0;
+  ResetWait();
   Log(".%.2x ", data);
   pio_main_.SetData(0, data);
 }
 
 void SubSystem::M_Set1(uint32_t, uint32_t data) {
   idle_count_ = 0;
+  ResetWait();
   Log(" %.2x ", data);
   pio_main_.SetData(1, data);
 }
 
 void SubSystem::M_Set2(uint32_t, uint32_t data) {
   idle_count_ = 0;
+  ResetWait();
   pio_main_.SetData(2, data);
 }
 
 void SubSystem::M_SetCW(uint32_t, uint32_t data) {
   idle_count_ = 0;
+  ResetWait();
   if (data == 0x0f)
     Log("\ncmd: ");
   if (data & 0x80)
@@ -167,24 +174,28 @@ uint32_t SubSystem::M_Read2(uint32_t) {
 //
 void SubSystem::S_Set0(uint32_t, uint32_t data) {
   idle_count_ = 0;
+  ResetWait();
   //  Log("<a %.2x> ", data);
   pio_sub_.SetData(0, data);
 }
 
 void SubSystem::S_Set1(uint32_t, uint32_t data) {
   idle_count_ = 0;
+  ResetWait();
   //  Log("<b %.2x> ", data);
   pio_sub_.SetData(1, data);
 }
 
 void SubSystem::S_Set2(uint32_t, uint32_t data) {
   idle_count_ = 0;
+  ResetWait();
   //  Log("<c %.2x> ", data);
   pio_sub_.SetData(2, data);
 }
 
 void SubSystem::S_SetCW(uint32_t, uint32_t data) {
   idle_count_ = 0;
+  ResetWait();
   if (data & 0x80)
     cw_sub_ = data;
   pio_sub_.SetCW(data);
@@ -192,6 +203,7 @@ void SubSystem::S_SetCW(uint32_t, uint32_t data) {
 
 uint32_t SubSystem::S_Read0(uint32_t) {
   idle_count_ = 0;
+  ResetWait();
   uint32_t d = pio_sub_.Read0();
   //  Log("(a %.2x) ", d);
   return d;
@@ -199,6 +211,7 @@ uint32_t SubSystem::S_Read0(uint32_t) {
 
 uint32_t SubSystem::S_Read1(uint32_t) {
   idle_count_ = 0;
+  ResetWait();
   uint32_t d = pio_sub_.Read1();
   //  Log("(b %.2x) ", d);
   return d;
@@ -208,9 +221,22 @@ uint32_t SubSystem::S_Read2(uint32_t) {
   idle_count_++;
   uint32_t d = pio_sub_.Read2();
   //  Log("(c %.2x) ", d);
+  if (d != wait_data_) {
+    ResetWait();
+    wait_data_ = d;
+  }
+  ++wait_reads_;
   return d;
 }
 
+// ---------------------------------------------------------------------------
+//  サブ CPU への割り込み
+//
+void SubSystem::S_Intr(uint32_t, uint32_t data) {
+  if (data)
+    ResetWait();
+}
+
 bool SubSystem::IsBusy() {
   if (idle_count_ >= 200) {
     idle_count_ = 200;
@@ -220,6 +246,58 @@ bool SubSystem::IsBusy() {
   return true;
 }
 
+// ---------------------------------------------------------------------------
+//  コマンド待ちの検出
+//  次の条件を全て満たす場合，サブ CPU はメイン側の PIO への書き込みを
+//  待っているだけなので，書き込みがあるまで実行しなくてよい
+//  - ポート C から kWaitReads 回以上続けて同じ値を読んでいる
+//  - その間ポート C 以外の PIO アクセス・割り込みがない
+//  - 実行を区切るたびに確認した PC が ROM 内の kMaxLoopBytes 以内に収まっている
+//  - その間 AF 以外のレジスタが変化せず，メモリに書き込んでいない
+//    (タイムアウトを数えるループは止めると抜けられなくなる)
+//
+bool SubSystem::IsWaiting(uint32_t pc, const Z80Reg& reg, uint32_t mem_effects) {
+  if (suspended_)
+    return true;
+  if (wait_reads_ < kWaitReads || pc >= 0x2000) {
+    wait_samples_ = 0;
+    return false;
+  }
+  if (!wait_samples_) {
+    wait_pc_lo_ = wait_pc_hi_ = pc;
+  } else {
+    wait_pc_lo_ = std::min(wait_pc_lo_, pc);
+    wait_pc_hi_ = std::max(wait_pc_hi_, pc);
+    if (wait_pc_hi_ - wait_pc_lo_ >= kMaxLoopBytes || mem_effects != wait_mem_effects_ ||
+        !SameLoopState(reg, wait_reg_)) {
+      ResetWait();
+      return false;
+    }
+  }
+  wait_reg_ = reg;
+  wait_mem_effects_ = mem_effects;
+  if (++wait_samples_ < kWaitSamples)
+    return false;
+  Log("\nsuspend: %.4x-%.4x (%.2x)\n", wait_pc_lo_, wait_pc_hi_, wait_data_);
+  suspended_ = true;
+  return true;
+}
+
+// メイン側の PIO への書き込み・サブ CPU の PIO アクセスでサブ CPU の実行を再開する
+void SubSystem::ResetWait() {
+  wait_reads_ = 0;
+  wait_samples_ = 0;
+  suspended_ = false;
+}
+
+// ポート C を読んだ値が入る AF と，R, PC 以外のレジスタが同じか
+// static
+bool SubSystem::SameLoopState(const Z80Reg& a, const Z80Reg& b) {
+  return a.r.w.hl == b.r.w.hl && a.r.w.de == b.r.w.de && a.r.w.bc == b.r.w.bc &&
+         a.r.w.ix == b.r.w.ix && a.r.w.iy == b.r.w.iy && a.r.w.sp == b.r.w.sp &&
+         a.r_af == b.r_af && a.r_hl == b.r_hl && a.r_de == b.r_de && a.r_bc == b.r_bc;
+}
+
 // ---------------------------------------------------------------------------
 //  状態保存
 //
@@ -255,6 +333,7 @@ bool SubSystem::LoadStatus(const uint8_t* s) {
     pio_main_.SetData(i, st->pm[i]), pio_sub_.SetData(i, st->ps[i]);
 
   idle_count_ = st->idlecount;
+  ResetWait();
   memcpy(ram_, st->ram, 0x4000);
   Log("\n=== LoadStatus\n");
   return true;
@@ -285,5 +364,6 @@ const Device::OutFuncPtr SubSystem::outdef[] = {
     static_cast<Device::OutFuncPtr>(&SubSystem::S_Set1),
     static_cast<Device::OutFuncPtr>(&SubSystem::S_Set2),
     static_cast<Device::OutFuncPtr>(&SubSystem::S_SetCW),
+    static_cast<Device::OutFuncPtr>(&SubSystem::S_Intr),
 };
 }  // namespace pc8801
\ No newline at end of file
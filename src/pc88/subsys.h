@@ -7,6 +7,7 @@
 #pragma once
 
 #include "common/device.h"
+#include "devices/z80.h"
 #include "pc88/fdc.h"
 #include "pc88/pio.h"
 
@@ -28,6 +29,7 @@ class SubSystem : public Device {
     s_set1,
     s_set2,
     s_setcw,
+    s_intr,
   };
   enum { intack = 0, m_read0, m_read1, m_read2, s_read0, s_read1, s_read2 };
 
@@ -47,6 +49,9 @@ class SubSystem : public Device {
   uint8_t* GetROM() { return rom_.get(); }
 
   bool IsBusy();
+  // サブ CPU がコマンド待ちループで停止しているか．
+  // pc, reg, mem_effects はサブ CPU の PC, レジスタ, メモリの副作用カウンタ
+  bool IsWaiting(uint32_t pc, const Z80Reg& reg, uint32_t mem_effects);
 
   void IOCALL Reset(uint32_t = 0, uint32_t = 0);
   uint32_t IOCALL IntAck(uint32_t);
@@ -66,6 +71,7 @@ class SubSystem : public Device {
   uint32_t IOCALL S_Read0(uint32_t);
   uint32_t IOCALL S_Read1(uint32_t);
   uint32_t IOCALL S_Read2(uint32_t);
+  void IOCALL S_Intr(uint32_t, uint32_t data);
 
  private:
   enum {
@@ -79,10 +85,20 @@ class SubSystem : public Device {
     uint8_t ram[0x4000];
   };
 
+  // コマンド待ちとみなすまでに同じ値を読み続ける回数
+  static constexpr uint32_t kWaitReads = 16;
+  // コマンド待ちとみなすまでに PC を確認する回数
+  static constexpr uint32_t kWaitSamples = 2;
+  // コマンド待ちループの最大長
+  static constexpr uint32_t kMaxLoopBytes = 16;
+
   bool InitMemory();
   bool LoadROM();
   void PatchROM();
 
+  void ResetWait();
+  static bool SameLoopState(const Z80Reg& a, const Z80Reg& b);
+
   MemoryManager* mm_ = nullptr;
   int mid_ = -1;
   std::unique_ptr<uint8_t[]> rom_;
@@ -94,6 +110,18 @@ class SubSystem : public Device {
   uint32_t cw_sub_ = 0x80;
   uint32_t idle_count_ = 0;
 
+  // コマンド待ちの検出
+  // サブ CPU が ROM 内の短いループでポート C を読み続け，その値が変わらない間は
+  // メイン側が PIO に書き込むまでサブ CPU を止めておける
+  uint32_t wait_reads_ = 0;  // ポート C から同じ値を読んだ回数
+  uint32_t wait_data_ = 0;
+  uint32_t wait_samples_ = 0;  // ループ内で PC を確認した回数
+  uint32_t wait_pc_lo_ = 0;    // ループの PC 範囲 [lo, hi]
+  uint32_t wait_pc_hi_ = 0;
+  Z80Reg wait_reg_{};  // 前回確認したときのレジスタ
+  uint32_t wait_mem_effects_ = 0;
+  bool suspended_ = false;
+
  private:
   static const Descriptor descriptor;
   static const InFuncPtr indef[];
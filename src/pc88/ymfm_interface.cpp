@@ -105,7 +105,24 @@ bool YMFMInterface::Count(int32_t clocks) {
   return event;
 }
 
+void YMFMInterface::SaveTimer(TimerState* state) {
+  state->count_a = count_a_;
+  state->count_b = count_b_;
+  state->status = ReadStatus() & 0x03;
+}
+
+void YMFMInterface::RestoreTimer(const TimerState& state) {
+  // Flags can only be set by the timers, so clear the ones raised since SaveTimer().
+  // The load bits are unchanged, so this write does not reload the timers.
+  uint32_t raised = ReadStatus() & 0x03 & ~state.status;
+  if (raised)
+    SetReg(0x27, (mode_ & 0xcf) | (raised << 4));
+  count_a_ = state.count_a;
+  count_b_ = state.count_b;
+}
+
 void YMFMInterface::ymfm_sync_mode_write(uint8_t data) {
+  mode_ = data;
   // This will call ymfm_set_timer().
   m_engine->engine_mode_write(data);
   // |data| format
@@ -43,6 +43,15 @@ class YMFMInterface : public ymfm::ymfm_interface {
   uint32_t ReadStatusEx();
   bool Count(int32_t clocks);
 
+  // Timer counters and flags, saved and restored around run-ahead.
+  struct TimerState {
+    int32_t count_a;
+    int32_t count_b;
+    uint32_t status;
+  };
+  void SaveTimer(TimerState* state);
+  void RestoreTimer(const TimerState& state);
+
   // Overrides ymfm::ymfm_interface
   // Called back when the mode register is written.
   void ymfm_sync_mode_write(uint8_t data) override;
@@ -86,6 +95,8 @@ class YMFMInterface : public ymfm::ymfm_interface {
 
   bool timer_a_enabled_ = false;
   bool timer_b_enabled_ = false;
+  // Last value written to the mode register (0x27).
+  uint8_t mode_ = 0;
 };
 
 }  // namespace pc8801
@@ -105,6 +105,7 @@ void SaveConfig(const pc8801::Config* cfg, const std::string_view inifile) {
   // SaveEntry(inifile, "LPFOrder", static_cast<int>(cfg->lpforder));
 
   SaveEntry(inifile, "ROMEOLatency", cfg->romeolatency);
+  SaveEntry(inifile, "RunAheadFrames", cfg->run_ahead_frames);
 
   SaveEntry(inifile, "VolumeFM", cfg->volfm + VOLUME_BIAS);
   SaveEntry(inifile, "VolumeSSG", cfg->volssg + VOLUME_BIAS);
@@ -137,7 +138,7 @@ void LoadConfig(pc8801::Config* cfg, const std::string_view inifile) {
   cfg->set_flags_value(static_cast<pc8801::Config::Flags>(flags));
   cfg->clear_flags(pc8801::Config::kSpecialPalette);
 
-  u = 0;
+  u = pc8801::Config::kSkipSubCPUWait;
   flags = 0;
   LoadConfigEntryU(inifile, "Flag2", &flags, u);
   cfg->set_flag2_value(static_cast<pc8801::Config::Flag2>(flags));
@@ -216,6 +217,9 @@ void LoadConfig(pc8801::Config* cfg, const std::string_view inifile) {
   if (LoadConfigEntry(inifile, "ROMEOLatency", &n, 100))
     cfg->romeolatency = Limit(n, 500, 0);
 
+  if (LoadConfigEntry(inifile, "RunAheadFrames", &n, 0))
+    cfg->run_ahead_frames = Limit(n, 4, 0);
+
   LOADVOLUMEENTRY("VolumeFM", VOLUME_BIAS, cfg->volfm);
   LOADVOLUMEENTRY("VolumeSSG", 97, cfg->volssg);
   LOADVOLUMEENTRY("VolumeADPCM", VOLUME_BIAS, cfg->voladpcm);
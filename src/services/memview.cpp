@@ -20,9 +20,7 @@ bool MemoryViewer::Init(PC88* _pc) {
   mem1_ = pc_->GetMem1();
   mem2_ = pc_->GetMem2();
   z80_ = nullptr;
-#ifdef Z80C_STATISTICS
-  stat_ = nullptr;
-#endif
+  profiler_ = nullptr;
 
   SelectBank(kMainRam, kMainRam, kMainRam, kMainRam, kMainRam);
   return true;
@@ -114,9 +112,7 @@ void MemoryViewer::SelectBank(Type a0, Type a6, Type a8, Type ac, Type af) {
     bus_.SetMemorys(0x2000, 0x2000, mem2_->GetROM());
     bus_.SetMemorys(0x4000, 0x4000, mem2_->GetRAM());
   }
-#ifdef Z80C_STATISTICS
-  stat_ = z80_->GetStatistics();
-#endif
+  profiler_ = z80_->GetProfiler();
   bus_.SetMemorys(0x8000, 0x7000, mem1_->GetRAM() + 0x8000);
   //  bus.SetMemorys(0xc000, 0x3000, mem1->GetRAM()+0xc000);
   // af
@@ -130,4 +126,12 @@ void MemoryViewer::SelectBank(Type a0, Type a6, Type a8, Type ac, Type af) {
   }
   bus_.SetMemorys(0xf000, 0x1000, p);
 }
-}  // namespace services
\ No newline at end of file
+
+// ----------------------------------------------------------------------------
+//  実行回数の記録
+//
+void MemoryViewer::EnableStat(bool enable) {
+  pc_->GetCPU1()->EnableProfiler(enable);
+  pc_->GetCPU2()->EnableProfiler(enable);
+}
+}  // namespace services
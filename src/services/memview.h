@@ -61,9 +61,11 @@ class MemoryViewer {
   MemoryBus* GetBus() { return &bus_; }
   void SelectBank(Type a0, Type a6, Type a8, Type ac, Type af);
 
+  // 実行回数の統計 (Z80Profiler)．EnableStat(true) の間だけ記録される
+  void EnableStat(bool enable);
   void StatClear();
   uint32_t StatExec(uint32_t pc);
-  uint32_t* StatExecBuf();
+  void StatDecay();
 
   uint32_t GetCurrentBank(uint32_t addr);
 
@@ -78,9 +80,7 @@ class MemoryViewer {
   Type bank_[5]{};
 
  protected:
-#ifdef Z80C_STATISTICS
-  Z80C::Statistics* stat_ = nullptr;
-#endif
+  Z80Profiler* profiler_ = nullptr;
 };
 
 inline uint32_t MemoryViewer::GetCurrentBank(uint32_t addr) {
@@ -89,25 +89,19 @@ inline uint32_t MemoryViewer::GetCurrentBank(uint32_t addr) {
 }
 
 inline void MemoryViewer::StatClear() {
-#ifdef Z80C_STATISTICS
-  if (stat_)
-    stat_->Clear();
-#endif
+  if (profiler_)
+    profiler_->Clear();
 }
 
+// 表示中のバンクでの実行回数 (サブ CPU はバンクを区別しない)
 inline uint32_t MemoryViewer::StatExec(uint32_t pc) {
-#ifdef Z80C_STATISTICS
-  if (stat_)
-    return stat_->execute[pc];
-#endif
-  return 0;
+  if (!profiler_)
+    return 0;
+  return profiler_->Count(bank_[1] == kSub ? 0 : GetCurrentBank(pc), pc);
 }
 
-inline uint32_t* MemoryViewer::StatExecBuf() {
-#ifdef Z80C_STATISTICS
-  if (stat_)
-    return stat_->execute;
-#endif
-  return nullptr;
+inline void MemoryViewer::StatDecay() {
+  if (profiler_)
+    profiler_->Decay();
 }
 }  // namespace services
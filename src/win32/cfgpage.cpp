@@ -155,6 +155,14 @@ bool ConfigCPU::Clicked(HWND hdlg, HWND hwctl, UINT id) {
     case IDC_CPU_FDDNOWAIT:
       config_.toggle_flag2(pc8801::Config::kFDDNoWait);
       return true;
+
+    case IDC_CPU_SKIPIDLE:
+      config_.toggle_flag2(pc8801::Config::kSkipIdleLoop);
+      return true;
+
+    case IDC_CPU_SKIPSUBWAIT:
+      config_.toggle_flag2(pc8801::Config::kSkipSubCPUWait);
+      return true;
   }
   return false;
 }
@@ -215,6 +223,9 @@ void ConfigCPU::Update(HWND hdlg) {
   CheckDlgButton(hdlg, IDC_CPU_CLOCKMODE, BSTATE(config_.flags() & pc8801::Config::kCPUClockMode));
   CheckDlgButton(hdlg, IDC_CPU_BURST, BSTATE(config_.flags() & pc8801::Config::kCPUBurst));
   CheckDlgButton(hdlg, IDC_CPU_FDDNOWAIT, BSTATE(!(config_.flag2() & pc8801::Config::kFDDNoWait)));
+  CheckDlgButton(hdlg, IDC_CPU_SKIPIDLE, BSTATE(config_.flag2() & pc8801::Config::kSkipIdleLoop));
+  CheckDlgButton(hdlg, IDC_CPU_SKIPSUBWAIT,
+                 BSTATE(config_.flag2() & pc8801::Config::kSkipSubCPUWait));
   UpdateSlider(hdlg);
 
   static const int item[4] = {IDC_CPU_MS11, IDC_CPU_MS21, IDC_CPU_MSAUTO, IDC_CPU_MSAUTO};
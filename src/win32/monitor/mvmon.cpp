@@ -43,9 +43,14 @@ bool MemViewMonitor::Init(LPCTSTR tmpl, PC88* pc88) {
 BOOL MemViewMonitor::DlgProc(HWND hdlg, UINT msg, WPARAM wp, LPARAM lp) {
   switch (msg) {
     case WM_INITDIALOG:
+      mv.EnableStat(true);
       SetBank();
       break;
 
+    case WM_CLOSE:
+      mv.EnableStat(false);
+      break;
+
     case WM_COMMAND:
       switch (LOWORD(wp)) {
         case IDM_MEM_0_RAM:
@@ -241,11 +246,5 @@ uint32_t MemViewMonitor::StatExec(uint32_t a) {
 
 void MemViewMonitor::StatClear() {
   //  mv.StatClear();
-  uint32_t* st = mv.StatExecBuf();
-  if (st) {
-    for (int i = 0; i < 0x10000; i++) {
-      *st = (*st + 1) / 2;
-      st++;
-    }
-  }
+  mv.StatDecay();
 }
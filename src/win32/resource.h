@@ -147,6 +147,8 @@
 #define IDC_SOUND_192K 1137
 #define IDC_SOUNDDRIVER_DROPDOWN 1138
 #define IDC_USE_SCCI 1139
+#define IDC_CPU_SKIPIDLE 1140
+#define IDC_CPU_SKIPSUBWAIT 1141
 #define IDM_DRIVE_1 40001
 #define IDM_RESET 40003
 #define IDM_ABOUTM88 40004
@@ -249,14 +251,15 @@
 #define IDM_KEY_CURSOR 40242
 #define IDM_KEY_CAPS 40243
 #define IDM_PAUSE 40244
+#define IDM_FAST_FORWARD 40245
 
 // Next default values for new objects
 //
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE 140
-#define _APS_NEXT_COMMAND_VALUE 40245
-#define _APS_NEXT_CONTROL_VALUE 1140
+#define _APS_NEXT_COMMAND_VALUE 40246
+#define _APS_NEXT_CONTROL_VALUE 1142
 #define _APS_NEXT_SYMED_VALUE 101
 #endif
 #endif
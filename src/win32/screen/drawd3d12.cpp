@@ -79,18 +79,26 @@ void WinDrawD3D12::SetGUIMode(bool fullscreen) {
 }
 
 void WinDrawD3D12::DrawScreen(const RECT& rect, bool refresh) {
+  Draw::Region region{};
+  region.Reset();
+  region.Update(rect.left, rect.top, rect.right, rect.bottom - 1);
+  DrawScreen(region, refresh);
+}
+
+void WinDrawD3D12::DrawScreen(const Draw::Region& region, bool refresh) {
   if (::IsWindow(hwnd_) == FALSE)
     return;
 
-  RECT rc = rect;
+  Draw::Region rg = region;
   if (refresh || update_palette_) {
-    ::SetRect(&rc, 0, 0, kTextureWidth, kTextureHeight);
+    rg.Reset();
+    rg.Update(0, 0, kTextureWidth, kTextureHeight - 1);
     update_palette_ = false;
   } else {
-    if (::IsRectEmpty(&rc))
+    if (rg.count == 0)
       return;
   }
-  DrawTexture(rc);
+  DrawTexture(rg);
 }
 
 RECT WinDrawD3D12::GetFullScreenRect() {
@@ -727,7 +735,7 @@ bool WinDrawD3D12::ClearScreen() {
   return true;
 }
 
-bool WinDrawD3D12::DrawTexture(const RECT& rect) {
+bool WinDrawD3D12::DrawTexture(const Draw::Region& region) {
   auto rtv_h = PrepareCommandList();
 
   PrepareVerticesForTexture();
@@ -736,7 +744,7 @@ bool WinDrawD3D12::DrawTexture(const RECT& rect) {
   cmd_list_->SetPipelineState(pipeline_state_.get());
   cmd_list_->SetGraphicsRootSignature(root_signature_.get());
 
-  if (!RenderTexture(rect))
+  if (!RenderTexture(region))
     return false;
 
   SetUpViewPort();
@@ -749,16 +757,19 @@ bool WinDrawD3D12::DrawTexture(const RECT& rect) {
   return true;
 }
 
-bool WinDrawD3D12::RenderTexture(const RECT& rect) {
-  for (int y = rect.top; y < rect.bottom; ++y) {
-    for (int x = rect.left; x < rect.right; ++x) {
-      auto& rgba = texturedata_[y * kTextureWidth + x];
-      uint8_t col = image_[y * bpl_ + x];
-      Palette pal = pal_[col];
-      rgba.R = pal.red;
-      rgba.G = pal.green;
-      rgba.B = pal.blue;
-      rgba.A = 255;
+bool WinDrawD3D12::RenderTexture(const Draw::Region& region) {
+  for (int i = 0; i < region.count; ++i) {
+    const Draw::Region::Rect& rect = region.rects[i];
+    for (int y = rect.top; y <= rect.bottom; ++y) {
+      for (int x = rect.left; x < rect.right; ++x) {
+        auto& rgba = texturedata_[y * kTextureWidth + x];
+        uint8_t col = image_[y * bpl_ + x];
+        Palette pal = pal_[col];
+        rgba.R = pal.red;
+        rgba.G = pal.green;
+        rgba.B = pal.blue;
+        rgba.A = 255;
+      }
     }
   }
 
@@ -769,7 +780,14 @@ bool WinDrawD3D12::RenderTexture(const RECT& rect) {
   if (FAILED(hr)) {
     return false;
   }
-  std::copy_n(texturedata_.data(), texturedata_.size(), map_for_img);
+  // 書き換えた矩形だけを転送する．アップロードバッファの他の部分は前回の内容のまま
+  for (int i = 0; i < region.count; ++i) {
+    const Draw::Region::Rect& rect = region.rects[i];
+    for (int y = rect.top; y <= rect.bottom; ++y) {
+      int offset = y * kTextureWidth + rect.left;
+      std::copy_n(texturedata_.data() + offset, rect.right - rect.left, map_for_img + offset);
+    }
+  }
   upload_buffer_->Unmap(0, nullptr);
 
   D3D12_TEXTURE_COPY_LOCATION src = {};
@@ -798,15 +816,18 @@ bool WinDrawD3D12::RenderTexture(const RECT& rect) {
     cmd_list_->ResourceBarrier(1, &barrier_desc);
   }
 
-  D3D12_BOX src_region;
-  src_region.left = rect.left;
-  src_region.top = rect.top;
-  src_region.right = rect.right;
-  src_region.bottom = rect.bottom;
-  src_region.front = 0;
-  src_region.back = 1;
-
-  cmd_list_->CopyTextureRegion(&dst, rect.left, rect.top, 0, &src, &src_region);
+  for (int i = 0; i < region.count; ++i) {
+    const Draw::Region::Rect& rect = region.rects[i];
+    D3D12_BOX src_region;
+    src_region.left = rect.left;
+    src_region.top = rect.top;
+    src_region.right = rect.right;
+    src_region.bottom = rect.bottom + 1;
+    src_region.front = 0;
+    src_region.back = 1;
+
+    cmd_list_->CopyTextureRegion(&dst, rect.left, rect.top, 0, &src, &src_region);
+  }
 
   {
     D3D12_RESOURCE_BARRIER barrier_desc = {};
@@ -31,6 +31,7 @@ class WinDrawD3D12 : public WinDrawSub {
   void SetPalette(Draw::Palette* pe, int index, int nentries) override;
   void SetGUIMode(bool fullscreen) override;
   void DrawScreen(const RECT& rect, bool refresh) override;
+  void DrawScreen(const Draw::Region& region, bool refresh) override;
   RECT GetFullScreenRect() override;
 
   bool Lock(uint8_t** image, int* bpl) override;
@@ -61,8 +62,8 @@ class WinDrawD3D12 : public WinDrawSub {
   bool SetUpTexturePipeline();
 
   bool ClearScreen();
-  bool DrawTexture(const RECT& rect);
-  bool RenderTexture(const RECT& rect);
+  bool DrawTexture(const Draw::Region& region);
+  bool RenderTexture(const Draw::Region& region);
 
   void WaitForGPU();
 
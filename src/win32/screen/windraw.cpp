@@ -29,6 +29,7 @@
 //
 WinDraw::WinDraw() {
   drawing_ = false;
+  draw_region_.Reset();
 }
 
 WinDraw::~WinDraw() {
@@ -133,10 +134,12 @@ void WinDraw::DrawScreen(const Region& region) {
   if (!drawing_) {
     Log("Draw %d to %d\n", region.top, region.bottom);
     drawing_ = true;
-    draw_area_.left = std::max(0, region.left);
-    draw_area_.top = std::max(0, region.top);
-    draw_area_.right = std::min(width_, region.right);
-    draw_area_.bottom = std::min(height_, region.bottom + 1);
+    draw_region_.Reset();
+    for (int i = 0; i < region.count; ++i) {
+      const Region::Rect& rc = region.rects[i];
+      draw_region_.Update(std::max(0, rc.left), std::max(0, rc.top), std::min(width_, rc.right),
+                          std::min(height_ - 1, rc.bottom));
+    }
 #ifdef DRAW_THREAD
     ::SetEvent(hevredraw_.get());
 #else
@@ -152,7 +155,7 @@ void WinDraw::PaintWindow() {
   LOADBEGIN("WinDraw");
   std::lock_guard<std::mutex> lock(mtx_);
   if (drawing_ && drawsub_ && active_) {
-    RECT rect = draw_area_;
+    Region region = draw_region_;
     if (pal_change_begin_ <= pal_change_end_) {
       pal_region_begin_ = std::min(pal_change_begin_, pal_region_begin_);
       pal_region_end_ = std::max(pal_change_end_, pal_region_end_);
@@ -161,11 +164,12 @@ void WinDraw::PaintWindow() {
       pal_change_begin_ = 0x100;
       pal_change_end_ = -1;
     }
-    drawsub_->DrawScreen(rect, draw_all_);
+    drawsub_->DrawScreen(region, draw_all_);
     draw_all_ = false;
-    if (rect.left < rect.right && rect.top < rect.bottom) {
+    if (region.Valid()) {
       draw_count_++;
-      Log("\t\t\t(%3d,%3d)-(%3d,%3d)\n", rect.left, rect.top, rect.right - 1, rect.bottom - 1);
+      Log("\t\t\t(%3d,%3d)-(%3d,%3d) %d rects\n", region.left, region.top, region.right - 1,
+          region.bottom, region.count);
       // statusdisplay.Show(100, 0, "(%.3d, %.3d)-(%.3d, %.3d)", rect.left, rect.top,
       //                    rect.right-1, rect.bottom-1);
     }
@@ -33,6 +33,13 @@ class WinDrawSub {
   virtual void SetPalette(Draw::Palette* pal, int index, int nentries) {}
   virtual void QueryNewPalette() {}
   virtual void DrawScreen(const RECT& rect, bool refresh) = 0;
+  // 矩形ごとに更新できるものは override する
+  virtual void DrawScreen(const Draw::Region& region, bool refresh) {
+    RECT rect{};
+    if (region.Valid())
+      rect = {region.left, region.top, region.right, region.bottom + 1};
+    DrawScreen(rect, refresh);
+  }
   virtual RECT GetFullScreenRect() { return {}; }
 
   virtual bool Lock(uint8_t** pimage, int* pbpl) { return false; }
@@ -114,7 +121,7 @@ class WinDraw : public Draw, public Threadable<WinDraw> {
 
   // TODO: use bool
   int refresh_ = 0;
-  RECT draw_area_{};  // 書き換える領域
+  Draw::Region draw_region_{};  // 書き換える領域
   int draw_count_ = 0;
   int gui_count_ = 0;
 
@@ -1234,6 +1234,11 @@ LRESULT WinUI::WmCommand(HWND hwnd, WPARAM wparam, LPARAM) {
       ApplyConfig();
       break;
 
+    case IDM_FAST_FORWARD:
+      fast_forward_ = !fast_forward_;
+      core_.SetFastForward(fast_forward_);
+      break;
+
     case IDM_4MHZ:
       this->config().legacy_clock = 40;
       Reset();
@@ -1729,6 +1734,7 @@ LRESULT WinUI::WmInitMenu(HWND, WPARAM wp, LPARAM) {
 
   CheckMenuItem(hmenu_, IDM_CPU_BURST,
                 (flags() & pc8801::Config::kCPUBurst) ? MF_CHECKED : MF_UNCHECKED);
+  CheckMenuItem(hmenu_, IDM_FAST_FORWARD, fast_forward_ ? MF_CHECKED : MF_UNCHECKED);
   CheckMenuItem(hmenu_, IDM_PAUSE, paused_ ? MF_CHECKED : MF_UNCHECKED);
 
   CheckMenuItem(hmenu_, IDM_KEY_GRPH, keyif_.IsGrphLocked() ? MF_CHECKED : MF_UNCHECKED);
@@ -1924,14 +1930,22 @@ LRESULT WinUI::WmTimer(HWND hwnd, WPARAM wparam, LPARAM) {
     // 実効周波数,表示フレーム数を取得
     int fcount = draw_.GetDrawCount();
     int64_t icount = core_.GetExecClocks();
+    FrameTimeStats frame_stats;
+    core_.GetFrameTimeStats(&frame_stats);
 
     // レポートする場合はタイトルバーを更新
     if (report_) {
       if (active_) {
-        char buf[64];
+        char buf[128];
         int64_t freq100 = icount / 10000;
-        wsprintf(buf, "M88k - %d fps.  %d.%.2d MHz", fcount, int(freq100 / 100),
-                 int(freq100 % 100));
+        int len = wsprintf(buf, "M88k - %d fps.  %d.%.2d MHz", fcount, int(freq100 / 100),
+                           int(freq100 % 100));
+        // フレーム時間の中央値と 99 パーセンタイル (0.01ms 単位)
+        if (frame_stats.count()) {
+          int p50 = int(frame_stats.PercentileNS(50) / 10000);
+          int p99 = int(frame_stats.PercentileNS(99) / 10000);
+          wsprintf(buf + len, "  %d.%.2d/%d.%.2d ms", p50 / 100, p50 % 100, p99 / 100, p99 % 100);
+        }
         SetWindowText(hwnd, buf);
       } else
         SetWindowText(hwnd, "M88k");
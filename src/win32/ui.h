@@ -144,6 +144,7 @@ class WinUI {
   bool capture_mouse_ = true;
   uint32_t mouse_button_ = 0;
   bool paused_ = false;
+  bool fast_forward_ = false;
 
   WinCore core_;
   WinDraw draw_;
@@ -121,6 +121,8 @@ void WinCore::ApplyConfig2(const pc8801::Config* config) {
   seq_.SetLegacyClock(c);
   seq_.SetCPUClock(cpu_clock);
   seq_.SetSpeed(config->speed / 10);
+  seq_.SetPrecisePacing(!!(config->flag2() & pc8801::Config::kPrecisePacing));
+  seq_.SetRunAhead(config->run_ahead_frames);
 
   if (pc88_.GetJoyPad())
     pc88_.GetJoyPad()->Connect(&pad_if_);
@@ -135,22 +137,22 @@ void WinCore::ApplyConfig2(const pc8801::Config* config) {
 bool WinCore::ConnectDevices(WinKeyIF* keyb) {
   static const IOBus::Connector c_keyb[] = {{PC88::kPReset, IOBus::portout, WinKeyIF::reset},
                                             {PC88::kVrtc, IOBus::portout, WinKeyIF::vsync},
-                                            {0x00, IOBus::portin, WinKeyIF::in},
-                                            {0x01, IOBus::portin, WinKeyIF::in},
-                                            {0x02, IOBus::portin, WinKeyIF::in},
-                                            {0x03, IOBus::portin, WinKeyIF::in},
-                                            {0x04, IOBus::portin, WinKeyIF::in},
-                                            {0x05, IOBus::portin, WinKeyIF::in},
-                                            {0x06, IOBus::portin, WinKeyIF::in},
-                                            {0x07, IOBus::portin, WinKeyIF::in},
-                                            {0x08, IOBus::portin, WinKeyIF::in},
-                                            {0x09, IOBus::portin, WinKeyIF::in},
-                                            {0x0a, IOBus::portin, WinKeyIF::in},
-                                            {0x0b, IOBus::portin, WinKeyIF::in},
-                                            {0x0c, IOBus::portin, WinKeyIF::in},
-                                            {0x0d, IOBus::portin, WinKeyIF::in},
-                                            {0x0e, IOBus::portin, WinKeyIF::in},
-                                            {0x0f, IOBus::portin, WinKeyIF::in},
+                                            {0x00, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x01, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x02, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x03, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x04, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x05, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x06, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x07, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x08, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x09, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x0a, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x0b, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x0c, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x0d, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x0e, IOBus::portin | IOBus::pure, WinKeyIF::in},
+                                            {0x0f, IOBus::portin | IOBus::pure, WinKeyIF::in},
                                             {0, 0, 0}};
   if (!pc88_.GetBus1()->Connect(keyb, c_keyb))
     return false;
@@ -48,7 +48,12 @@ class WinCore : public ISystem, public ILockCore {
   WinSound* GetSound() { return &sound_; }
 
   int64_t GetExecClocks() { return seq_.GetExecClocks(); }
+  void GetFrameTimeStats(FrameTimeStats* stats) { seq_.GetFrameTimeStats(stats); }
   void Wait(bool dowait) { dowait ? seq_.Deactivate() : seq_.Activate(); }
+  void SetFastForward(bool enable) {
+    sound_.Mute(enable);
+    seq_.SetFastForward(enable);
+  }
   void* IFCALL QueryIF(REFIID iid) override;
   void IFCALL Lock() override { seq_.Lock(); }
   void IFCALL Unlock() override { seq_.Unlock(); }
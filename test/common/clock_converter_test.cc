@@ -0,0 +1,30 @@
+#include "common/clock_converter.h"
+
+#include "gtest/gtest.h"
+
+TEST(ClockConverterTest, MatchesDivision) {
+  // 通常のクロック，10MHz 相当 (8MHz 機の高速モード)，バーストモードの実効クロック
+  for (uint64_t hz : {3993600ULL, 7987200ULL, 100000ULL, 123456789ULL, 1000000000ULL}) {
+    ClockConverter conv(hz);
+    EXPECT_EQ(hz, conv.hz());
+    EXPECT_EQ(int64_t(kNanoSecsPerSec / hz), conv.ClocksToNS(1));
+    for (int64_t ns = 0; ns < 200000; ns += 7)
+      ASSERT_EQ(int64_t(ns * hz / kNanoSecsPerSec), conv.NSToClocks(ns)) << hz << " " << ns;
+    for (int64_t ns : {16666667LL, 1000000000LL, 4294967295LL, 4294967296LL})
+      EXPECT_EQ(int64_t(ns * hz / kNanoSecsPerSec), conv.NSToClocks(ns)) << hz << " " << ns;
+  }
+}
+
+TEST(ClockConverterTest, ExactMultiples) {
+  // ちょうど割り切れる時間で 1 少なくならない
+  ClockConverter conv(4000000);
+  EXPECT_EQ(1, conv.NSToClocks(250));
+  EXPECT_EQ(0, conv.NSToClocks(249));
+  EXPECT_EQ(4000000, conv.NSToClocks(kNanoSecsPerSec));
+  EXPECT_EQ(0, conv.NSToClocks(-100));
+  EXPECT_EQ(240000000, conv.NSToClocks(60 * kNanoSecsPerSec));
+
+  conv.SetClock(3993600);
+  EXPECT_EQ(3993600, conv.NSToClocks(kNanoSecsPerSec));
+  EXPECT_EQ(250, conv.ClocksToNS(1));
+}
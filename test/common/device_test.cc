@@ -4,6 +4,8 @@
 
 #include "gtest/gtest.h"
 
+#include <vector>
+
 class DeviceListTest : public testing::Test {
  public:
   DeviceListTest() = default;
@@ -92,3 +94,46 @@ TEST(DeviceListTest, MultiDev2) {
   x = devlist.Find(0x3);
   EXPECT_EQ(x, nullptr);
 }
+
+namespace {
+// 1 バイトの状態を持つデバイス
+class StatusDevice : public Device {
+ public:
+  explicit StatusDevice(ID id) : Device(id) {}
+
+  uint32_t IFCALL GetStatusSize() override { return 1; }
+  bool IFCALL SaveStatus(uint8_t* status) override {
+    *status = value;
+    return true;
+  }
+  bool IFCALL LoadStatus(const uint8_t* status) override {
+    value = *status;
+    return true;
+  }
+
+  uint8_t value = 0;
+};
+}  // namespace
+
+TEST(DeviceListTest, SkipStatus) {
+  DeviceList devlist;
+  StatusDevice dev1(0x1);
+  StatusDevice dev2(0x2);
+  devlist.Add(&dev1);
+  devlist.Add(&dev2);
+
+  const IDevice::ID skip[] = {0x2};
+  EXPECT_LT(devlist.GetStatusSize(skip), devlist.GetStatusSize());
+
+  std::vector<uint8_t> buf(devlist.GetStatusSize(skip));
+  dev1.value = 1;
+  dev2.value = 2;
+  EXPECT_TRUE(devlist.SaveStatus(buf.data(), skip));
+
+  // 保存しなかったデバイスの状態はそのまま
+  dev1.value = 3;
+  dev2.value = 4;
+  EXPECT_TRUE(devlist.LoadStatus(buf.data()));
+  EXPECT_EQ(1, dev1.value);
+  EXPECT_EQ(4, dev2.value);
+}
@@ -0,0 +1,84 @@
+#include "common/draw.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+Draw::Region MakeRegion() {
+  Draw::Region region{};
+  region.Reset();
+  return region;
+}
+
+TEST(DrawRegionTest, Empty) {
+  Draw::Region region = MakeRegion();
+  EXPECT_FALSE(region.Valid());
+  EXPECT_EQ(0, region.count);
+
+  region.Update(8, 10, 8, 20);  // 幅が 0
+  region.Update(0, 10, 8, 9);   // 高さが 0
+  EXPECT_FALSE(region.Valid());
+  EXPECT_EQ(0, region.count);
+}
+
+TEST(DrawRegionTest, SeparateRects) {
+  Draw::Region region = MakeRegion();
+  region.Update(0, 0, 8, 15);         // 左上のカーソル
+  region.Update(600, 380, 640, 399);  // 右下
+  ASSERT_TRUE(region.Valid());
+  EXPECT_EQ(0, region.left);
+  EXPECT_EQ(0, region.top);
+  EXPECT_EQ(640, region.right);
+  EXPECT_EQ(399, region.bottom);
+
+  ASSERT_EQ(2, region.count);
+  EXPECT_EQ(8, region.rects[0].right);
+  EXPECT_EQ(15, region.rects[0].bottom);
+  EXPECT_EQ(600, region.rects[1].left);
+  EXPECT_EQ(380, region.rects[1].top);
+}
+
+TEST(DrawRegionTest, MergeTouching) {
+  Draw::Region region = MakeRegion();
+  region.Update(0, 0, 640, 1);
+  region.Update(0, 2, 640, 3);  // 下に接する
+  region.Update(0, 4, 640, 5);
+  ASSERT_EQ(1, region.count);
+  EXPECT_EQ(0, region.rects[0].top);
+  EXPECT_EQ(5, region.rects[0].bottom);
+
+  // 2 つの矩形をつなぐ矩形は両方とまとめる
+  region.Update(0, 10, 640, 11);
+  ASSERT_EQ(2, region.count);
+  region.Update(0, 6, 640, 9);
+  ASSERT_EQ(1, region.count);
+  EXPECT_EQ(0, region.rects[0].top);
+  EXPECT_EQ(11, region.rects[0].bottom);
+}
+
+TEST(DrawRegionTest, Overflow) {
+  Draw::Region region = MakeRegion();
+  for (int i = 0; i < Draw::Region::kMaxRects + 4; ++i)
+    region.Update(0, i * 40, 8, i * 40 + 15);
+  EXPECT_EQ(Draw::Region::kMaxRects, region.count);
+
+  // すべての行がどれかの矩形に含まれている
+  for (int i = 0; i < Draw::Region::kMaxRects + 4; ++i) {
+    bool covered = false;
+    for (int j = 0; j < region.count; ++j) {
+      const Draw::Region::Rect& rc = region.rects[j];
+      covered |= rc.top <= i * 40 && i * 40 + 15 <= rc.bottom;
+    }
+    EXPECT_TRUE(covered) << i;
+  }
+  EXPECT_EQ(0, region.top);
+  EXPECT_EQ((Draw::Region::kMaxRects + 3) * 40 + 15, region.bottom);
+}
+
+TEST(DrawRegionTest, FullLine) {
+  Draw::Region region = MakeRegion();
+  region.Update(100, 120);
+  ASSERT_EQ(1, region.count);
+  EXPECT_EQ(0, region.rects[0].left);
+  EXPECT_EQ(640, region.rects[0].right);
+}
+}  // namespace
@@ -0,0 +1,44 @@
+#include "common/frame_time_stats.h"
+
+#include "gtest/gtest.h"
+
+TEST(FrameTimeStatsTest, Empty) {
+  FrameTimeStats stats;
+  EXPECT_EQ(0U, stats.count());
+  EXPECT_EQ(0, stats.min_ns());
+  EXPECT_EQ(0, stats.mean_ns());
+  EXPECT_EQ(0, stats.PercentileNS(99));
+}
+
+TEST(FrameTimeStatsTest, Percentiles) {
+  FrameTimeStats stats;
+  // 60Hz のフレームが 98 回，遅れたフレームが 2 回
+  for (int i = 0; i < 98; ++i)
+    stats.Add(16666667);
+  stats.Add(20000000);
+  stats.Add(33333333);
+
+  EXPECT_EQ(100U, stats.count());
+  EXPECT_EQ(16666667, stats.min_ns());
+  EXPECT_EQ(33333333, stats.max_ns());
+  EXPECT_EQ((98 * 16666667LL + 20000000 + 33333333) / 100, stats.mean_ns());
+  // バケットの上端 (0.25ms 単位) で返る
+  EXPECT_EQ(16750000, stats.PercentileNS(50));
+  EXPECT_EQ(16750000, stats.PercentileNS(98));
+  EXPECT_EQ(20250000, stats.PercentileNS(99));
+  EXPECT_EQ(33333333, stats.PercentileNS(100));
+
+  stats.Clear();
+  EXPECT_EQ(0U, stats.count());
+  EXPECT_EQ(0, stats.max_ns());
+}
+
+TEST(FrameTimeStatsTest, LongFrames) {
+  FrameTimeStats stats;
+  // 50ms 以上は最後のバケットにまとめる
+  stats.Add(1000000000);
+  stats.Add(-1);
+  EXPECT_EQ(0, stats.min_ns());
+  EXPECT_EQ(250000, stats.PercentileNS(50));
+  EXPECT_EQ(1000000000, stats.PercentileNS(100));
+}
@@ -0,0 +1,66 @@
+#include "common/headless_driver.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace {
+// 実行した時間と画面更新の回数を記録する VM
+// 1 回の ProceedNS では要求より少し長く (命令の途中まで) 実行する
+class FakeVM : public EmulationLoopDelegate {
+ public:
+  int64_t ProceedNS(uint64_t /*cpu_clock*/, int64_t ns, int64_t /*effective_clock*/) override {
+    int64_t executed = ns + (state_ % 7) * 250;
+    state_ = state_ * 1103515245 + 12345 + executed;
+    history_.push_back(state_);
+    return executed;
+  }
+  void TimeSync() override { ++syncs_; }
+  void UpdateScreen(bool /*refresh*/) override { ++updates_; }
+  uint64_t GetFramePeriodNS() override { return 16666667; }
+
+  [[nodiscard]] const std::vector<uint64_t>& history() const { return history_; }
+  [[nodiscard]] int syncs() const { return syncs_; }
+  [[nodiscard]] int updates() const { return updates_; }
+
+ private:
+  uint64_t state_ = 1;
+  std::vector<uint64_t> history_;
+  int syncs_ = 0;
+  int updates_ = 0;
+};
+}  // namespace
+
+TEST(HeadlessDriverTest, RunsFrames) {
+  FakeVM vm;
+  HeadlessDriver driver;
+  driver.Init(&vm);
+  driver.SetCPUClock(4000000);
+  driver.SetPresentInterval(3);
+
+  int64_t ns = driver.RunFrames(10);
+  EXPECT_GE(ns, 10 * 16666667LL);
+  EXPECT_EQ(10U, driver.frames());
+  EXPECT_EQ(ns, driver.emulated_ns());
+  EXPECT_EQ(10, vm.syncs());
+  EXPECT_EQ(3, vm.updates());
+  // フレームごとに端数を切り捨てる
+  EXPECT_NEAR(4000000 * ns / 1000000000, driver.exec_clocks(), 10);
+  // 仮想時計は実行した時間だけ進む
+  EXPECT_EQ(uint64_t(ns), driver.time()->GetTimeNS());
+}
+
+TEST(HeadlessDriverTest, Deterministic) {
+  FakeVM vm1;
+  FakeVM vm2;
+  HeadlessDriver driver1;
+  HeadlessDriver driver2;
+  driver1.Init(&vm1);
+  driver2.Init(&vm2);
+  driver2.SetPresentInterval(0);
+
+  // 画面更新の間隔や実行の区切りが違っても VM の実行は変わらない
+  EXPECT_EQ(driver1.RunFrames(60), driver2.RunFrames(20) + driver2.RunFrames(40));
+  EXPECT_EQ(vm1.history(), vm2.history());
+  EXPECT_EQ(0, vm2.updates());
+}
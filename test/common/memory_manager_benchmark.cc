@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "common/memory_manager.h"
+#include "../devices/z80_test_system.h"
+
+namespace {
+// 1 回の計測でアクセスする回数
+constexpr int kAccesses = 0x10000;
+
+class MemoryBench {
+ public:
+  // 64 ページのうち handler_pages ページをアクセス関数に割り当てる
+  explicit MemoryBench(int handler_pages) {
+    for (int i = 0; i < 0x10000; ++i)
+      memory_.ram()[i] = uint8_t(i * 7);
+
+    memory_.Init(read_, write_);
+    for (int i = 0; i < handler_pages; ++i) {
+      uint32_t addr = ((i * 5) & 0x3f) << MemoryManager::pagebits;
+      memory_.MapHandler(addr, 1 << MemoryManager::pagebits);
+    }
+
+    // ページを跨いで散らばったアドレス列 (Z80 のスタックや VRAM アクセスを想定)
+    addrs_.resize(kAccesses);
+    uint32_t a = 0x1234;
+    for (auto& addr : addrs_) {
+      a = a * 1103515245 + 12345;
+      addr = (a >> 8) & 0xffff;
+    }
+  }
+
+  MemoryManager& mm() { return *memory_.mm(); }
+  const std::vector<uint32_t>& addrs() const { return addrs_; }
+
+ private:
+  MemoryPage read_[0x10000 >> MemoryManager::pagebits]{};
+  MemoryPage write_[0x10000 >> MemoryManager::pagebits]{};
+  Z80TestMemory memory_;
+  std::vector<uint32_t> addrs_;
+};
+
+// state.range(0): アクセス関数に割り当てるページ数
+void BM_MemoryManager_Read8(benchmark::State& state) {
+  MemoryBench bench(static_cast<int>(state.range(0)));
+  MemoryManager& mm = bench.mm();
+  const auto& addrs = bench.addrs();
+
+  for (auto _ : state) {
+    uint32_t sum = 0;
+    for (uint32_t addr : addrs)
+      sum += mm.Read8(addr);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kAccesses);
+}
+
+void BM_MemoryManager_Write8(benchmark::State& state) {
+  MemoryBench bench(static_cast<int>(state.range(0)));
+  MemoryManager& mm = bench.mm();
+  const auto& addrs = bench.addrs();
+
+  for (auto _ : state) {
+    for (uint32_t addr : addrs)
+      mm.Write8(addr, addr);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kAccesses);
+}
+
+// 読んだ値を別のアドレスに書き戻す (LD (DE),A のような転送)
+void BM_MemoryManager_ReadWrite8(benchmark::State& state) {
+  MemoryBench bench(static_cast<int>(state.range(0)));
+  MemoryManager& mm = bench.mm();
+  const auto& addrs = bench.addrs();
+
+  for (auto _ : state) {
+    for (uint32_t addr : addrs)
+      mm.Write8(addr ^ 0x8000, mm.Read8(addr));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kAccesses * 2);
+}
+}  // namespace
+
+BENCHMARK(BM_MemoryManager_Read8)->Arg(0)->Arg(8)->Arg(64);
+BENCHMARK(BM_MemoryManager_Write8)->Arg(0)->Arg(8)->Arg(64);
+BENCHMARK(BM_MemoryManager_ReadWrite8)->Arg(0)->Arg(8);
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "common/device.h"
+#include "common/scheduler.h"
+
+namespace {
+class NullScheduler : public Scheduler {
+ public:
+  NullScheduler() = default;
+  ~NullScheduler() override = default;
+
+ private:
+  int64_t ExecuteNS(int64_t ns) override { return ns; }
+  void ShortenNS(int64_t ns) override {}
+  int64_t GetNS() override { return 0; }
+};
+
+class CountDevice : public Device {
+ public:
+  CountDevice() : Device(0x1) {}
+  ~CountDevice() override = default;
+
+  void IOCALL OnEvent(uint32_t arg) { count_ += arg; }
+  [[nodiscard]] uint32_t count() const { return count_; }
+
+ private:
+  uint32_t count_ = 0;
+};
+
+// 周期の異なるリピートイベントを state.range(0) 個登録して時間を進める
+void BM_Scheduler_ProceedNS(benchmark::State& state) {
+  NullScheduler sched;
+  sched.Init();
+  CountDevice dev;
+  for (int i = 0; i < state.range(0); ++i)
+    sched.AddEventNS(10000 + i * 137, &dev, static_cast<IDevice::TimeFunc>(&CountDevice::OnEvent),
+                     1, true);
+
+  for (auto _ : state)
+    sched.ProceedNS(1000000);
+  benchmark::DoNotOptimize(dev.count());
+  state.SetItemsProcessed(int64_t(dev.count()));
+}
+
+// 一度だけのイベントの追加と削除を繰り返す (CRTC や FDC のような使い方)
+void BM_Scheduler_AddDelEvent(benchmark::State& state) {
+  NullScheduler sched;
+  sched.Init();
+  CountDevice dev;
+  std::vector<Scheduler::Event*> events(state.range(0));
+  for (int i = 0; i < state.range(0); ++i)
+    events[i] = sched.AddEventNS(10000 + i * 137, &dev,
+                                 static_cast<IDevice::TimeFunc>(&CountDevice::OnEvent), 1, false);
+
+  int i = 0;
+  for (auto _ : state) {
+    sched.DelEvent(events[i]);
+    events[i] = sched.AddEventNS(5000 + i * 71, &dev,
+                                 static_cast<IDevice::TimeFunc>(&CountDevice::OnEvent), 1, false);
+    if (++i == state.range(0))
+      i = 0;
+  }
+}
+}  // namespace
+
+BENCHMARK(BM_Scheduler_ProceedNS)->Arg(8)->Arg(32)->Arg(128);
+BENCHMARK(BM_Scheduler_AddDelEvent)->Arg(8)->Arg(32)->Arg(128);
@@ -3,6 +3,9 @@
 #include "common/device.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <vector>
+
 class MockScheduler : public Scheduler {
  public:
   MockScheduler() = default;
@@ -123,4 +126,158 @@ TEST_F(SchedulerTest, TestOneShotEventDeletion2) {
   sched_->Proceed(1);
   EXPECT_EQ(sched_->GetTime(), 2);
   EXPECT_FALSE(dev_.event_received());
-}
\ No newline at end of file
+}
+TEST_F(SchedulerTest, TestRepeatedEventInterval) {
+  // 途中から登録したリピートイベントも同じ間隔で発火する
+  sched_->Proceed(5);
+  sched_->AddEvent(3, &dev_, static_cast<IDevice::TimeFunc>(&TestDevice::OnEvent), 0, true);
+  for (int i = 0; i < 4; ++i) {
+    dev_.Reset();
+    sched_->Proceed(2);
+    EXPECT_FALSE(dev_.event_received());
+    sched_->Proceed(1);
+    EXPECT_TRUE(dev_.event_received());
+  }
+}
+
+TEST_F(SchedulerTest, TestManyEvents) {
+  // 同時に有効なイベントの数に上限はない
+  constexpr int kEvents = 100;
+  std::vector<TestDevice> devs;
+  for (int i = 0; i < kEvents; ++i)
+    devs.emplace_back(0x100 + i);
+  std::vector<SchedulerEvent*> events;
+  for (int i = 0; i < kEvents; ++i) {
+    events.push_back(sched_->AddEvent(kEvents - i, &devs[i],
+                                      static_cast<IDevice::TimeFunc>(&TestDevice::OnEvent), i,
+                                      false));
+    ASSERT_NE(nullptr, events.back());
+  }
+  // ハンドルは他のイベントの追加や削除で変わらない
+  for (int i = 0; i < kEvents; i += 2)
+    sched_->DelEvent(events[i]);
+  sched_->DelEvent(&devs[1]);
+
+  for (int t = 1; t <= kEvents; ++t) {
+    sched_->Proceed(1);
+    for (int i = 0; i < kEvents; ++i) {
+      bool expected = i % 2 && i != 1 && kEvents - i == t;
+      EXPECT_EQ(expected, devs[i].event_received()) << "t=" << t << " i=" << i;
+      if (expected) {
+        EXPECT_EQ(uint32_t(i), devs[i].passed_arg());
+      }
+      devs[i].Reset();
+    }
+  }
+}
+
+TEST_F(SchedulerTest, TestRestoreState) {
+  TestDevice other(0x2);
+  SchedulerEvent* handle =
+      sched_->AddEvent(3, &dev_, static_cast<IDevice::TimeFunc>(&TestDevice::OnEvent), 1, true);
+  sched_->RegisterHandle(&handle);
+  sched_->RegisterHandle(&handle);
+  SchedulerEvent* saved = handle;
+
+  Scheduler::State state;
+  sched_->Proceed(1);
+  sched_->SaveState(&state);
+
+  // 保存後にイベントを削除・追加して進める
+  sched_->DelEvent(handle);
+  handle = nullptr;
+  sched_->AddEvent(1, &other, static_cast<IDevice::TimeFunc>(&TestDevice::OnEvent), 2, false);
+  sched_->Proceed(5);
+  EXPECT_FALSE(dev_.event_received());
+  EXPECT_TRUE(other.event_received());
+
+  // 復元すると時刻・イベント・ハンドルが保存した時点に戻る
+  for (int i = 0; i < 2; ++i) {
+    sched_->RestoreState(state);
+    EXPECT_EQ(1, sched_->GetTime());
+    EXPECT_EQ(saved, handle);
+    dev_.Reset();
+    other.Reset();
+    sched_->Proceed(1);
+    EXPECT_FALSE(dev_.event_received());
+    sched_->Proceed(1);
+    EXPECT_TRUE(dev_.event_received());
+    EXPECT_FALSE(other.event_received());
+    dev_.Reset();
+    sched_->Proceed(3);
+    EXPECT_TRUE(dev_.event_received());
+  }
+}
+
+TEST_F(SchedulerTest, TestHoldEvents) {
+  TestDevice other(0x2);
+  SchedulerEvent* handle =
+      sched_->AddEvent(3, &dev_, static_cast<IDevice::TimeFunc>(&TestDevice::OnEvent), 1, true);
+  sched_->RegisterHandle(&handle);
+  SchedulerEvent* saved = handle;
+  Scheduler::State state;
+  sched_->SaveState(&state);
+  sched_->Proceed(1);
+
+  // 止めている間の追加・削除は無視される
+  sched_->HoldEvents(true);
+  sched_->DelEvent(handle);
+  sched_->DelEvent(&dev_);
+  handle = sched_->AddEvent(1, &other, static_cast<IDevice::TimeFunc>(&TestDevice::OnEvent), 2,
+                            false);
+  EXPECT_EQ(nullptr, handle);
+  sched_->HoldEvents(false);
+
+  sched_->RestoreState(state);
+  EXPECT_EQ(saved, handle);
+  sched_->Proceed(3);
+  EXPECT_TRUE(dev_.event_received());
+  EXPECT_FALSE(other.event_received());
+}
+
+// ExecuteNS の途中でイベントを追加するスケジューラ
+class ShortenScheduler : public Scheduler {
+ public:
+  ShortenScheduler(TestDevice* dev) : dev_(dev) {}
+  ~ShortenScheduler() override = default;
+
+  [[nodiscard]] int64_t shorten_ns() const { return shorten_ns_; }
+
+ private:
+  int64_t ExecuteNS(int64_t ns) override {
+    // 最初の実行では 300ns 実行したところで 150ns 後のイベントを追加する
+    if (!added_) {
+      added_ = true;
+      now_ns_ = 300;
+      AddEventNS(150, dev_, static_cast<IDevice::TimeFunc>(&TestDevice::OnEvent), 0, false);
+      now_ns_ = 0;
+    }
+    int64_t executed = std::min(ns, end_ns_);
+    end_ns_ = INT64_MAX;
+    return executed;
+  }
+  void ShortenNS(int64_t ns) override {
+    shorten_ns_ = ns;
+    end_ns_ = now_ns_ + ns;
+  }
+  int64_t GetNS() override { return now_ns_; }
+
+  TestDevice* dev_;
+  int64_t now_ns_ = 0;
+  int64_t end_ns_ = INT64_MAX;
+  int64_t shorten_ns_ = 0;
+  bool added_ = false;
+};
+
+TEST(SchedulerShortenTest, ShortensToNewEvent) {
+  TestDevice dev(0x1);
+  ShortenScheduler sched(&dev);
+  sched.Init();
+  sched.AddEventNS(1000, &dev, static_cast<IDevice::TimeFunc>(&TestDevice::OnEvent), 1, false);
+
+  // 500ns まで実行する予定を、現在時刻 (300ns) から 150ns 後で打ち切る
+  EXPECT_EQ(500, sched.ProceedNS(500));
+  EXPECT_EQ(150, sched.shorten_ns());
+  EXPECT_TRUE(dev.event_received());
+  EXPECT_EQ(0U, dev.passed_arg());
+}
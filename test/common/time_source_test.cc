@@ -0,0 +1,50 @@
+#include "common/time_source.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+TEST(VirtualTimeSourceTest, AdvancesWithEmulation) {
+  VirtualTimeSource time(100);
+  EXPECT_EQ(100U, time.GetTimeNS());
+  time.Advance(16666667);
+  EXPECT_EQ(16666767U, time.GetTimeNS());
+
+  // 待つとその時刻まですぐに進む．過去の時刻なら進まない
+  time.WaitUntilNS(20000000);
+  EXPECT_EQ(20000000U, time.GetTimeNS());
+  time.WaitUntilNS(10000000);
+  EXPECT_EQ(20000000U, time.GetTimeNS());
+  time.SleepMS(2);
+  EXPECT_EQ(22000000U, time.GetTimeNS());
+}
+
+TEST(RecordedTimeSourceTest, ReplaysRecordedTimes) {
+  VirtualTimeSource source;
+  RecordedTimeSource time;
+  time.Record(&source);
+  EXPECT_FALSE(time.IsReplaying());
+
+  std::vector<uint64_t> seen;
+  for (int i = 0; i < 4; ++i) {
+    time.Advance(1000);
+    time.SleepMS(1);
+    seen.push_back(time.GetTimeNS());
+  }
+  EXPECT_EQ(seen, time.times());
+
+  // 再生中は記録した値を順に返し，進めたり待ったりしても変わらない
+  time.Replay();
+  EXPECT_TRUE(time.IsReplaying());
+  for (uint64_t t : seen) {
+    time.Advance(12345);
+    time.WaitUntilNS(t + 1000000);
+    EXPECT_EQ(t, time.GetTimeNS());
+  }
+  EXPECT_TRUE(time.IsExhausted());
+  EXPECT_EQ(seen.back(), time.GetTimeNS());
+
+  time.Replay({5, 7});
+  EXPECT_EQ(5U, time.GetTimeNS());
+  EXPECT_EQ(7U, time.GetTimeNS());
+}
@@ -0,0 +1,207 @@
+#include "devices/z80c.h"
+#include "devices/z80x.h"
+#include "gtest/gtest.h"
+#include "z80_test_system.h"
+
+#include <vector>
+
+namespace {
+// 読むたびに値が変わる入力ポートと，書き込まれた値を記録する出力ポート
+class Port : public Device {
+ public:
+  enum { kIn = 0, kOut = 0 };
+
+  Port() : Device(DEV_ID('P', 'O', 'R', 'T')) {}
+  [[nodiscard]] const Descriptor* IFCALL GetDesc() const override { return &descriptor; }
+
+  uint32_t IOCALL In(uint32_t) { return data_++ & 0xff; }
+  void IOCALL Out(uint32_t, uint32_t data) { out_.push_back(data); }
+  [[nodiscard]] const std::vector<uint32_t>& out() const { return out_; }
+
+ private:
+  uint32_t data_ = 0;
+  std::vector<uint32_t> out_;
+
+  static const Descriptor descriptor;
+  static const InFuncPtr indef[];
+  static const OutFuncPtr outdef[];
+};
+
+const Device::Descriptor Port::descriptor = {indef, outdef};
+const Device::InFuncPtr Port::indef[] = {static_cast<InFuncPtr>(&Port::In)};
+const Device::OutFuncPtr Port::outdef[] = {static_cast<OutFuncPtr>(&Port::Out)};
+
+// ブロック命令を繰り返し実行するプログラム
+constexpr uint8_t kProgram[] = {
+    0x31, 0x00, 0xf0,  // 0000: LD SP,f000h
+    0x21, 0x00, 0x80,  // 0003: LD HL,8000h
+    0x11, 0x00, 0xa0,  // 0006: LD DE,a000h
+    0x01, 0x00, 0x10,  // 0009: LD BC,1000h
+    0xed, 0xb0,        // 000c: LDIR        (ページをまたぐ転送)
+    0x21, 0x00, 0xa0,  // 000e: LD HL,a000h
+    0x11, 0x01, 0xa0,  // 0011: LD DE,a001h
+    0x01, 0xff, 0x01,  // 0014: LD BC,01ffh
+    0xed, 0xb0,        // 0017: LDIR        (重なった領域への転送)
+    0x21, 0xff, 0xaf,  // 0019: LD HL,afffh
+    0x11, 0xff, 0x8f,  // 001c: LD DE,8fffh
+    0x01, 0x00, 0x08,  // 001f: LD BC,0800h
+    0xed, 0xb8,        // 0022: LDDR
+    0x21, 0x00, 0x80,  // 0024: LD HL,8000h
+    0x01, 0x00, 0x10,  // 0027: LD BC,1000h
+    0x3e, 0x5a,        // 002a: LD A,5ah
+    0xed, 0xb1,        // 002c: CPIR
+    0x2b,              // 002e: DEC HL
+    0x34,              // 002f: INC (HL)
+    0x21, 0x00, 0x80,  // 0030: LD HL,8000h
+    0x01, 0x40, 0x10,  // 0033: LD BC,1040h
+    0xed, 0xb2,        // 0036: INIR
+    0x21, 0x00, 0x81,  // 0038: LD HL,8100h
+    0x01, 0x40, 0x20,  // 003b: LD BC,2040h
+    0xed, 0xb3,        // 003e: OTIR
+    0xc3, 0x03, 0x00,  // 0040: JP 0003h
+};
+
+// 自分自身を書き換える LDIR
+constexpr uint8_t kSelfModifying[] = {
+    0x21, 0x00, 0x02,  // 0000: LD HL,0200h
+    0x11, 0x00, 0x00,  // 0003: LD DE,0000h
+    0x01, 0x00, 0x01,  // 0006: LD BC,0100h
+    0xed, 0xb0,        // 0009: LDIR
+    0x76,              // 000b: HALT
+};
+
+// 4KiB の LDIR と CPIR (CPIR は一致しないので最後まで比較する)
+constexpr uint8_t kLongBlock[] = {
+    0x21, 0x00, 0x80,  // 0000: LD HL,8000h
+    0x11, 0x00, 0xc0,  // 0003: LD DE,c000h
+    0x01, 0x00, 0x10,  // 0006: LD BC,1000h
+    0xed, 0xb0,        // 0009: LDIR
+    0x21, 0x00, 0x80,  // 000b: LD HL,8000h
+    0x01, 0x00, 0x10,  // 000e: LD BC,1000h
+    0x3e, 0xff,        // 0011: LD A,ffh
+    0xed, 0xb1,        // 0013: CPIR
+    0x76,              // 0015: HALT
+};
+
+// まとめ書きの関数を持つページ (c000h-cfffh) への LDIR と LDDR
+constexpr uint8_t kBlockWriter[] = {
+    0x21, 0x00, 0x80,  // 0000: LD HL,8000h
+    0x11, 0x00, 0xc0,  // 0003: LD DE,c000h
+    0x01, 0x00, 0x10,  // 0006: LD BC,1000h
+    0xed, 0xb0,        // 0009: LDIR
+    0x21, 0xff, 0x97,  // 000b: LD HL,97ffh
+    0x11, 0xff, 0xcb,  // 000e: LD DE,cbffh
+    0x01, 0x00, 0x08,  // 0011: LD BC,0800h
+    0xed, 0xb8,        // 0014: LDDR
+    0x76,              // 0016: HALT
+};
+
+template <class CPU>
+class System : public Z80TestSystem<CPU> {
+ public:
+  // direct: メモリを直接参照させる (false なら関数ページを経由させ，高速化を無効にする)
+  System(const uint8_t* program, size_t size, bool direct) {
+    uint8_t* ram = this->ram();
+    for (int i = 0; i < 0x10000; ++i)
+      ram[i] = uint8_t(i * 7 + (i >> 8));
+    memset(ram, 0, 0x400);
+    this->memory().Load(program, size);
+    if (!direct) {
+      this->memory().MapHandler(0, 0x10000);
+      this->Reset();
+    }
+
+    const IOBus::Connector c_port[] = {
+        {0x40, IOBus::portin, Port::kIn}, {0x40, IOBus::portout, Port::kOut}, {0, 0, 0}};
+    this->Connect(&port_, c_port);
+  }
+
+  void Execute(const std::vector<int>& slices) {
+    for (int clocks : slices)
+      CPU::ExecSingle(this->cpu(), this->cpu(), clocks);
+  }
+
+  const Port& port() const { return port_; }
+  std::vector<uint8_t> Memory() { return {this->ram(), this->ram() + 0x10000}; }
+
+  std::vector<uint8_t> Status() {
+    std::vector<uint8_t> s(this->cpu()->GetStatusSize());
+    this->cpu()->SaveStatus(s.data());
+    return s;
+  }
+
+ private:
+  Port port_;
+};
+
+std::vector<int> Slices() {
+  std::vector<int> slices;
+  for (int i = 0; i < 200; ++i)
+    slices.push_back(i % 5 ? 1000 + i * 37 : 10);
+  return slices;
+}
+
+template <class CPU>
+class Z80BlockTest : public testing::Test {};
+
+using CPUs = testing::Types<Z80C, Z80X>;
+TYPED_TEST_SUITE(Z80BlockTest, CPUs);
+}  // namespace
+
+TYPED_TEST(Z80BlockTest, MatchesSingleStep) {
+  System<TypeParam> ref(kProgram, sizeof(kProgram), false);
+  System<TypeParam> dut(kProgram, sizeof(kProgram), true);
+  ref.Execute(Slices());
+  dut.Execute(Slices());
+
+  // まとめて実行しても実行結果 (R レジスタを含む) とクロックは変わらない
+  EXPECT_EQ(ref.cpu()->GetClocks(), dut.cpu()->GetClocks());
+  EXPECT_EQ(ref.Status(), dut.Status());
+  EXPECT_EQ(ref.Memory(), dut.Memory());
+  EXPECT_EQ(ref.port().out(), dut.port().out());
+  EXPECT_FALSE(dut.port().out().empty());
+}
+
+TYPED_TEST(Z80BlockTest, SelfModifyingTransfer) {
+  System<TypeParam> ref(kSelfModifying, sizeof(kSelfModifying), false);
+  System<TypeParam> dut(kSelfModifying, sizeof(kSelfModifying), true);
+  ref.Execute(Slices());
+  dut.Execute(Slices());
+
+  EXPECT_EQ(ref.cpu()->GetClocks(), dut.cpu()->GetClocks());
+  EXPECT_EQ(ref.Status(), dut.Status());
+  EXPECT_EQ(ref.Memory(), dut.Memory());
+}
+
+TYPED_TEST(Z80BlockTest, RepeatsInBulk) {
+  System<TypeParam> sys(kLongBlock, sizeof(kLongBlock), true);
+  memset(sys.ram() + 0x8000, 0, 0x1000);
+  sys.cpu()->EnableProfiler(true);
+  sys.Execute({200000});
+
+  // 4KiB の転送・比較のうち，最後の 1 回以外はまとめて実行されるので，
+  // 命令を開始する回数は繰り返しの回数よりずっと少ない
+  Z80Profiler* profiler = sys.cpu()->GetProfiler();
+  EXPECT_LE(profiler->Count(0, 0x0009), 2U);
+  EXPECT_LE(profiler->Count(0, 0x0013), 2U);
+  EXPECT_EQ(0, memcmp(sys.ram() + 0x8000, sys.ram() + 0xc000, 0x1000));
+  EXPECT_EQ(0x0000U, sys.cpu()->GetReg().r.w.bc);
+}
+
+TYPED_TEST(Z80BlockTest, WritesThroughBlockWriter) {
+  System<TypeParam> ref(kBlockWriter, sizeof(kBlockWriter), false);
+  System<TypeParam> dut(kBlockWriter, sizeof(kBlockWriter), true);
+  dut.memory().MapBlockWriter(0xc000, 0x1000);
+  dut.cpu()->EnableProfiler(true);
+  ref.Execute({200000});
+  dut.Execute({200000});
+
+  // 書き込み関数のページへの転送も，まとめ書きの関数でまとめて実行される
+  EXPECT_EQ(ref.cpu()->GetClocks(), dut.cpu()->GetClocks());
+  EXPECT_EQ(ref.Status(), dut.Status());
+  EXPECT_EQ(ref.Memory(), dut.Memory());
+  EXPECT_GT(dut.memory().block_writes(), 0);
+  Z80Profiler* profiler = dut.cpu()->GetProfiler();
+  EXPECT_LE(profiler->Count(0, 0x0009), 2U);
+  EXPECT_LE(profiler->Count(0, 0x0014), 2U);
+}
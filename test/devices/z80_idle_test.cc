@@ -0,0 +1,144 @@
+#include "devices/z80_idle.h"
+
+#include "devices/z80c.h"
+#include "devices/z80x.h"
+#include "gtest/gtest.h"
+#include "z80_test_system.h"
+
+#include <vector>
+
+namespace {
+// 読み出し回数を数えるステータスポート
+class StatusPort : public Device {
+ public:
+  enum { kIn = 0 };
+
+  StatusPort() : Device(DEV_ID('S', 'T', 'A', 'T')) {}
+  [[nodiscard]] const Descriptor* IFCALL GetDesc() const override { return &descriptor; }
+
+  uint32_t IOCALL In(uint32_t) {
+    ++reads_;
+    return 0x00;
+  }
+  [[nodiscard]] int reads() const { return reads_; }
+
+ private:
+  int reads_ = 0;
+
+  static const Descriptor descriptor;
+  static const InFuncPtr indef[];
+};
+
+const Device::Descriptor StatusPort::descriptor = {indef, nullptr};
+const Device::InFuncPtr StatusPort::indef[] = {static_cast<InFuncPtr>(&StatusPort::In)};
+
+// VRTC 待ちのようなループ
+constexpr uint8_t kProgram[] = {
+    0x31, 0x00, 0xf0,  // 0000: LD SP,f000h
+    0x06, 0x12,        // 0003: LD B,12h
+    0xdb, 0x40,        // 0005: IN A,(40h)
+    0xe6, 0x20,        // 0007: AND 20h
+    0x28, 0xfa,        // 0009: JR Z,0005h
+    0x04,              // 000b: INC B
+    0x18, 0xf7,        // 000c: JR 0005h
+};
+
+template <class CPU>
+class System : public Z80TestSystem<CPU> {
+ public:
+  System(bool pure, bool skip) : Z80TestSystem<CPU>(kProgram, sizeof(kProgram)) {
+    const uint8_t rule = pure ? IOBus::portin | IOBus::pure : IOBus::portin;
+    const IOBus::Connector c_port[] = {{0x40, rule, StatusPort::kIn}, {0, 0, 0}};
+    this->Connect(&port_, c_port);
+    this->cpu()->EnableIdleSkip(skip);
+  }
+
+  void Execute(const std::vector<int>& slices) {
+    for (int clocks : slices)
+      CPU::ExecSingle(this->cpu(), this->cpu(), clocks);
+  }
+
+  const StatusPort& port() const { return port_; }
+
+  std::vector<uint8_t> Status() {
+    std::vector<uint8_t> s(this->cpu()->GetStatusSize());
+    this->cpu()->SaveStatus(s.data());
+    return s;
+  }
+
+ private:
+  StatusPort port_;
+};
+
+std::vector<int> Slices() {
+  std::vector<int> slices;
+  for (int i = 0; i < 100; ++i)
+    slices.push_back(1000 + i * 37);
+  return slices;
+}
+
+template <class CPU>
+class Z80IdleTest : public testing::Test {};
+
+using CPUs = testing::Types<Z80C, Z80X>;
+TYPED_TEST_SUITE(Z80IdleTest, CPUs);
+}  // namespace
+
+TYPED_TEST(Z80IdleTest, SkipsPollingLoop) {
+  System<TypeParam> ref(true, false);
+  System<TypeParam> dut(true, true);
+  ref.Execute(Slices());
+  dut.Execute(Slices());
+
+  // 省略しても実行結果 (R レジスタを含む) とクロックは変わらない
+  EXPECT_EQ(ref.cpu()->GetClocks(), dut.cpu()->GetClocks());
+  EXPECT_EQ(ref.Status(), dut.Status());
+  EXPECT_LT(dut.port().reads() * 10, ref.port().reads());
+}
+
+TYPED_TEST(Z80IdleTest, KeepsSideEffects) {
+  // 副作用のあるポートを読むループは省略しない
+  System<TypeParam> ref(false, false);
+  System<TypeParam> dut(false, true);
+  ref.Execute(Slices());
+  dut.Execute(Slices());
+
+  EXPECT_EQ(ref.cpu()->GetClocks(), dut.cpu()->GetClocks());
+  EXPECT_EQ(ref.Status(), dut.Status());
+  EXPECT_EQ(ref.port().reads(), dut.port().reads());
+}
+
+TEST(Z80IdleDetectorTest, Detector) {
+  Z80IdleDetector idle;
+  Z80Reg reg{};
+  reg.r.w.bc = 0x1234;
+
+  EXPECT_TRUE(Z80IdleDetector::IsLoopBranch(0x109, 0x105));
+  EXPECT_FALSE(Z80IdleDetector::IsLoopBranch(0x105, 0x109));
+  EXPECT_FALSE(Z80IdleDetector::IsLoopBranch(0x200, 0x100));
+
+  // 周期 20 クロック，R は 1 周で 3 増える
+  EXPECT_FALSE(idle.Check(0x105, reg, 0, 100));
+  reg.rreg += 3;
+  EXPECT_FALSE(idle.Check(0x105, reg, 0, 120));
+  reg.rreg += 3;
+  EXPECT_TRUE(idle.Check(0x105, reg, 0, 140));
+  EXPECT_EQ(20, idle.period());
+  EXPECT_EQ(3U, idle.rdelta());
+
+  // レジスタが変化したらやり直し
+  reg.r.w.bc++;
+  EXPECT_FALSE(idle.Check(0x105, reg, 0, 160));
+  EXPECT_FALSE(idle.Check(0x105, reg, 0, 180));
+  EXPECT_TRUE(idle.Check(0x105, reg, 0, 200));
+
+  // 副作用があったらやり直し
+  EXPECT_FALSE(idle.Check(0x105, reg, 1, 220));
+  EXPECT_FALSE(idle.Check(0x105, reg, 1, 240));
+  EXPECT_TRUE(idle.Check(0x105, reg, 1, 260));
+
+  // 周期が変わったらやり直し
+  EXPECT_FALSE(idle.Check(0x105, reg, 1, 290));
+  EXPECT_FALSE(idle.Check(0x105, reg, 1, 320));
+  EXPECT_TRUE(idle.Check(0x105, reg, 1, 350));
+}
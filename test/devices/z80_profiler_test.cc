@@ -0,0 +1,117 @@
+#include "devices/z80_profiler.h"
+
+#include "common/io_bus.h"
+#include "common/memory_manager.h"
+#include "devices/z80c.h"
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+// 0x0000-0x7fff のバンクを切り替えられるメモリ
+class BankSource : public IGetMemoryBank {
+ public:
+  uint32_t IFCALL GetRdBank(uint32_t addr) override { return addr < 0x8000 ? bank_ : 0; }
+  uint32_t IFCALL GetWrBank(uint32_t addr) override { return 0; }
+  void set_bank(uint32_t bank) { bank_ = bank; }
+
+ private:
+  uint32_t bank_ = 1;
+};
+
+std::string ReadAll(FILE* fp) {
+  std::string s;
+  rewind(fp);
+  for (int c; (c = fgetc(fp)) != EOF;)
+    s.push_back(static_cast<char>(c));
+  return s;
+}
+}  // namespace
+
+TEST(Z80ProfilerTest, CountsPerBank) {
+  BankSource source;
+  Z80Profiler profiler;
+  profiler.SetMemoryBank(&source);
+  profiler.Enable(true);
+
+  uint8_t rom1[0x400];
+  uint8_t rom2[0x400];
+  profiler.Enter(0x100, intptr_t(rom1), 0);
+  profiler.Enter(0x101, intptr_t(rom1), 4);
+  // 同じクロックのフェッチは同じ命令の続き
+  profiler.Enter(0x102, intptr_t(rom1), 4);
+  // ページの割り当てが変わったらバンクを引き直す
+  source.set_bank(2);
+  profiler.Enter(0x100, intptr_t(rom2), 11);
+  profiler.Enter(0x8000, 0, 21);
+
+  EXPECT_EQ(1U, profiler.Count(1, 0x100));
+  EXPECT_EQ(1U, profiler.Count(1, 0x101));
+  EXPECT_EQ(0U, profiler.Count(1, 0x102));
+  EXPECT_EQ(1U, profiler.Count(2, 0x100));
+  EXPECT_EQ(4U, profiler.Cycles(1, 0x100));
+  EXPECT_EQ(7U, profiler.Cycles(1, 0x101));
+  EXPECT_EQ(10U, profiler.Cycles(2, 0x100));
+  EXPECT_EQ(1U, profiler.Count(0, 0x8000));
+
+  int range = profiler.AddRange(1, 0x100, 0x200, "main");
+  EXPECT_EQ(11U, profiler.RangeCycles(range));
+
+  FILE* fp = tmpfile();
+  ASSERT_NE(nullptr, fp);
+  EXPECT_TRUE(profiler.WriteFolded(fp, "cpu1"));
+  EXPECT_EQ(
+      "cpu1;bank_01;main;0100 4\n"
+      "cpu1;bank_01;main;0101 7\n"
+      "cpu1;bank_02;0100 10\n",
+      ReadAll(fp));
+  fclose(fp);
+
+  profiler.Decay();
+  EXPECT_EQ(1U, profiler.Count(1, 0x100));
+  profiler.Clear();
+  EXPECT_EQ(0U, profiler.Count(1, 0x100));
+  EXPECT_EQ(0U, profiler.Cycles(2, 0x100));
+}
+
+TEST(Z80ProfilerTest, Z80C) {
+  // DJNZ のループ
+  constexpr uint8_t kProgram[] = {
+      0x06, 0x00,  // 0000: LD B,0
+      0x00,        // 0002: NOP
+      0x10, 0xfd,  // 0003: DJNZ 0002h
+      0x18, 0xf9,  // 0005: JR 0000h
+  };
+  auto ram = std::make_unique<uint8_t[]>(0x10000);
+  memset(ram.get(), 0, 0x10000);
+  memcpy(ram.get(), kProgram, sizeof(kProgram));
+
+  Z80C cpu(DEV_ID('C', 'P', 'U', '1'));
+  MemoryPage* read = nullptr;
+  MemoryPage* write = nullptr;
+  cpu.GetPages(&read, &write);
+  MemoryManager mm;
+  mm.Init(0x10000, read, write);
+  int mid = mm.Connect(&cpu);
+  mm.AllocR(mid, 0, 0x10000, ram.get());
+  mm.AllocW(mid, 0, 0x10000, ram.get());
+  IOBus bus;
+  bus.Init(256, nullptr);
+  cpu.Init(&mm, &bus, 0xff);
+
+  // 無効な間は記録しない
+  Z80C::ExecSingle(&cpu, &cpu, 1000);
+  EXPECT_EQ(0U, cpu.GetProfiler()->Count(0, 0x0002));
+
+  cpu.EnableProfiler(true);
+  Z80C::ExecSingle(&cpu, &cpu, 100000);
+  cpu.EnableProfiler(false);
+
+  Z80Profiler* profiler = cpu.GetProfiler();
+  EXPECT_GT(profiler->Count(0, 0x0002), 1000U);
+  EXPECT_NEAR(profiler->Count(0, 0x0002), profiler->Count(0, 0x0003), 1);
+  EXPECT_EQ(4U * profiler->Count(0, 0x0002), profiler->Cycles(0, 0x0002));
+}
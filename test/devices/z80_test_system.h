@@ -0,0 +1,106 @@
+// Z80 コアのテスト・ベンチマーク用の最小構成
+//
+// 64KiB の RAM を MemoryManager で割り当てた Z80TestMemory と，
+// それに 256 ポートの I/O バスと CPU をつないだ Z80TestSystem．
+// 各テストは自分のプログラムとポートだけを追加する．
+
+#pragma once
+
+#include "common/io_bus.h"
+#include "common/memory_manager.h"
+
+#include <string.h>
+
+#include <memory>
+
+class Z80TestMemory {
+ public:
+  Z80TestMemory() {
+    ram_ = std::make_unique<uint8_t[]>(0x10000);
+    memset(ram_.get(), 0, 0x10000);
+  }
+
+  // read/write のページ表に RAM 全体を割り当てる
+  void Init(MemoryPage* read, MemoryPage* write) {
+    mm_.Init(0x10000, read, write);
+    mid_ = mm_.Connect(this);
+    mm_.AllocR(mid_, 0, 0x10000, ram_.get());
+    mm_.AllocW(mid_, 0, 0x10000, ram_.get());
+  }
+
+  void Load(const uint8_t* program, size_t size, uint32_t addr = 0) {
+    memcpy(ram_.get() + addr, program, size);
+  }
+
+  // [addr, addr + length) をアクセス関数経由にする．
+  // 中身は同じ RAM だが，直接参照を前提にした高速化は働かなくなる
+  void MapHandler(uint32_t addr, uint32_t length) {
+    mm_.AllocR(mid_, addr, length, &Z80TestMemory::Read);
+    mm_.AllocW(mid_, addr, length, &Z80TestMemory::Write);
+  }
+  // [addr, addr + length) への書き込みを，まとめ書きの関数を持つアクセス関数経由にする
+  void MapBlockWriter(uint32_t addr, uint32_t length) {
+    mm_.AllocW(mid_, addr, length, &Z80TestMemory::Write, &Z80TestMemory::WriteBlock);
+  }
+  // まとめ書きの関数が呼ばれた回数
+  [[nodiscard]] int block_writes() const { return block_writes_; }
+
+  MemoryManager* mm() { return &mm_; }
+  uint8_t* ram() { return ram_.get(); }
+  [[nodiscard]] const uint8_t* ram() const { return ram_.get(); }
+
+ private:
+  static uint32_t Read(void* inst, uint32_t addr) {
+    return static_cast<Z80TestMemory*>(inst)->ram_[addr & 0xffff];
+  }
+  static void Write(void* inst, uint32_t addr, uint32_t data) {
+    static_cast<Z80TestMemory*>(inst)->ram_[addr & 0xffff] = data;
+  }
+  static void WriteBlock(void* inst, uint32_t addr, const uint8_t* data, uint32_t count) {
+    auto* m = static_cast<Z80TestMemory*>(inst);
+    ++m->block_writes_;
+    for (uint32_t i = 0; i < count; ++i)
+      m->ram_[(addr + i) & 0xffff] = data[i];
+  }
+
+  std::unique_ptr<uint8_t[]> ram_;
+  MemoryManager mm_;
+  int mid_ = -1;
+  int block_writes_ = 0;
+};
+
+// CPU は Z80C または Z80X
+template <class CPU>
+class Z80TestSystem {
+ public:
+  explicit Z80TestSystem(const IDevice::ID& id = DEV_ID('C', 'P', 'U', '1')) : cpu_(id) {
+    MemoryPage* read = nullptr;
+    MemoryPage* write = nullptr;
+    cpu_.GetPages(&read, &write);
+    memory_.Init(read, write);
+    iobus_.Init(256, nullptr);
+    cpu_.Init(memory_.mm(), &iobus_, 0xff);
+  }
+  // program を 0 番地に置く
+  Z80TestSystem(const uint8_t* program, size_t size,
+                const IDevice::ID& id = DEV_ID('C', 'P', 'U', '1'))
+      : Z80TestSystem(id) {
+    memory_.Load(program, size);
+  }
+
+  // メモリの割り当てを変えた後は，Reset で CPU に PC のページを読み直させる
+  void Reset() { cpu_.Reset(); }
+
+  void Connect(IDevice* device, const IOBus::Connector* connector) {
+    iobus_.Connect(device, connector);
+  }
+
+  CPU* cpu() { return &cpu_; }
+  Z80TestMemory& memory() { return memory_; }
+  uint8_t* ram() { return memory_.ram(); }
+
+ private:
+  Z80TestMemory memory_;
+  IOBus iobus_;
+  CPU cpu_;
+};
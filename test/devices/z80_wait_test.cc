@@ -0,0 +1,69 @@
+#include "devices/z80c.h"
+#include "gtest/gtest.h"
+#include "z80_test_system.h"
+
+namespace {
+constexpr uint32_t kPageBits = MemoryManagerBase::pagebits;
+
+// (8000h) を数え続けるループ
+constexpr uint8_t kCountProgram[] = {
+    0x21, 0x00, 0x80,  // 0000: LD HL,8000h
+    0x34,              // 0003: INC (HL)
+    0x18, 0xfd,        // 0004: JR 0003h
+};
+
+// 256 バイトの LDIR の後で止まる
+constexpr uint8_t kCopyProgram[] = {
+    0x21, 0x00, 0x80,  // 0000: LD HL,8000h
+    0x11, 0x00, 0x90,  // 0003: LD DE,9000h
+    0x01, 0x00, 0x01,  // 0006: LD BC,0100h
+    0xed, 0xb0,        // 0009: LDIR
+    0x18, 0xfe,        // 000b: JR 000bh
+};
+
+class System : public Z80TestSystem<Z80C> {
+ public:
+  System(const uint8_t* program, size_t size) : Z80TestSystem(program, size) {}
+
+  // [addr, addr + length) のページのウェイトを設定する
+  void SetWaits(uint32_t addr, uint32_t length, uint8_t wait) {
+    uint8_t* waits = cpu()->GetWaits();
+    for (uint32_t p = addr >> kPageBits; p < (addr + length) >> kPageBits; ++p)
+      waits[p] = wait;
+  }
+};
+}  // namespace
+
+TEST(Z80WaitTest, NoWaitByDefault) {
+  System sys(kCountProgram, sizeof(kCountProgram));
+  // LD HL (10) + (INC (HL) (11) + JR (12)) * 100
+  Z80C::ExecSingle(sys.cpu(), sys.cpu(), 10 + 23 * 100);
+  EXPECT_EQ(100, sys.ram()[0x8000]);
+  EXPECT_EQ(10 + 23 * 100, sys.cpu()->GetClocks());
+}
+
+TEST(Z80WaitTest, AddsPageWaits) {
+  System sys(kCountProgram, sizeof(kCountProgram));
+  sys.SetWaits(0x0000, 0x8000, 1);
+  sys.SetWaits(0x8000, 0x8000, 2);
+
+  // 命令のフェッチ (M1) は 1 回 1 クロック，(8000h) の読み書きは 1 回 2 クロック遅れる．
+  // オペランドの読み込みは遅れない
+  constexpr int kLoop = 23 + 2 * 1 + 2 * 2;
+  Z80C::ExecSingle(sys.cpu(), sys.cpu(), 11 + kLoop * 100);
+  EXPECT_EQ(100, sys.ram()[0x8000]);
+  EXPECT_EQ(11 + kLoop * 100, sys.cpu()->GetClocks());
+}
+
+TEST(Z80WaitTest, BlockTransfer) {
+  System sys(kCopyProgram, sizeof(kCopyProgram));
+  sys.SetWaits(0x0000, 0x10000, 1);
+
+  // まとめて転送した分も 1 回ずつ実行した場合と同じだけ遅れる
+  // LD x3: M1 3 回，LDIR 1 回: M1 2 回 + 読み書き
+  constexpr int kClocks = 30 + 3 + 255 * (21 + 4) + (16 + 4);
+  Z80C::ExecSingle(sys.cpu(), sys.cpu(), kClocks);
+  EXPECT_EQ(0x000bU, sys.cpu()->GetPC());
+  EXPECT_EQ(0, sys.cpu()->GetReg().r.w.bc & 0xffff);
+  EXPECT_EQ(kClocks, sys.cpu()->GetClocks());
+}
@@ -0,0 +1,139 @@
+#include <benchmark/benchmark.h>
+
+#include "devices/z80c.h"
+#include "z80_test_system.h"
+
+namespace {
+// 1 回の計測で実行するクロック数 (4MHz で 1 秒分)
+constexpr int64_t kClocks = 3993600;
+// イベント間隔が短い場合を想定した 1 回の Exec のクロック数
+constexpr int64_t kShortSlice = 64;
+
+// 主命令に CB, DD/FD, ED 系を混ぜたループ
+constexpr uint8_t kProgram[] = {
+    0x31, 0x00, 0xf0,        // 0000: LD SP,f000h
+    0xdd, 0x21, 0x00, 0x80,  // 0003: LD IX,8000h
+    0xfd, 0x21, 0x00, 0xa0,  // 0007: LD IY,a000h
+    0x21, 0x00, 0x90,        // 000b: LD HL,9000h
+    0x06, 0x00,              // 000e: LD B,0
+    0xdd, 0x7e, 0x01,        // 0010: LD A,(IX+1)
+    0x80,                    // 0013: ADD A,B
+    0x77,                    // 0014: LD (HL),A
+    0x23,                    // 0015: INC HL
+    0xcb, 0x3f,              // 0016: SRL A
+    0xcb, 0x5f,              // 0018: BIT 3,A
+    0xc5,                    // 001a: PUSH BC
+    0xd1,                    // 001b: POP DE
+    0xfd, 0x77, 0x02,        // 001c: LD (IY+2),A
+    0xed, 0x44,              // 001f: NEG
+    0xed, 0x53, 0x00, 0xa1,  // 0021: LD (a100h),DE
+    0x10, 0xe9,              // 0025: DJNZ 0010h
+    0xc3, 0x0b, 0x00,        // 0027: JP 000bh
+};
+
+// 4KiB の LDIR/LDDR と CPIR を繰り返すループ
+constexpr uint8_t kBlockProgram[] = {
+    0x21, 0x00, 0x80,  // 0000: LD HL,8000h
+    0x11, 0x00, 0xc0,  // 0003: LD DE,c000h
+    0x01, 0x00, 0x10,  // 0006: LD BC,1000h
+    0xed, 0xb0,        // 0009: LDIR
+    0x2b,              // 000b: DEC HL
+    0x1b,              // 000c: DEC DE
+    0x01, 0x00, 0x10,  // 000d: LD BC,1000h
+    0xed, 0xb8,        // 0010: LDDR
+    0x21, 0x00, 0x80,  // 0012: LD HL,8000h
+    0x01, 0x00, 0x10,  // 0015: LD BC,1000h
+    0x3e, 0xff,        // 0018: LD A,ffh
+    0xed, 0xb1,        // 001a: CPIR
+    0xc3, 0x00, 0x00,  // 001c: JP 0000h
+};
+
+class CPUBench : public Z80TestSystem<Z80C> {
+ public:
+  explicit CPUBench(const IDevice::ID& id, const uint8_t* program = kProgram,
+                    size_t size = sizeof(kProgram))
+      : Z80TestSystem(program, size, id) {}
+};
+
+const char* DispatchName() {
+#ifdef Z80C_THREADED_DISPATCH
+  return "threaded";
+#else
+  return "switch";
+#endif
+}
+}  // namespace
+
+static void BM_Z80C_ExecSingle(benchmark::State& state) {
+  CPUBench main(DEV_ID('C', 'P', 'U', '1'));
+  CPUBench sub(DEV_ID('C', 'P', 'U', '2'));
+
+  for (auto _ : state) {
+    // This code gets timed
+    Z80C::ExecSingle(main.cpu(), sub.cpu(), kClocks);
+  }
+  state.SetItemsProcessed(state.iterations() * kClocks);
+  state.SetLabel(DispatchName());
+}
+
+static void BM_Z80C_ExecDual(benchmark::State& state) {
+  CPUBench main(DEV_ID('C', 'P', 'U', '1'));
+  CPUBench sub(DEV_ID('C', 'P', 'U', '2'));
+
+  for (auto _ : state) {
+    // This code gets timed
+    Z80C::ExecDual(main.cpu(), sub.cpu(), kClocks);
+  }
+  state.SetItemsProcessed(state.iterations() * kClocks * 2);
+  state.SetLabel(DispatchName());
+}
+
+static void BM_Z80C_ExecDual2(benchmark::State& state) {
+  CPUBench main(DEV_ID('C', 'P', 'U', '1'));
+  CPUBench sub(DEV_ID('C', 'P', 'U', '2'));
+
+  for (auto _ : state) {
+    // This code gets timed
+    Z80C::ExecDual2(main.cpu(), sub.cpu(), kClocks);
+  }
+  state.SetItemsProcessed(state.iterations() * kClocks * 3 / 2);
+  state.SetLabel(DispatchName());
+}
+
+// 短いスライスで呼び出して Exec 1 回あたりのオーバーヘッドを見る
+static void BM_Z80C_ExecDual_ShortSlice(benchmark::State& state) {
+  CPUBench main(DEV_ID('C', 'P', 'U', '1'));
+  CPUBench sub(DEV_ID('C', 'P', 'U', '2'));
+  auto exec = Z80C::GetExecFunc(static_cast<Z80ExecMode>(state.range(0)));
+
+  for (auto _ : state) {
+    // This code gets timed
+    for (int64_t c = 0; c < kClocks; c += kShortSlice)
+      exec(main.cpu(), sub.cpu(), kShortSlice);
+  }
+  state.SetItemsProcessed(state.iterations() * kClocks);
+  state.SetLabel(DispatchName());
+}
+
+static void BM_Z80C_BlockTransfer(benchmark::State& state) {
+  CPUBench main(DEV_ID('C', 'P', 'U', '1'), kBlockProgram, sizeof(kBlockProgram));
+  CPUBench sub(DEV_ID('C', 'P', 'U', '2'));
+
+  for (auto _ : state) {
+    // This code gets timed
+    Z80C::ExecSingle(main.cpu(), sub.cpu(), kClocks);
+  }
+  state.SetItemsProcessed(state.iterations() * kClocks);
+  state.SetLabel(DispatchName());
+}
+
+// Register the function as a benchmark
+BENCHMARK(BM_Z80C_ExecSingle);
+BENCHMARK(BM_Z80C_ExecDual);
+BENCHMARK(BM_Z80C_ExecDual2);
+BENCHMARK(BM_Z80C_ExecDual_ShortSlice)
+    ->Arg(static_cast<int>(Z80ExecMode::kDual))
+    ->Arg(static_cast<int>(Z80ExecMode::kDual2));
+BENCHMARK(BM_Z80C_BlockTransfer);
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -12,7 +12,7 @@ class Z80CTest : public ::testing::Test {
 
   void SetUp() override {
     mem_ = std::make_unique<uint8_t[]>(0x10000);
-    page_.inst = mem_.get();
+    page_.ptr = intptr_t(mem_.get());
     mm1_.Init(0, &page_, &page_);
     mm2_.Init(0, &page_, &page_);
     iobus1_.Init(256, nullptr);
@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+
+#include "devices/z80x.h"
+#include "z80_test_system.h"
+
+namespace {
+// 1 回の計測で実行するクロック数 (4MHz で 1 秒分)
+constexpr int64_t kClocks = 3993600;
+
+// 4KiB の LDIR/LDDR と CPIR を繰り返すループ
+constexpr uint8_t kBlockProgram[] = {
+    0x21, 0x00, 0x80,  // 0000: LD HL,8000h
+    0x11, 0x00, 0xc0,  // 0003: LD DE,c000h
+    0x01, 0x00, 0x10,  // 0006: LD BC,1000h
+    0xed, 0xb0,        // 0009: LDIR
+    0x2b,              // 000b: DEC HL
+    0x1b,              // 000c: DEC DE
+    0x01, 0x00, 0x10,  // 000d: LD BC,1000h
+    0xed, 0xb8,        // 0010: LDDR
+    0x21, 0x00, 0x80,  // 0012: LD HL,8000h
+    0x01, 0x00, 0x10,  // 0015: LD BC,1000h
+    0x3e, 0xff,        // 0018: LD A,ffh
+    0xed, 0xb1,        // 001a: CPIR
+    0xc3, 0x00, 0x00,  // 001c: JP 0000h
+};
+}  // namespace
+
+// Z80C の BM_Z80C_BlockTransfer と同じループ
+static void BM_Z80X_BlockTransfer(benchmark::State& state) {
+  Z80TestSystem<Z80X> main(kBlockProgram, sizeof(kBlockProgram), DEV_ID('C', 'P', 'U', '1'));
+  Z80TestSystem<Z80X> sub(DEV_ID('C', 'P', 'U', '2'));
+  // state.range(0) が 0 なら関数ページ経由にして，ブロック命令の高速化を無効にする
+  if (!state.range(0)) {
+    main.memory().MapHandler(0, 0x10000);
+    main.Reset();
+  }
+
+  for (auto _ : state) {
+    // This code gets timed
+    Z80X::ExecSingle(main.cpu(), sub.cpu(), kClocks);
+  }
+  state.SetItemsProcessed(state.iterations() * kClocks);
+}
+
+BENCHMARK(BM_Z80X_BlockTransfer)->Arg(0)->Arg(1);
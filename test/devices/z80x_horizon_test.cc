@@ -0,0 +1,149 @@
+#include "devices/z80x.h"
+#include "gtest/gtest.h"
+#include "z80_test_system.h"
+
+#ifndef Z80X_HORIZON
+#error "z80x_horizon_test needs Z80X_HORIZON (devices_unittests_horizon)"
+#endif
+
+namespace {
+// 主 CPU と副 CPU の間でデータを受け渡すポート (PC88 の PIO にあたる)．
+// アクセスのたびに，アクセスした CPU が相手 CPU より先行していないかを調べる
+class Latch : public Device {
+ public:
+  enum { kMainIn = 0, kSubIn, kMainOut = 0, kSubOut };
+
+  // shift: 副 CPU のクロック比 (ExecDual2 なら 1)
+  Latch(Z80X* main, Z80X* sub, int shift)
+      : Device(DEV_ID('L', 'A', 'T', 'C')), main_(main), sub_(sub), shift_(shift) {}
+  [[nodiscard]] const Descriptor* IFCALL GetDesc() const override { return &descriptor; }
+
+  uint32_t IOCALL MainIn(uint32_t) {
+    Record(main_->GetClocks(), sub_->GetClocks() << shift_);
+    return ack_;
+  }
+  uint32_t IOCALL SubIn(uint32_t) {
+    Record(sub_->GetClocks() << shift_, main_->GetClocks());
+    return data_;
+  }
+  void IOCALL MainOut(uint32_t, uint32_t data) {
+    Record(main_->GetClocks(), sub_->GetClocks() << shift_);
+    data_ = data;
+  }
+  void IOCALL SubOut(uint32_t, uint32_t data) {
+    Record(sub_->GetClocks() << shift_, main_->GetClocks());
+    ack_ = data;
+    ++handshakes_;
+  }
+
+  [[nodiscard]] int accesses() const { return accesses_; }
+  // 相手 CPU より先行した状態でアクセスした回数
+  [[nodiscard]] int early() const { return early_; }
+  [[nodiscard]] int handshakes() const { return handshakes_; }
+
+ private:
+  void Record(int64_t self, int64_t other) {
+    ++accesses_;
+    if (self > other)
+      ++early_;
+  }
+
+  Z80X* main_;
+  Z80X* sub_;
+  int shift_;
+  uint32_t data_ = 0;
+  uint32_t ack_ = 0;
+  int accesses_ = 0;
+  int early_ = 0;
+  int handshakes_ = 0;
+
+  static const Descriptor descriptor;
+  static const InFuncPtr indef[];
+  static const OutFuncPtr outdef[];
+};
+
+const Device::Descriptor Latch::descriptor = {indef, outdef};
+const Device::InFuncPtr Latch::indef[] = {
+    static_cast<InFuncPtr>(&Latch::MainIn),
+    static_cast<InFuncPtr>(&Latch::SubIn),
+};
+const Device::OutFuncPtr Latch::outdef[] = {
+    static_cast<OutFuncPtr>(&Latch::MainOut),
+    static_cast<OutFuncPtr>(&Latch::SubOut),
+};
+
+// 主 CPU: 10h に番号を書き，11h に同じ番号が返るのを待つ
+constexpr uint8_t kMainProgram[] = {
+    0x31, 0x00, 0xf0,  // 0000: LD SP,f000h
+    0x06, 0x00,        // 0003: LD B,00h
+    0x04,              // 0005: INC B
+    0x78,              // 0006: LD A,B
+    0xd3, 0x10,        // 0007: OUT (10h),A
+    0xdb, 0x11,        // 0009: IN A,(11h)
+    0xb8,              // 000b: CP B
+    0x20, 0xfb,        // 000c: JR NZ,0009h
+    0x18, 0xf5,        // 000e: JR 0005h
+};
+
+// 副 CPU: 10h が変わるのを待ち，同じ値を 11h に返す
+constexpr uint8_t kSubProgram[] = {
+    0x31, 0x00, 0xf0,  // 0000: LD SP,f000h
+    0x0e, 0x00,        // 0003: LD C,00h
+    0xdb, 0x10,        // 0005: IN A,(10h)
+    0xb9,              // 0007: CP C
+    0x28, 0xfb,        // 0008: JR Z,0005h
+    0x4f,              // 000a: LD C,A
+    0xd3, 0x11,        // 000b: OUT (11h),A
+    0x18, 0xf6,        // 000d: JR 0005h
+};
+
+class System {
+ public:
+  explicit System(int shift)
+      : main_(kMainProgram, sizeof(kMainProgram), DEV_ID('C', 'P', 'U', '1')),
+        sub_(kSubProgram, sizeof(kSubProgram), DEV_ID('C', 'P', 'U', '2')),
+        latch_(main_.cpu(), sub_.cpu(), shift) {
+    const IOBus::Connector c_main[] = {
+        {0x10, IOBus::portout | IOBus::sync, Latch::kMainOut},
+        {0x11, IOBus::portin | IOBus::sync, Latch::kMainIn},
+        {0, 0, 0}};
+    const IOBus::Connector c_sub[] = {
+        {0x10, IOBus::portin | IOBus::sync, Latch::kSubIn},
+        {0x11, IOBus::portout | IOBus::sync, Latch::kSubOut},
+        {0, 0, 0}};
+    main_.Connect(&latch_, c_main);
+    sub_.Connect(&latch_, c_sub);
+  }
+
+  void Execute(Z80X::ExecFunc exec) {
+    for (int i = 0; i < 100; ++i)
+      exec(main_.cpu(), sub_.cpu(), 1000 + i * 37);
+  }
+
+  const Latch& latch() const { return latch_; }
+
+ private:
+  Z80TestSystem<Z80X> main_;
+  Z80TestSystem<Z80X> sub_;
+  Latch latch_;
+};
+}  // namespace
+
+TEST(Z80XHorizonTest, HandshakeDual) {
+  System sys(0);
+  sys.Execute(&Z80X::ExecDual);
+
+  // 同期ポートへのアクセスは，相手 CPU が追いついてから行う
+  EXPECT_GT(sys.latch().accesses(), 0);
+  EXPECT_EQ(0, sys.latch().early());
+  EXPECT_GT(sys.latch().handshakes(), 100);
+}
+
+TEST(Z80XHorizonTest, HandshakeDual2) {
+  System sys(1);
+  sys.Execute(&Z80X::ExecDual2);
+
+  EXPECT_GT(sys.latch().accesses(), 0);
+  EXPECT_EQ(0, sys.latch().early());
+  EXPECT_GT(sys.latch().handshakes(), 100);
+}
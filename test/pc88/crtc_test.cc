@@ -1,5 +1,7 @@
 #include "pc88/crtc.h"
 
+#include <vector>
+
 #include "common/io_bus.h"
 #include "gtest/gtest.h"
 #include "pc88/pd8257.h"
@@ -54,4 +56,82 @@ TEST_F(CRTCTest, ChangeAttrTest) {
   EXPECT_EQ(x, 0xe2);
 }
 
+TEST_F(CRTCTest, GlyphCacheTest) {
+  crtc_.lines_per_char_ = 16;
+  crtc_.line_char_limit_ = 16;
+  crtc_.SetTextMode(true);
+  crtc_.ModifyFont(8 * 'A', 0x81);
+  crtc_.ValidateGlyphs();
+
+  // 白 (色 7), 通常表示: フォントの 1 行を 2 ライン
+  const packed* cell = crtc_.GetGlyph('A', 0xe0, false);
+  EXPECT_EQ(0x0707070fU, cell[0]);
+  EXPECT_EQ(0x0f070707U, cell[1]);
+  EXPECT_EQ(cell[0], cell[2]);
+  EXPECT_EQ(cell[1], cell[3]);
+
+  // 反転
+  cell = crtc_.GetGlyph('A', 0xe1, false);
+  EXPECT_EQ(0x0f0f0f07U, cell[0]);
+
+  // PCG などでフォントが変わったら作り直す
+  crtc_.ModifyFont(8 * 'A', 0xff);
+  crtc_.ValidateGlyphs();
+  cell = crtc_.GetGlyph('A', 0xe0, false);
+  EXPECT_EQ(0x0f0f0f0fU, cell[0]);
+  EXPECT_EQ(0x0f0f0f0fU, cell[1]);
+
+  // アンダーラインは最後のライン
+  cell = crtc_.GetGlyph(' ', 0xe8, true);
+  EXPECT_EQ(0x0f0f0f0fU, cell[15 * 4]);
+}
+
+TEST_F(CRTCTest, RowSkipTest) {
+  crtc_.lines_per_char_ = 16;
+  crtc_.line_char_limit_ = 16;
+  crtc_.screen_height_ = 400;
+  crtc_.attr_per_line_ = 1;
+  crtc_.line_size_ = crtc_.width_ + 2;
+  crtc_.bpl_ = 640;
+  std::vector<uint8_t> image(640 * 400);
+
+  // DMA の代わりに現在のバンクへ書いてから展開する
+  auto expand = [&](uint8_t ch, Draw::Region* region) {
+    uint8_t* vram = crtc_.vram_ptr_[crtc_.bank_];
+    for (uint32_t y = 0; y < crtc_.height_; ++y) {
+      uint8_t* row = vram + y * crtc_.line_size_;
+      memset(row, y == 5 ? ch : 'A', crtc_.width_);
+      row[crtc_.width_] = 0;
+      row[crtc_.width_ + 1] = 0xe8;
+    }
+    crtc_.HashRows(0, crtc_.height_);
+    region->Reset();
+    crtc_.ExpandImage(image.data(), *region);
+  };
+
+  Draw::Region region;
+  expand('A', &region);
+  EXPECT_TRUE(region.Valid());
+
+  // 変化のない行は展開しない
+  expand('A', &region);
+  EXPECT_FALSE(region.Valid());
+  for (uint32_t y = 0; y < crtc_.height_; ++y)
+    EXPECT_TRUE(crtc_.row_state_[y].valid);
+
+  // 書き換えた行だけを報告する
+  expand('B', &region);
+  ASSERT_EQ(1, region.count);
+  EXPECT_EQ(5 * 16, region.rects[0].top);
+  EXPECT_EQ(6 * 16 - 1, region.rects[0].bottom);
+
+  // カーソルのある行は描き直す
+  crtc_.cursor_x_ = 3;
+  crtc_.cursor_y_ = 9;
+  crtc_.attr_cursor_ = 1;
+  expand('B', &region);
+  ASSERT_EQ(1, region.count);
+  EXPECT_EQ(9 * 16, region.rects[0].top);
+}
+
 }  // namespace pc8801
@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "pc88/gvram_alu.h"
+
+namespace pc8801 {
+namespace {
+// 640x200 1 画面分
+constexpr uint32_t kScreenBytes = 640 / 8 * 200;
+
+// プレーンごとにマスクを 3 つ持つ実装 (比較用)
+class ThreeMaskALU {
+ public:
+  void SetOperation(uint32_t port34) {
+    for (int i = 0; i < 3; ++i) {
+      uint32_t shift = i * 8;
+      maskr_ &= ~(0xffU << shift), masks_ &= ~(0xffU << shift), maski_ &= ~(0xffU << shift);
+      switch ((port34 >> i) & 0x11) {
+        case 0x00:
+          maskr_ |= 0xffU << shift;
+          break;
+        case 0x01:
+          masks_ |= 0xffU << shift;
+          break;
+        case 0x10:
+          maski_ |= 0xffU << shift;
+          break;
+      }
+    }
+  }
+  uint32_t Write(uint32_t g, uint32_t data) const {
+    uint32_t q = (data << 16) | (data << 8) | data;
+    return ((g & ~(q & maskr_)) | (q & masks_)) ^ (q & maski_);
+  }
+
+ private:
+  uint32_t maskr_ = 0;
+  uint32_t masks_ = 0;
+  uint32_t maski_ = 0;
+};
+
+// Port34: B は set, R は invert, G は reset
+constexpr uint32_t kPort34 = 0x21;
+
+// CPU からの書き込みと同じく，1 バイトごとにアクセス関数を呼ぶ
+template <class ALU>
+struct Target {
+  ALU alu;
+  std::unique_ptr<uint32_t[]> gvram = std::make_unique<uint32_t[]>(kScreenBytes);
+};
+
+using WriteFunc = void (*)(void* inst, uint32_t addr, uint32_t data);
+
+void WriteThreeMask(void* inst, uint32_t addr, uint32_t data) {
+  auto* t = static_cast<Target<ThreeMaskALU>*>(inst);
+  t->gvram[addr] = t->alu.Write(t->gvram[addr], data);
+}
+
+void WriteLogical(void* inst, uint32_t addr, uint32_t data) {
+  auto* t = static_cast<Target<GVRAMALU>*>(inst);
+  t->gvram[addr] = t->alu.WriteLogical(t->gvram[addr], data);
+}
+
+template <class ALU>
+void RunWrite8(benchmark::State& state, WriteFunc func) {
+  Target<ALU> target;
+  target.alu.SetOperation(kPort34);
+  void* inst = &target;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(func);
+    for (uint32_t i = 0; i < kScreenBytes; ++i)
+      func(inst, i, i & 0xff);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kScreenBytes);
+}
+
+void BM_GVRAMALU_ThreeMask(benchmark::State& state) {
+  RunWrite8<ThreeMaskALU>(state, WriteThreeMask);
+}
+
+void BM_GVRAMALU_Write8(benchmark::State& state) {
+  RunWrite8<GVRAMALU>(state, WriteLogical);
+}
+
+// RAM から 1 画面分転送する
+void BM_GVRAMALU_Write(benchmark::State& state) {
+  auto gvram = std::make_unique<uint32_t[]>(kScreenBytes);
+  auto data = std::make_unique<uint8_t[]>(kScreenBytes);
+  for (uint32_t i = 0; i < kScreenBytes; ++i)
+    data[i] = uint8_t(i);
+  GVRAMALU alu;
+  alu.SetOperation(kPort34);
+  for (auto _ : state) {
+    alu.Write(gvram.get(), data.get(), kScreenBytes);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kScreenBytes);
+}
+
+// 1 画面を塗りつぶす．state.range(0): Port35 (書き込み方法)
+void BM_GVRAMALU_Fill(benchmark::State& state) {
+  auto gvram = std::make_unique<uint32_t[]>(kScreenBytes);
+  GVRAMALU alu;
+  alu.SetOperation(kPort34);
+  alu.SetMode(uint32_t(state.range(0)));
+  alu.Read(0x123456);
+  for (auto _ : state) {
+    alu.Fill(gvram.get(), 0x5a, kScreenBytes);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kScreenBytes);
+}
+}  // namespace
+}  // namespace pc8801
+
+BENCHMARK(pc8801::BM_GVRAMALU_ThreeMask);
+BENCHMARK(pc8801::BM_GVRAMALU_Write8);
+BENCHMARK(pc8801::BM_GVRAMALU_Write);
+BENCHMARK(pc8801::BM_GVRAMALU_Fill)->Arg(0x00)->Arg(0x10)->Arg(0x20);
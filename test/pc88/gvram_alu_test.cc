@@ -0,0 +1,121 @@
+#include "pc88/gvram_alu.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace pc8801 {
+namespace {
+// プレーンごとに処理する，マスクを使わない実装
+uint32_t ReferenceLogical(uint32_t port34, uint32_t g, uint32_t data) {
+  uint32_t result = 0;
+  for (int i = 0; i < 3; ++i) {
+    uint32_t plane = (g >> (i * 8)) & 0xff;
+    switch ((port34 >> i) & 0x11) {
+      case 0x00:
+        plane &= ~data;
+        break;
+      case 0x01:
+        plane |= data;
+        break;
+      case 0x10:
+        plane ^= data;
+        break;
+      default:
+        break;
+    }
+    result |= (plane & 0xff) << (i * 8);
+  }
+  return result;
+}
+
+constexpr uint32_t kSamples[] = {0x000000, 0xffffff, 0x12a5f0, 0x5a3c81, 0x00ff00, 0xc30f66};
+}  // namespace
+
+TEST(GVRAMALUTest, Logical) {
+  GVRAMALU alu;
+  for (uint32_t port34 = 0; port34 < 0x80; ++port34) {
+    alu.SetOperation(port34);
+    for (uint32_t g : kSamples) {
+      for (uint32_t data = 0; data < 0x100; data += 0x0b)
+        EXPECT_EQ(ReferenceLogical(port34, g, data), alu.WriteLogical(g, data)) << port34;
+    }
+  }
+}
+
+TEST(GVRAMALUTest, Read) {
+  GVRAMALU alu;
+  for (uint32_t port35 = 0; port35 < 8; ++port35) {
+    alu.SetMode(port35);
+    for (uint32_t g : kSamples) {
+      uint32_t expected = 0xff;
+      for (int i = 0; i < 3; ++i) {
+        uint32_t plane = (g >> (i * 8)) & 0xff;
+        expected &= (port35 & (1 << i)) ? plane : ~plane;
+      }
+      EXPECT_EQ(expected & 0xff, alu.Read(g));
+      EXPECT_EQ(g, alu.latch());
+    }
+  }
+}
+
+TEST(GVRAMALUTest, Copy) {
+  GVRAMALU alu;
+  alu.Read(0x123456);
+
+  alu.SetMode(0x10);
+  EXPECT_EQ(GVRAMALU::kCopyAll, alu.mode());
+  EXPECT_EQ(0x123456U, alu.WriteCopyAll());
+  alu.SetMode(0x20);
+  EXPECT_EQ(GVRAMALU::kCopyRtoB, alu.mode());
+  EXPECT_EQ(0xabcd34U, alu.WriteCopyRtoB(0xabcdef));
+  alu.SetMode(0x30);
+  EXPECT_EQ(GVRAMALU::kCopyBtoR, alu.mode());
+  EXPECT_EQ(0xab56efU, alu.WriteCopyBtoR(0xabcdef));
+}
+
+// まとめて書き込んだ結果は 1 バイトずつ書き込んだ結果と一致する
+TEST(GVRAMALUTest, BlockMatchesSingle) {
+  GVRAMALU alu;
+  alu.SetOperation(0x61);
+  alu.Read(0x5a3c81);
+
+  std::vector<uint8_t> data(100);
+  std::vector<uint32_t> gvram(100);
+  for (uint32_t i = 0; i < 100; ++i) {
+    data[i] = uint8_t(i * 37);
+    gvram[i] = kSamples[i % std::size(kSamples)];
+  }
+
+  for (uint32_t port35 = 0; port35 < 0x40; port35 += 0x10) {
+    alu.SetMode(port35);
+    std::vector<uint32_t> expected = gvram;
+    std::vector<uint32_t> fill = gvram;
+    std::vector<uint32_t> write = gvram;
+    alu.Fill(fill.data(), 0xa5, 100);
+    alu.Write(write.data(), data.data(), 100);
+
+    for (uint32_t i = 0; i < 100; ++i) {
+      uint32_t g = gvram[i];
+      switch (alu.mode()) {
+        case GVRAMALU::kLogical:
+          EXPECT_EQ(alu.WriteLogical(g, 0xa5), fill[i]);
+          EXPECT_EQ(alu.WriteLogical(g, data[i]), write[i]);
+          break;
+        case GVRAMALU::kCopyAll:
+          EXPECT_EQ(alu.WriteCopyAll(), fill[i]);
+          EXPECT_EQ(alu.WriteCopyAll(), write[i]);
+          break;
+        case GVRAMALU::kCopyRtoB:
+          EXPECT_EQ(alu.WriteCopyRtoB(g), fill[i]);
+          EXPECT_EQ(alu.WriteCopyRtoB(g), write[i]);
+          break;
+        case GVRAMALU::kCopyBtoR:
+          EXPECT_EQ(alu.WriteCopyBtoR(g), fill[i]);
+          EXPECT_EQ(alu.WriteCopyBtoR(g), write[i]);
+          break;
+      }
+    }
+  }
+}
+}  // namespace pc8801
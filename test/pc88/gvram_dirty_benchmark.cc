@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+
+#include "pc88/gvram_dirty.h"
+
+namespace pc8801 {
+namespace {
+// 640x200 1 画面は 1000 ブロック
+constexpr uint32_t kBlocks = 1000;
+
+// state.range(0): 1 フレームで書き換えられるブロック数
+template <class Mark>
+void SetDirty(int count, Mark mark) {
+  uint32_t a = 0x1234;
+  for (int i = 0; i < count; ++i) {
+    a = a * 1103515245 + 12345;
+    mark((a >> 8) % kBlocks);
+  }
+}
+
+// 以前の 1 ブロック 1 バイトのフラグを先頭から調べる方法 (比較用)
+void BM_GVRAMDirty_ByteScan(benchmark::State& state) {
+  uint8_t dirty[0x400];
+  memset(dirty, 0, sizeof(dirty));
+  int count = int(state.range(0));
+  int64_t found = 0;
+  for (auto _ : state) {
+    SetDirty(count, [&](uint32_t block) { dirty[block] = 1; });
+    benchmark::ClobberMemory();
+    for (uint32_t i = 0; i < kBlocks; ++i) {
+      if (dirty[i]) {
+        dirty[i] = 0;
+        ++found;
+      }
+    }
+  }
+  benchmark::DoNotOptimize(found);
+}
+
+void BM_GVRAMDirty_BitScan(benchmark::State& state) {
+  GVRAMDirtyMap dirty;
+  int count = int(state.range(0));
+  int64_t found = 0;
+  for (auto _ : state) {
+    SetDirty(count, [&](uint32_t block) { dirty.Set(block * 16); });
+    benchmark::ClobberMemory();
+    for (uint32_t i = dirty.FindNext(0, kBlocks); i < kBlocks; i = dirty.FindNext(i + 1, kBlocks))
+      ++found;
+    dirty.Clear(0, kBlocks);
+  }
+  benchmark::DoNotOptimize(found);
+}
+}  // namespace
+}  // namespace pc8801
+
+BENCHMARK(pc8801::BM_GVRAMDirty_ByteScan)->Arg(0)->Arg(8)->Arg(100)->Arg(1000);
+BENCHMARK(pc8801::BM_GVRAMDirty_BitScan)->Arg(0)->Arg(8)->Arg(100)->Arg(1000);
@@ -0,0 +1,127 @@
+#include "pc88/gvram_dirty.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace pc8801 {
+namespace {
+std::vector<uint32_t> Collect(const GVRAMDirtyMap& dirty, uint32_t begin, uint32_t end) {
+  std::vector<uint32_t> blocks;
+  for (uint32_t i = dirty.FindNext(begin, end); i < end; i = dirty.FindNext(i + 1, end))
+    blocks.push_back(i);
+  return blocks;
+}
+
+TEST(GVRAMDirtyMapTest, Empty) {
+  GVRAMDirtyMap dirty;
+  EXPECT_EQ(GVRAMDirtyMap::kBlocks, dirty.FindNext(0, GVRAMDirtyMap::kBlocks));
+  EXPECT_EQ(1000U, dirty.FindNext(0, 1000));
+}
+
+TEST(GVRAMDirtyMapTest, Set) {
+  GVRAMDirtyMap dirty;
+  dirty.Set(0x0000);
+  dirty.Set(0x000f);  // 同じブロック
+  dirty.Set(0x0400);
+  dirty.Set(0x3ff0);
+  dirty.Set(0x4010);  // 0x4000 で折り返す
+  EXPECT_TRUE(dirty.Test(0));
+  EXPECT_TRUE(dirty.Test(1));
+  EXPECT_FALSE(dirty.Test(2));
+  EXPECT_EQ((std::vector<uint32_t>{0, 1, 0x40, 0x3ff}), Collect(dirty, 0, GVRAMDirtyMap::kBlocks));
+}
+
+TEST(GVRAMDirtyMapTest, FindNextRespectsEnd) {
+  GVRAMDirtyMap dirty;
+  dirty.Set(999 * 16);
+  dirty.Set(1000 * 16);
+  EXPECT_EQ(999U, dirty.FindNext(0, 1000));
+  EXPECT_EQ(1000U, dirty.FindNext(999 + 1, 1000));
+  EXPECT_EQ(600U, dirty.FindNext(500, 600));
+  EXPECT_EQ(1000U, dirty.FindNext(1000, GVRAMDirtyMap::kBlocks));
+}
+
+TEST(GVRAMDirtyMapTest, SetRange) {
+  GVRAMDirtyMap dirty;
+  dirty.SetRange(0x3f8, 0x10);  // ブロック 0x3f, 0x40 にまたがる
+  EXPECT_EQ((std::vector<uint32_t>{0x3f, 0x40}), Collect(dirty, 0, GVRAMDirtyMap::kBlocks));
+
+  dirty.SetRange(0x100, 0x1000);
+  auto blocks = Collect(dirty, 0, GVRAMDirtyMap::kBlocks);
+  ASSERT_EQ(0x100U, blocks.size());
+  EXPECT_EQ(0x10U, blocks.front());
+  EXPECT_EQ(0x10fU, blocks.back());
+}
+
+TEST(GVRAMDirtyMapTest, SetAllAndClear) {
+  GVRAMDirtyMap dirty;
+  dirty.SetAll();
+  EXPECT_EQ(GVRAMDirtyMap::kBlocks, Collect(dirty, 0, GVRAMDirtyMap::kBlocks).size());
+
+  dirty.Clear(0, 1000);
+  EXPECT_EQ(1000U, dirty.FindNext(0, 1000));
+  EXPECT_EQ((std::vector<uint32_t>{1000, 1001, 1002}), Collect(dirty, 0, 1003));
+
+  dirty.Clear(1000, GVRAMDirtyMap::kBlocks);
+  EXPECT_EQ(GVRAMDirtyMap::kBlocks, dirty.FindNext(0, GVRAMDirtyMap::kBlocks));
+}
+
+TEST(GVRAMDirtyMapTest, ClearPartialWord) {
+  GVRAMDirtyMap dirty;
+  dirty.SetRange(60 * 16, 10 * 16);  // ブロック 60-69
+  dirty.Clear(62, 66);
+  EXPECT_EQ((std::vector<uint32_t>{60, 61, 66, 67, 68, 69}), Collect(dirty, 0, 128));
+  dirty.Clear(66, 70);
+  dirty.Clear(60, 62);
+  EXPECT_EQ(128U, dirty.FindNext(0, 128));
+}
+
+// 書き換えた行が続く範囲ごとに報告されること
+TEST(GVRAMDirtyMapTest, ForEachDirtyBlockSparse) {
+  GVRAMDirtyMap dirty;
+  std::vector<uint32_t> drawn;
+  std::vector<DirtyRows> runs;
+  auto draw = [&](int, int, uint32_t i) { drawn.push_back(i); };
+  auto report = [&](const DirtyRows& rows) { runs.push_back(rows); };
+
+  ForEachDirtyBlock(dirty, 200, 0, draw, report);
+  EXPECT_TRUE(drawn.empty());
+  EXPECT_TRUE(runs.empty());
+
+  dirty.Set(12 * 16);    // 2 行目 2 列目
+  dirty.Set(57 * 16);    // 11 行目 2 列目
+  dirty.Set(63 * 16);    // 12 行目 3 列目
+  dirty.Set(1000 * 16);  // 画面外
+  ForEachDirtyBlock(dirty, 200, 0, draw, report);
+  EXPECT_EQ((std::vector<uint32_t>{12, 57, 63}), drawn);
+  ASSERT_EQ(2U, runs.size());
+  EXPECT_EQ(2, runs[0].begin);
+  EXPECT_EQ(2, runs[0].end);
+  EXPECT_EQ(1 << 2, runs[0].columns);
+  EXPECT_EQ(11, runs[1].begin);
+  EXPECT_EQ(12, runs[1].end);
+  EXPECT_EQ((1 << 2) | (1 << 3), runs[1].columns);
+  EXPECT_EQ((std::vector<uint32_t>{1000}), Collect(dirty, 0, GVRAMDirtyMap::kBlocks));
+}
+
+// 320x200: どちらの画面の書き換えも同じ位置のブロックとして扱う
+TEST(GVRAMDirtyMapTest, ForEachDirtyBlockSecond) {
+  GVRAMDirtyMap dirty;
+  std::vector<uint32_t> drawn;
+  std::vector<DirtyRows> runs;
+  dirty.Set((0x200 + 7) * 16);  // 2 画面目の 1 行目 2 列目
+  dirty.Set(16 * 16);           // 1 画面目の 3 行目 1 列目
+  ForEachDirtyBlock(
+      dirty, 100, 0x200, [&](int, int, uint32_t i) { drawn.push_back(i); },
+      [&](const DirtyRows& rows) { runs.push_back(rows); });
+  EXPECT_EQ((std::vector<uint32_t>{7, 16}), drawn);
+  ASSERT_EQ(2U, runs.size());
+  EXPECT_EQ(1, runs[0].begin);
+  EXPECT_EQ(1 << 2, runs[0].columns);
+  EXPECT_EQ(3, runs[1].begin);
+  EXPECT_EQ(1 << 1, runs[1].columns);
+  EXPECT_EQ(GVRAMDirtyMap::kBlocks, dirty.FindNext(0, GVRAMDirtyMap::kBlocks));
+}
+}  // namespace
+}  // namespace pc8801
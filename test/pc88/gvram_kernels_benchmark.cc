@@ -0,0 +1,145 @@
+#include <benchmark/benchmark.h>
+
+#include <string.h>
+
+#include <memory>
+
+#include "common/draw.h"
+#include "pc88/gvram_kernels.h"
+
+namespace pc8801 {
+namespace {
+// 640x200 1 画面は 16 バイトのブロック 1000 個
+constexpr int kBlocks = 1000;
+constexpr int kBPL = 640;
+
+// Screen のテーブルによる展開 (比較用)
+packed table0[16];
+packed table1[16];
+packed table2[16];
+
+void CreateTable() {
+  for (int i = 0; i < 16; ++i) {
+    packed p = 0, q = 0, r = 0;
+    for (int j = 0; j < 4; ++j) {
+      bool set = (i & (1 << j)) != 0;
+      p = (p << 8) | (set ? 0x10 : 0x00);
+      q = (q << 8) | (set ? 0x20 : 0x00);
+      r = (r << 8) | (set ? 0x80 : 0x40);
+    }
+    table0[i] = p, table1[i] = q, table2[i] = r;
+  }
+}
+
+void ColorTable(uint8_t* dest, const uint32_t* src) {
+  auto* d = reinterpret_cast<packed*>(dest);
+  for (int i = 0; i < 16; ++i, d += 2) {
+    uint32_t a = src[i];
+    d[0] = (d[0] & ~PACK(0xf0)) | table0[(a >> 4) & 15] | table1[(a >> 12) & 15] |
+           table2[(a >> 20) & 15];
+    d[1] = (d[1] & ~PACK(0xf0)) | table0[a & 15] | table1[(a >> 8) & 15] | table2[(a >> 16) & 15];
+  }
+}
+
+void MonoTable(uint8_t* dest, const uint32_t* src, uint32_t mask) {
+  auto* d = reinterpret_cast<packed*>(dest);
+  for (int i = 0; i < 16; ++i, d += 2) {
+    uint32_t a = src[i] & mask;
+    a |= (a >> 8) | (a >> 16);
+    d[0] = (d[0] & ~PACK(0x20)) | table1[(a >> 4) & 15];
+    d[1] = (d[1] & ~PACK(0x20)) | table1[a & 15];
+  }
+}
+
+const GVRAMKernels kTableKernels = {ColorTable, MonoTable, GVRAMKernels::kNone, "table"};
+
+class Frame {
+ public:
+  explicit Frame(benchmark::State& state) {
+    auto type = static_cast<GVRAMKernels::Type>(state.range(0));
+    kernels_ = type == GVRAMKernels::kNone ? &kTableKernels : GetGVRAMKernels(type);
+    if (!kernels_) {
+      state.SkipWithError("not supported on this CPU");
+      return;
+    }
+    state.SetLabel(kernels_->name);
+    CreateTable();
+
+    gvram_ = std::make_unique<uint32_t[]>(0x4000);
+    uint32_t a = 0x1234;
+    for (int i = 0; i < 0x4000; ++i) {
+      a = a * 1103515245 + 12345;
+      gvram_[i] = (a >> 5) & 0xffffff;
+    }
+    image_ = std::make_unique<uint8_t[]>(kBPL * 400);
+    memset(image_.get(), 0, kBPL * 400);
+  }
+
+  [[nodiscard]] bool ok() const { return kernels_ != nullptr; }
+  const GVRAMKernels& kernels() { return *kernels_; }
+  const uint32_t* gvram() { return gvram_.get(); }
+  uint8_t* image() { return image_.get(); }
+
+ private:
+  const GVRAMKernels* kernels_ = nullptr;
+  std::unique_ptr<uint32_t[]> gvram_;
+  std::unique_ptr<uint8_t[]> image_;
+};
+
+// 画面全体が書き換わったときの 1 フレーム分の展開
+// state.range(0): GVRAMKernels::Type (kNone はテーブル)
+
+// 640x200 color (UpdateScreen200c)
+void BM_GVRAMKernels_200c(benchmark::State& state) {
+  Frame frame(state);
+  if (!frame.ok())
+    return;
+  auto color = frame.kernels().color;
+  for (auto _ : state) {
+    for (int i = 0; i < kBlocks; ++i)
+      color(frame.image() + (i / 5) * 2 * kBPL + (i % 5) * 128, frame.gvram() + i * 16);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kBlocks * 128);
+}
+
+// 640x200 b/w (UpdateScreen200b)
+void BM_GVRAMKernels_200b(benchmark::State& state) {
+  Frame frame(state);
+  if (!frame.ok())
+    return;
+  auto mono = frame.kernels().mono;
+  for (auto _ : state) {
+    for (int i = 0; i < kBlocks; ++i)
+      mono(frame.image() + (i / 5) * 2 * kBPL + (i % 5) * 128, frame.gvram() + i * 16, 0xffffff);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kBlocks * 128);
+}
+
+// 640x400 b/w (UpdateScreen400b): B プレーンが上半分，R プレーンが下半分
+void BM_GVRAMKernels_400b(benchmark::State& state) {
+  Frame frame(state);
+  if (!frame.ok())
+    return;
+  auto mono = frame.kernels().mono;
+  for (auto _ : state) {
+    for (int i = 0; i < kBlocks; ++i) {
+      uint8_t* dest = frame.image() + (i / 5) * kBPL + (i % 5) * 128;
+      mono(dest, frame.gvram() + i * 16, 0x0000ff);
+      mono(dest + 200 * kBPL, frame.gvram() + i * 16, 0x00ff00);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kBlocks * 256);
+}
+
+void KernelArgs(benchmark::internal::Benchmark* b) {
+  b->Arg(GVRAMKernels::kNone)->Arg(GVRAMKernels::kSSE2)->Arg(GVRAMKernels::kAVX2);
+}
+}  // namespace
+}  // namespace pc8801
+
+BENCHMARK(pc8801::BM_GVRAMKernels_200c)->Apply(pc8801::KernelArgs);
+BENCHMARK(pc8801::BM_GVRAMKernels_200b)->Apply(pc8801::KernelArgs);
+BENCHMARK(pc8801::BM_GVRAMKernels_400b)->Apply(pc8801::KernelArgs);
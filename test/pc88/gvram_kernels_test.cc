@@ -0,0 +1,75 @@
+#include "pc88/gvram_kernels.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+namespace pc8801 {
+namespace {
+// 1 ドットずつ処理する実装
+void ReferenceColor(uint8_t* dest, const uint32_t* src) {
+  for (int i = 0; i < 128; ++i) {
+    uint32_t q = src[i / 8] >> (7 - i % 8);
+    uint8_t pix = (q & 1 ? 0x10 : 0) | (q & 0x100 ? 0x20 : 0) | (q & 0x10000 ? 0x80 : 0x40);
+    dest[i] = (dest[i] & 0x0f) | pix;
+  }
+}
+
+void ReferenceMono(uint8_t* dest, const uint32_t* src, uint32_t mask) {
+  for (int i = 0; i < 128; ++i) {
+    uint32_t q = (src[i / 8] & mask) >> (7 - i % 8);
+    bool set = (q & 0x010101) != 0;
+    dest[i] = (dest[i] & ~0x20) | (set ? 0x20 : 0);
+  }
+}
+
+class GVRAMKernelsTest : public ::testing::TestWithParam<GVRAMKernels::Type> {
+ protected:
+  void SetUp() override {
+    kernels_ = GetGVRAMKernels(GetParam());
+    if (!kernels_)
+      GTEST_SKIP() << "not supported on this CPU";
+
+    uint32_t a = 0x1234;
+    for (auto& s : src_) {
+      a = a * 1103515245 + 12345;
+      s = (a >> 4) & 0xffffff;
+    }
+    for (int i = 0; i < 128; ++i)
+      image_[i] = uint8_t(i * 29);
+  }
+
+  const GVRAMKernels* kernels_ = nullptr;
+  uint32_t src_[16]{};
+  uint8_t image_[128]{};
+};
+
+TEST_P(GVRAMKernelsTest, Color) {
+  uint8_t expected[128];
+  memcpy(expected, image_, sizeof(expected));
+  ReferenceColor(expected, src_);
+  kernels_->color(image_, src_);
+  EXPECT_EQ(0, memcmp(expected, image_, sizeof(expected)));
+}
+
+TEST_P(GVRAMKernelsTest, Mono) {
+  for (uint32_t mask : {0xffffffU, 0x0000ffU, 0x00ff00U, 0xff0000U, 0x00ff00ffU, 0U}) {
+    uint8_t expected[128];
+    memcpy(expected, image_, sizeof(expected));
+    ReferenceMono(expected, src_, mask);
+    kernels_->mono(image_, src_, mask);
+    EXPECT_EQ(0, memcmp(expected, image_, sizeof(expected))) << std::hex << mask;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(GVRAMKernels,
+                         GVRAMKernelsTest,
+                         ::testing::Values(GVRAMKernels::kSSE2, GVRAMKernels::kAVX2));
+
+TEST(GVRAMKernelsTest, Best) {
+  const GVRAMKernels& best = GetGVRAMKernels();
+  EXPECT_EQ(best.color == nullptr, best.type == GVRAMKernels::kNone);
+  EXPECT_EQ(&best, GetGVRAMKernels(best.type));
+}
+}  // namespace
+}  // namespace pc8801
@@ -0,0 +1,177 @@
+#include "pc88/subsys.h"
+
+#include "common/io_bus.h"
+#include "common/memory_manager.h"
+#include "devices/z80c.h"
+#include "gtest/gtest.h"
+
+namespace pc8801 {
+
+class SubSystemTest : public testing::Test {
+ public:
+  SubSystemTest() : subsys_(DEV_ID('S', 'U', 'B', ' ')) {}
+  ~SubSystemTest() override = default;
+
+  void SetUp() override {
+    mm_.Init(0x10000, read_, write_);
+    subsys_.Init(&mm_);
+    subsys_.Reset();
+  }
+
+  // コマンド待ちループのようにポート C を読み続ける
+  void Poll(int count) {
+    for (int i = 0; i < count; ++i)
+      subsys_.S_Read2(0xfe);
+  }
+
+  bool IsWaiting(uint32_t pc) { return subsys_.IsWaiting(pc, reg_, mem_effects_); }
+
+ protected:
+  Z80Reg reg_{};
+  uint32_t mem_effects_ = 0;
+  MemoryPage read_[0x10000 >> MemoryManagerBase::pagebits]{};
+  MemoryPage write_[0x10000 >> MemoryManagerBase::pagebits]{};
+  MemoryManager mm_;
+  SubSystem subsys_;
+};
+
+TEST_F(SubSystemTest, SuspendsUntilMainWrites) {
+  Poll(20);
+  EXPECT_FALSE(IsWaiting(0x0100));
+  EXPECT_TRUE(IsWaiting(0x0104));
+  // 止めている間はサブ CPU が実行されないので，PC が変わらなくても待ち続ける
+  EXPECT_TRUE(IsWaiting(0x0104));
+
+  subsys_.M_Set0(0xfc, 0x12);
+  EXPECT_FALSE(IsWaiting(0x0104));
+}
+
+TEST_F(SubSystemTest, RequiresRepeatedReads) {
+  Poll(4);
+  EXPECT_FALSE(IsWaiting(0x0100));
+  EXPECT_FALSE(IsWaiting(0x0104));
+
+  // ポート C 以外へのアクセスでやり直し
+  Poll(20);
+  subsys_.S_Read0(0xfc);
+  Poll(4);
+  EXPECT_FALSE(IsWaiting(0x0100));
+  EXPECT_FALSE(IsWaiting(0x0104));
+}
+
+TEST_F(SubSystemTest, RequiresTightLoopInROM) {
+  // RAM 上のループ
+  Poll(20);
+  EXPECT_FALSE(IsWaiting(0x4000));
+  EXPECT_FALSE(IsWaiting(0x4004));
+
+  // PC が離れている
+  Poll(20);
+  EXPECT_FALSE(IsWaiting(0x0100));
+  EXPECT_FALSE(IsWaiting(0x0200));
+}
+
+TEST_F(SubSystemTest, ResumesOnInterrupt) {
+  Poll(20);
+  EXPECT_FALSE(IsWaiting(0x0100));
+  EXPECT_TRUE(IsWaiting(0x0100));
+
+  subsys_.S_Intr(0, 1);
+  EXPECT_FALSE(IsWaiting(0x0100));
+}
+
+TEST_F(SubSystemTest, RequiresUnchangedState) {
+  // タイムアウトを数えるループ
+  Poll(20);
+  reg_.r.w.de = 0x1000;
+  EXPECT_FALSE(IsWaiting(0x0100));
+  reg_.r.w.de = 0x0ff0;
+  EXPECT_FALSE(IsWaiting(0x0104));
+
+  // メモリ上のカウンタ
+  Poll(20);
+  EXPECT_FALSE(IsWaiting(0x0100));
+  mem_effects_ += 16;
+  EXPECT_FALSE(IsWaiting(0x0104));
+
+  // AF は読んだ値で変わるので見ない
+  Poll(20);
+  reg_.r.w.af = 0x0044;
+  EXPECT_FALSE(IsWaiting(0x0100));
+  reg_.r.w.af = 0x0800;
+  EXPECT_TRUE(IsWaiting(0x0104));
+}
+
+// ROM 上のプログラムをサブ CPU で実行する
+class SubCPUTest : public testing::Test {
+ public:
+  SubCPUTest() : subsys_(DEV_ID('S', 'U', 'B', ' ')), cpu_(DEV_ID('C', 'P', 'U', '2')) {}
+  ~SubCPUTest() override = default;
+
+  void Load(const uint8_t* program, size_t size) {
+    MemoryPage* read = nullptr;
+    MemoryPage* write = nullptr;
+    cpu_.GetPages(&read, &write);
+    mm_.Init(0x10000, read, write);
+    subsys_.Init(&mm_);
+    memcpy(subsys_.GetROM(), program, size);
+
+    static const IOBus::Connector c_sub[] = {{0xfe, IOBus::portin, SubSystem::s_read2},
+                                             {0, 0, 0}};
+    iobus_.Init(256, nullptr);
+    iobus_.Connect(&subsys_, c_sub);
+    cpu_.Init(&mm_, &iobus_, 0xff);
+    subsys_.Reset();
+  }
+
+  // PC88::Execute と同じく，スライスの区切りごとにコマンド待ちを確認しながら実行する
+  void Run(int slices) {
+    for (int i = 0; i < slices; ++i) {
+      if (!subsys_.IsWaiting(cpu_.GetPC(), cpu_.GetReg(), cpu_.MemEffects()))
+        Z80C::ExecSingle(&cpu_, &cpu_, kSlice);
+    }
+  }
+
+ protected:
+  static constexpr int64_t kSlice = 1000;
+
+  MemoryManager mm_;
+  IOBus iobus_;
+  SubSystem subsys_;
+  Z80C cpu_;
+};
+
+TEST_F(SubCPUTest, SuspendsCommandWait) {
+  constexpr uint8_t kProgram[] = {
+      0xdb, 0xfe,  // 0000: IN A,(FEh)
+      0xe6, 0x08,  // 0002: AND 08h
+      0x28, 0xfa,  // 0004: JR Z,0000h
+      0x18, 0xfe,  // 0006: JR 0006h
+  };
+  Load(kProgram, sizeof(kProgram));
+  Run(10);
+  EXPECT_TRUE(subsys_.IsWaiting(cpu_.GetPC(), cpu_.GetReg(), cpu_.MemEffects()));
+}
+
+TEST_F(SubCPUTest, TimeoutLoopIsNotSuspended) {
+  // ポート C だけを読む 11 バイトのループだが，DE が 0 になると抜ける
+  constexpr uint8_t kProgram[] = {
+      0x11, 0x00, 0x01,  // 0000: LD DE,0100h
+      0xdb, 0xfe,        // 0003: IN A,(FEh)
+      0xe6, 0x08,        // 0005: AND 08h
+      0x20, 0x0a,        // 0007: JR NZ,0013h
+      0x1b,              // 0009: DEC DE
+      0x7a,              // 000a: LD A,D
+      0xb3,              // 000b: OR E
+      0x20, 0xf5,        // 000c: JR NZ,0003h
+      0x3e, 0x01,        // 000e: LD A,1
+      0x32, 0x00, 0x40,  // 0010: LD (4000h),A
+      0x18, 0xfe,        // 0013: JR 0013h
+  };
+  Load(kProgram, sizeof(kProgram));
+  // 1 周 51 クロック × 256 回でタイムアウトする
+  Run(100);
+  EXPECT_EQ(1, subsys_.GetRAM()[0]);
+}
+
+}  // namespace pc8801
@@ -17,6 +17,14 @@ class Timer {
   bool Count(int32_t us);
   int32_t GetNextEvent();
 
+  // タイマーの残りカウント
+  struct State {
+    int32_t timera_count;
+    int32_t timerb_count;
+  };
+  void SaveState(State* state) const;
+  void RestoreState(const State& state);
+
  protected:
   virtual void SetStatus(uint32_t bit) = 0;
   virtual void ResetStatus(uint32_t bit) = 0;
@@ -48,4 +56,14 @@ inline void Timer::Reset() {
   timerb_count_ = 0;
 }
 
+inline void Timer::SaveState(State* state) const {
+  state->timera_count = timera_count_;
+  state->timerb_count = timerb_count_;
+}
+
+inline void Timer::RestoreState(const State& state) {
+  timera_count_ = state.timera_count;
+  timerb_count_ = state.timerb_count;
+}
+
 }  // namespace fmgen